@@ -0,0 +1,215 @@
+#pragma once
+
+// ==========================================
+// AIR QUALITY INDEX ENGINE
+// ==========================================
+// European AQI (EEA bands, 0-20-40-60-80-100 scale as used by Open-Meteo)
+// and US EPA AQI (0-500). All breakpoint tables are constexpr and stored in
+// ug/m3 - the unit Open-Meteo reports every pollutant in - so computing an
+// index is a short table walk with no unit conversion or setup at runtime.
+// Header-only and free of Arduino dependencies so host tools can reuse it.
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace aqi {
+
+enum class Scale : uint8_t { European, UsEpa };
+
+enum class Pollutant : uint8_t { PM25, PM10, NO2, O3, SO2, CO, Count, None = 0xFF };
+
+constexpr size_t POLLUTANT_COUNT = static_cast<size_t>(Pollutant::Count);
+
+// Both scales use six categories: Good .. Extremely poor / Hazardous
+constexpr uint8_t LEVEL_COUNT = 6;
+
+struct Breakpoint {
+    float cLo, cHi;      // concentration range [ug/m3]
+    uint16_t iLo, iHi;   // index range
+};
+
+struct Table {
+    const Breakpoint* rows;
+    uint8_t count;
+};
+
+struct Result {
+    uint16_t index;      // overall index (max of sub-indices)
+    uint8_t level;       // 0 .. LEVEL_COUNT-1
+    Pollutant dominant;  // pollutant responsible for the overall index
+};
+
+// Concentrations in ug/m3, indexed by Pollutant. Negative or NaN = not
+// available (a variable missing from the response).
+typedef float Sample[POLLUTANT_COUNT];
+
+// ------------------------------------------
+// Unit conversion (25 C, 1 atm: molar volume 24.45 l)
+// ------------------------------------------
+constexpr float ppbToUgm3(float ppb, float molarMass) { return ppb * molarMass / 24.45f; }
+
+constexpr float MW_O3  = 48.00f;
+constexpr float MW_NO2 = 46.01f;
+constexpr float MW_SO2 = 64.07f;
+constexpr float MW_CO  = 28.01f;
+
+// ------------------------------------------
+// European AQI - EEA concentration bands, mapped onto the continuous
+// 0-100+ scale that Open-Meteo reports as "european_aqi"
+// ------------------------------------------
+constexpr Breakpoint EU_PM25[] = {
+    {0, 10, 0, 20}, {10, 20, 20, 40}, {20, 25, 40, 60},
+    {25, 50, 60, 80}, {50, 75, 80, 100}, {75, 800, 100, 1200}
+};
+constexpr Breakpoint EU_PM10[] = {
+    {0, 20, 0, 20}, {20, 40, 20, 40}, {40, 50, 40, 60},
+    {50, 100, 60, 80}, {100, 150, 80, 100}, {150, 1200, 100, 1200}
+};
+constexpr Breakpoint EU_NO2[] = {
+    {0, 40, 0, 20}, {40, 90, 20, 40}, {90, 120, 40, 60},
+    {120, 230, 60, 80}, {230, 340, 80, 100}, {340, 1000, 100, 1200}
+};
+constexpr Breakpoint EU_O3[] = {
+    {0, 50, 0, 20}, {50, 100, 20, 40}, {100, 130, 40, 60},
+    {130, 240, 60, 80}, {240, 380, 80, 100}, {380, 800, 100, 1200}
+};
+constexpr Breakpoint EU_SO2[] = {
+    {0, 100, 0, 20}, {100, 200, 20, 40}, {200, 350, 40, 60},
+    {350, 500, 60, 80}, {500, 750, 80, 100}, {750, 1250, 100, 1200}
+};
+
+// ------------------------------------------
+// US EPA AQI (PM2.5 per the 2024 revision). Gas breakpoints are published
+// in ppb/ppm and converted to ug/m3 at compile time.
+// ------------------------------------------
+constexpr Breakpoint US_PM25[] = {
+    {0.0f, 9.0f, 0, 50}, {9.1f, 35.4f, 51, 100}, {35.5f, 55.4f, 101, 150},
+    {55.5f, 125.4f, 151, 200}, {125.5f, 225.4f, 201, 300}, {225.5f, 325.4f, 301, 500}
+};
+constexpr Breakpoint US_PM10[] = {
+    {0, 54, 0, 50}, {55, 154, 51, 100}, {155, 254, 101, 150},
+    {255, 354, 151, 200}, {355, 424, 201, 300}, {425, 604, 301, 500}
+};
+
+#define AQI_PPB(lo, hi, ilo, ihi, mw) { ppbToUgm3(lo, mw), ppbToUgm3(hi, mw), ilo, ihi }
+
+// O3: 8-hour table up to 200 ppb, 1-hour table for the 301-500 band. EPA
+// has no 8-hour breakpoints above 200 ppb, and its 1-hour 201-300 band
+// (205-404 ppb) would rank those readings below 200 ppb; readings between
+// 201 and 404 ppb therefore snap to 301, the start of the next band.
+constexpr Breakpoint US_O3[] = {
+    AQI_PPB(0, 54, 0, 50, MW_O3), AQI_PPB(55, 70, 51, 100, MW_O3),
+    AQI_PPB(71, 85, 101, 150, MW_O3), AQI_PPB(86, 105, 151, 200, MW_O3),
+    AQI_PPB(106, 200, 201, 300, MW_O3), AQI_PPB(405, 604, 301, 500, MW_O3)
+};
+constexpr Breakpoint US_NO2[] = {
+    AQI_PPB(0, 53, 0, 50, MW_NO2), AQI_PPB(54, 100, 51, 100, MW_NO2),
+    AQI_PPB(101, 360, 101, 150, MW_NO2), AQI_PPB(361, 649, 151, 200, MW_NO2),
+    AQI_PPB(650, 1249, 201, 300, MW_NO2), AQI_PPB(1250, 2049, 301, 500, MW_NO2)
+};
+constexpr Breakpoint US_SO2[] = {
+    AQI_PPB(0, 35, 0, 50, MW_SO2), AQI_PPB(36, 75, 51, 100, MW_SO2),
+    AQI_PPB(76, 185, 101, 150, MW_SO2), AQI_PPB(186, 304, 151, 200, MW_SO2),
+    AQI_PPB(305, 604, 201, 300, MW_SO2), AQI_PPB(605, 1004, 301, 500, MW_SO2)
+};
+// CO breakpoints are in ppm
+constexpr Breakpoint US_CO[] = {
+    AQI_PPB(0.0f, 4400, 0, 50, MW_CO), AQI_PPB(4500, 9400, 51, 100, MW_CO),
+    AQI_PPB(9500, 12400, 101, 150, MW_CO), AQI_PPB(12500, 15400, 151, 200, MW_CO),
+    AQI_PPB(15500, 30400, 201, 300, MW_CO), AQI_PPB(30500, 50400, 301, 500, MW_CO)
+};
+
+#undef AQI_PPB
+
+template <size_t N>
+constexpr Table table(const Breakpoint (&rows)[N]) { return Table{rows, static_cast<uint8_t>(N)}; }
+
+constexpr Table EMPTY_TABLE = {nullptr, 0};
+
+// Indexed by Pollutant. CO is not part of the European index.
+constexpr Table EU_TABLES[POLLUTANT_COUNT] = {
+    table(EU_PM25), table(EU_PM10), table(EU_NO2), table(EU_O3), table(EU_SO2), EMPTY_TABLE
+};
+constexpr Table US_TABLES[POLLUTANT_COUNT] = {
+    table(US_PM25), table(US_PM10), table(US_NO2), table(US_O3), table(US_SO2), table(US_CO)
+};
+
+// Index value at which each level starts (level = number of thresholds passed)
+constexpr uint16_t EU_LEVEL_START[LEVEL_COUNT] = {0, 20, 40, 60, 80, 100};
+constexpr uint16_t US_LEVEL_START[LEVEL_COUNT] = {0, 51, 101, 151, 201, 301};
+
+constexpr const Table* tablesFor(Scale s) { return s == Scale::European ? EU_TABLES : US_TABLES; }
+
+// Upper bound of the nominal range (for bars / gauges)
+constexpr uint16_t scaleMax(Scale s) { return s == Scale::European ? 100 : 500; }
+
+// ------------------------------------------
+// Computation
+// ------------------------------------------
+
+// Linear interpolation inside the first band whose upper bound covers c.
+// Concentrations falling into the rounding gap between two bands snap to the
+// start of the upper band; values beyond the table saturate at its top.
+inline uint16_t subIndex(const Table& t, float c) {
+    if (t.count == 0 || !(c >= 0)) return 0;     // also NaN
+    const Breakpoint* row = t.rows;
+    const Breakpoint* last = t.rows + t.count - 1;
+    while (row != last && c > row->cHi) ++row;
+    if (c < row->cLo) c = row->cLo;
+    if (c > row->cHi) c = row->cHi;
+    float span = row->cHi - row->cLo;
+    float frac = span > 0 ? (c - row->cLo) / span : 0;
+    return static_cast<uint16_t>(row->iLo + frac * (row->iHi - row->iLo) + 0.5f);
+}
+
+inline uint8_t levelOf(Scale s, uint16_t index) {
+    const uint16_t* start = s == Scale::European ? EU_LEVEL_START : US_LEVEL_START;
+    uint8_t level = 0;
+    for (uint8_t i = 1; i < LEVEL_COUNT; i++) level += index >= start[i];
+    return level;
+}
+
+// dominant is Pollutant::None (index 0) when no pollutant is available
+inline Result compute(Scale s, const Sample& sample) {
+    const Table* tables = tablesFor(s);
+    Result r = {0, 0, Pollutant::None};
+    for (size_t p = 0; p < POLLUTANT_COUNT; p++) {
+        if (!(sample[p] >= 0) || tables[p].count == 0) continue;
+        uint16_t idx = subIndex(tables[p], sample[p]);
+        if (r.dominant == Pollutant::None || idx > r.index) {
+            r.index = idx;
+            r.dominant = static_cast<Pollutant>(p);
+        }
+    }
+    r.level = levelOf(s, r.index);
+    return r;
+}
+
+inline const char* pollutantName(Pollutant p) {
+    switch (p) {
+        case Pollutant::PM25: return "PM2.5";
+        case Pollutant::PM10: return "PM10";
+        case Pollutant::NO2:  return "NO2";
+        case Pollutant::O3:   return "O3";
+        case Pollutant::SO2:  return "SO2";
+        case Pollutant::CO:   return "CO";
+        default:              return "--";
+    }
+}
+
+inline const char* levelName(Scale s, uint8_t level) {
+    static const char* const EU[LEVEL_COUNT] = {"Good", "Fair", "Moderate", "Poor", "Very poor", "Extremely poor"};
+    static const char* const US[LEVEL_COUNT] = {"Good", "Moderate", "Sensitive", "Unhealthy", "Very unhealthy", "Hazardous"};
+    if (level >= LEVEL_COUNT) level = LEVEL_COUNT - 1;
+    return s == Scale::European ? EU[level] : US[level];
+}
+
+// Compile-time sanity checks on the tables (C++11 constexpr: recursion only)
+constexpr bool tableMonotonic(const Table& t, uint8_t i = 1) {
+    return i >= t.count ? true
+         : (t.rows[i].cLo >= t.rows[i - 1].cHi && t.rows[i].iLo >= t.rows[i - 1].iHi && tableMonotonic(t, i + 1));
+}
+static_assert(tableMonotonic(table(EU_PM25)) && tableMonotonic(table(US_PM25)), "PM2.5 breakpoints must ascend");
+static_assert(tableMonotonic(table(US_O3)) && tableMonotonic(table(US_CO)), "gas breakpoints must ascend");
+
+} // namespace aqi
@@ -0,0 +1,46 @@
+#pragma once
+
+// ==========================================
+// BOOT PROFILE
+// ==========================================
+// Milliseconds since reset at which each boot milestone was first reached.
+// Phases can complete out of order (WiFi and NTP run while the GUI is being
+// built), so each is stamped independently; report() prints them all once
+// the first fresh data is on screen.
+
+#include <Arduino.h>
+
+enum class BootPhase : uint8_t {
+    Display,        // TFT + touch initialised
+    Lvgl,           // LVGL display, input and tick ready
+    Gui,            // widgets created
+    FirstFrame,     // first frame flushed to the panel
+    Wifi,           // IP address obtained
+    Ntp,            // clock set
+    Data,           // first successful sync on screen
+    Count
+};
+
+class BootProfile {
+public:
+    // First call per phase wins; safe from other tasks (WiFi/SNTP callbacks)
+    void mark(BootPhase p) {
+        uint8_t i = (uint8_t)p;
+        if (!at_[i]) at_[i] = millis();
+    }
+
+    bool reached(BootPhase p) const { return at_[(uint8_t)p] != 0; }
+
+    void report() const {
+        static const char* const names[] = {"display", "lvgl", "gui", "first frame", "wifi", "ntp", "data"};
+        Serial.print("[BOOT] ms since reset:");
+        for (uint8_t i = 0; i < (uint8_t)BootPhase::Count; i++) {
+            if (at_[i]) Serial.printf(" %s %u", names[i], (unsigned)at_[i]);
+            else Serial.printf(" %s --", names[i]);
+        }
+        Serial.println();
+    }
+
+private:
+    volatile uint32_t at_[(uint8_t)BootPhase::Count] = {};
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+// ==========================================
+// COUNTING CLIENT
+// ==========================================
+// A network client that counts what it is given to send, so the uplinks
+// report the bytes they wrote (request line and headers, MQTT packets
+// including CONNECT and PINGREQ) rather than an estimate. Over TLS these
+// are application bytes, before records and encryption.
+
+#include <WiFi.h>
+
+template <class Base>
+class CountingClient : public Base {
+public:
+    using Base::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t size) override {
+        size_t n = Base::write(buf, size);
+        written_ += n;
+        return n;
+    }
+
+    uint32_t written() const { return written_; }
+
+private:
+    uint32_t written_ = 0;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+// ==========================================
+// GPS LOCATION
+// ==========================================
+// NMEA from the NEO-6M is fed to TinyGPSPlus from the UART receive callback
+// (UART event task), never from loop(), so parsing costs the UI nothing.
+// loop() only takes a snapshot of the latest fix, which falls back to the
+// configured coordinates while there is no (fresh) fix.
+//
+// Locations are quantised to Open-Meteo grid cells: the API is only asked
+// again when the position leaves the current cell, and recent responses are
+// cached per cell.
+
+#include <Arduino.h>
+#include <TinyGPS++.h>
+#include "metrics.h"
+
+constexpr uint32_t GPS_BAUD          = 9600;
+constexpr uint32_t GPS_FIX_MAX_AGE   = 10000;    // ms before a fix counts as lost
+constexpr float    GRID_CELL_DEG     = 0.1f;     // ~11 km, CAMS / Open-Meteo resolution
+constexpr uint8_t  CELL_CACHE_SIZE   = 4;
+constexpr uint32_t CELL_CACHE_MAX_AGE = 15UL * 60 * 1000;   // Open-Meteo "current" refresh
+
+struct GridCell {
+    int16_t lat, lng;   // degrees / GRID_CELL_DEG, rounded
+
+    bool operator==(const GridCell& o) const { return lat == o.lat && lng == o.lng; }
+    bool operator!=(const GridCell& o) const { return !(*this == o); }
+
+    static GridCell of(float latDeg, float lngDeg) {
+        return GridCell{(int16_t)lroundf(latDeg / GRID_CELL_DEG), (int16_t)lroundf(lngDeg / GRID_CELL_DEG)};
+    }
+    float centerLat() const { return lat * GRID_CELL_DEG; }
+    float centerLng() const { return lng * GRID_CELL_DEG; }
+};
+
+struct GpsFix {
+    float lat, lng;
+    bool fromGps;       // false = fallback coordinates
+    uint8_t satellites;
+};
+
+class GpsLocation {
+public:
+    void begin(HardwareSerial& port, int rxPin, int txPin, float fallbackLat, float fallbackLng);
+
+    // Latest fix, or the fallback coordinates when there is none
+    GpsFix current();
+
+    uint32_t fixes() const { return fixes_; }      // position updates received
+
+private:
+    void onReceive();
+
+    HardwareSerial* port_ = nullptr;
+    TinyGPSPlus gps_;
+    portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+
+    // Written by the UART task, read by loop() under mux_
+    float lat_ = 0, lng_ = 0;
+    uint8_t sats_ = 0;
+    uint32_t fixAt_ = 0;
+    bool hasFix_ = false;
+    uint32_t fixes_ = 0;
+
+    float fallbackLat_ = 0, fallbackLng_ = 0;
+};
+
+// ------------------------------------------
+// Last readings per grid cell (LRU)
+// ------------------------------------------
+class CellCache {
+public:
+    struct Entry {
+        GridCell cell;
+        bool used;
+        uint32_t storedAt;
+        float value[METRIC_COUNT];
+    };
+
+    // Fresh entry for the cell, or nullptr
+    const Entry* find(const GridCell& cell, uint32_t now) const {
+        for (const Entry& e : entries_) {
+            if (e.used && e.cell == cell && now - e.storedAt < CELL_CACHE_MAX_AGE) return &e;
+        }
+        return nullptr;
+    }
+
+    void store(const GridCell& cell, const float* values, uint32_t now) {
+        Entry* slot = &entries_[0];
+        for (Entry& e : entries_) {
+            if (e.used && e.cell == cell) { slot = &e; break; }
+            if (!e.used || e.storedAt < slot->storedAt) slot = &e;
+        }
+        slot->cell = cell;
+        slot->used = true;
+        slot->storedAt = now;
+        memcpy(slot->value, values, sizeof(slot->value));
+    }
+
+private:
+    Entry entries_[CELL_CACHE_SIZE] = {};
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+// ==========================================
+// GZIP STREAM
+// ==========================================
+// Pull-based gzip decoder over another Stream, built on the miniz inflater
+// in the ESP32 ROM (no code added to flash). Output is read like any other
+// Stream, so it can feed Update.write() or deserializeJson() directly and
+// neither the compressed nor the decompressed data is ever held whole.
+//
+// Memory: the 32 KB history window (deflate's maximum distance) plus the
+// ~11 KB decompressor state are malloc'ed by begin() and released by end(),
+// i.e. only while a transfer is in flight. Small documents (API responses)
+// can use a smaller window: the whole output must then fit in it, so no
+// back-reference can reach outside, and more output stops with failed() and
+// overflowed() (the caller can then fetch the document uncompressed).
+//
+// The gzip trailer (CRC32 + size) is not checked; callers verify the
+// content themselves (SHA-256 for firmware, the parser for JSON).
+
+#include <Arduino.h>
+#include "esp32/rom/miniz.h"
+
+constexpr size_t GZIP_INPUT_CHUNK = 512;
+
+class GzipStream : public Stream {
+public:
+    // Waits for input with in's own timeout
+    explicit GzipStream(Stream& in, size_t window = TINFL_LZ_DICT_SIZE) : in_(in), windowSize_(window) {}
+    ~GzipStream() { end(); }
+
+    bool begin();       // allocates the window and reads the gzip header
+    void end();
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char* buffer, size_t length) override;
+    size_t write(uint8_t) override { return 0; }
+
+    bool done() const { return state_ == State::Done && outLen_ == 0; }
+    bool failed() const { return state_ == State::Error || state_ == State::Overflow; }
+    bool overflowed() const { return state_ == State::Overflow; }
+    size_t bytesIn() const { return bytesIn_; }     // compressed bytes consumed
+    size_t bytesOut() const { return bytesOut_; }   // decompressed bytes produced
+
+private:
+    enum class State : uint8_t { Idle, Body, Done, Error, Overflow };
+
+    bool readHeader();
+    bool skipString();
+    bool refill();
+    int nextInput();
+    bool fill();
+
+    Stream& in_;
+    State state_ = State::Idle;
+    tinfl_decompressor* inflater_ = nullptr;
+    uint8_t* window_ = nullptr;         // output wraps around it (full size) or fills it once
+    size_t windowSize_;
+    size_t windowPos_ = 0;
+    size_t outPos_ = 0, outLen_ = 0;    // produced but not yet read
+    uint8_t input_[GZIP_INPUT_CHUNK];
+    size_t inPos_ = 0, inLen_ = 0;
+    bool needsInput_ = true;
+    size_t bytesIn_ = 0, bytesOut_ = 0;
+};
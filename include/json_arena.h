@@ -0,0 +1,53 @@
+#pragma once
+
+// ==========================================
+// JSON ARENA
+// ==========================================
+// ArduinoJson allocator over a fixed, statically reserved buffer. Every
+// allocation is a bump of the top pointer; nothing is freed individually
+// except the most recent block (ArduinoJson grows strings and shrinks pools
+// that way). reset() rewinds the whole arena between requests, so parsing
+// never goes through malloc and cannot fragment the heap WiFi and LVGL use.
+//
+// When a response does not fit, allocate() fails: ArduinoJson stops with
+// DeserializationError::NoMemory and overflows() is incremented.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// At least twice the high water of the largest recorded response (JSON
+// parsed with the "current" filter, including an air-quality response with
+// a week of hourly data, or a FlatBuffers body), as
+// tools/host/test/json_arena_test checks against ArduinoJson 7; on the
+// board compare with station_json_arena_bytes{stat="high_water"}.
+constexpr size_t JSON_ARENA_SIZE = 6144;
+
+class JsonArena : public ArduinoJson::Allocator {
+public:
+    JsonArena(uint8_t* buffer, size_t size) : buf_(buffer), size_(size) {}
+
+    void* allocate(size_t size) override;
+    void deallocate(void* ptr) override;
+    void* reallocate(void* ptr, size_t newSize) override;
+
+    // Only once no JsonDocument still references the arena
+    void reset() { top_ = 0; last_ = nullptr; }
+
+    size_t used() const { return top_; }
+    size_t capacity() const { return size_; }
+    size_t highWater() const { return highWater_; }
+    uint32_t overflows() const { return overflows_; }
+
+private:
+    // Each block is preceded by its (aligned) size
+    static constexpr size_t HEADER = 8;
+    static size_t align(size_t n) { return (n + 7) & ~(size_t)7; }
+    static size_t& blockSize(void* ptr) { return *(size_t*)((uint8_t*)ptr - HEADER); }
+
+    uint8_t* buf_;
+    size_t size_;
+    size_t top_ = 0;
+    void* last_ = nullptr;      // most recent block, resizable in place
+    size_t highWater_ = 0;
+    uint32_t overflows_ = 0;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+// ==========================================
+// LAST READINGS
+// ==========================================
+// The last successful sync, kept across resets so the screen can show
+// (stale) values immediately after boot instead of "--" until WiFi, NTP and
+// both API calls have completed.
+//  * RTC slow memory: written every sync, survives software/WDT resets
+//  * NVS: written at most every LAST_READINGS_NVS_INTERVAL (flash wear),
+//    survives power loss
+// load() takes whichever copy is newer.
+
+#include <Arduino.h>
+#include "metrics.h"
+
+constexpr uint32_t LAST_READINGS_NVS_INTERVAL = 30UL * 60 * 1000;
+
+struct LastReadings {
+    uint32_t timestamp;     // unix time of the sync
+    float value[METRIC_COUNT];
+};
+
+class LastReadingsStore {
+public:
+    void save(const float* values, uint32_t timestamp);
+    bool load(LastReadings& out);
+
+private:
+    uint32_t lastNvsWrite_ = 0;
+    bool nvsWritten_ = false;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+// ==========================================
+// MEMORY-LEAN TLS CLIENT
+// ==========================================
+// Drop-in WiFiClient for HTTPClient::begin(client, "https://...") tuned to
+// coexist with LVGL on a PSRAM-less ESP32:
+//  * one mbedTLS config, CA chain and RNG shared by every connection
+//    (WiFiClientSecure builds all of these per client)
+//  * the SSL context and its record buffers exist only between connect()
+//    and stop(), i.e. while a request is in flight
+//  * max_fragment_length = 2 KB is offered, so servers that honour it send
+//    small records (and mbedTLS builds with variable buffer length shrink
+//    their buffers to match)
+//  * sessions are cached per host; reconnects present the session
+//    ID / ticket and skip the full handshake
+//
+// stats() tells full and resumed handshakes apart and keeps the heap low of
+// the last request, so both, with and without LEAN_TLS_MAX_FRAG, can be
+// compared against tools/api_standin.py --tls.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "mbedtls/ssl.h"
+#include "mbedtls/net_sockets.h"
+
+// Offer max_fragment_length = 2 KB; 0 to measure with default 16 KB records
+#ifndef LEAN_TLS_MAX_FRAG
+#define LEAN_TLS_MAX_FRAG 1
+#endif
+
+struct TlsStats {
+    uint32_t handshakes;
+    uint32_t failures;
+    uint32_t resumedOffers;     // handshakes started with a cached session
+    uint32_t resumed;           // ... that the server resumed
+    bool     lastResumed;
+    uint32_t lastHandshakeMs;
+    uint32_t heapBefore;        // free heap before the last connect
+    uint32_t heapLowest;        // lowest free heap seen during a TLS request
+    uint32_t lastHeapLowest;    // ... during the last one
+};
+
+constexpr uint8_t  TLS_SESSION_CACHE = 3;          // hosts we talk to
+constexpr uint32_t TLS_HANDSHAKE_TIMEOUT_MS = 10000;
+
+class LeanTlsClient : public WiFiClient {
+public:
+    ~LeanTlsClient() { stop(); }
+
+    // Once at startup. rootCaPem = PEM chain used to verify servers. Without
+    // one, allowUnverified encrypts without authenticating the server
+    // (passive sniffing of API keys is still prevented, active MITM is not).
+    // False when the CA is missing (and unverified is not allowed) or does
+    // not parse: every connect() is then refused.
+    static bool initShared(const char* rootCaPem, bool allowUnverified = false);
+    static const TlsStats& stats();
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(IPAddress ip, uint16_t port, int32_t timeout) override;
+    int connect(const char* host, uint16_t port) override;
+    int connect(const char* host, uint16_t port, int32_t timeout) override;
+
+    size_t write(uint8_t data) override { return write(&data, 1); }
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() { return connected(); }
+
+    struct Session;     // per-host cache entry (lean_tls.cpp)
+
+private:
+    bool handshake(const char* host, uint32_t timeoutMs);
+    void trackHeap();
+
+    mbedtls_ssl_context* ssl_ = nullptr;    // heap-allocated per connection
+    mbedtls_net_context net_;               // carries the WiFiClient socket fd
+    Session* session_ = nullptr;            // cache slot for the current host
+    int peeked_ = -1;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+// ==========================================
+// METRIC DEFINITIONS
+// ==========================================
+// The eight quantities the station fetches, in one place so the UI,
+// statistics and upload code (and host tools) agree on ids and units.
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum class Metric : uint8_t { Temperature, Pressure, PM25, PM10, NO2, SO2, O3, CO, Count };
+
+constexpr size_t METRIC_COUNT = static_cast<size_t>(Metric::Count);
+
+struct MetricInfo {
+    const char* key;      // Open-Meteo field name
+    const char* label;    // short display name
+    const char* unit;
+    uint8_t decimals;     // display precision
+};
+
+// Indexed by Metric
+constexpr MetricInfo METRIC_INFO[METRIC_COUNT] = {
+    {"temperature_2m",   "Temp",     "C",     1},
+    {"surface_pressure", "Pressure", "hPa",   0},
+    {"pm2_5",            "PM 2.5",   "ug/m3", 0},
+    {"pm10",             "PM 10",    "ug/m3", 0},
+    {"nitrogen_dioxide", "NO2",      "ug/m3", 1},
+    {"sulphur_dioxide",  "SO2",      "ug/m3", 1},
+    {"ozone",            "O3",       "ug/m3", 1},
+    {"carbon_monoxide",  "CO",       "ug/m3", 1},
+};
+
+constexpr size_t metricIndex(Metric m) { return static_cast<size_t>(m); }
+
+constexpr const MetricInfo& metricInfo(Metric m) { return METRIC_INFO[metricIndex(m)]; }
+
+// ThingSpeak channel layout written by the uplink and read back by
+// tools/station_csv: field number per metric, 0 = not uploaded.
+// field1/field2 carry the position, field5-7 the 24h statistics.
+constexpr uint8_t THINGSPEAK_FIELD[METRIC_COUNT] = {4, 0, 3, 0, 0, 0, 0, 0};
+
+// Sync cycle bookkeeping, reported over /metrics
+struct SyncStats {
+    uint32_t cycles;
+    uint32_t failedRequests;    // non-200 responses / connection errors
+    uint32_t parseErrors;       // 200 responses whose body was not the expected JSON
+    uint32_t lastDurationMs;
+    uint32_t maxDurationMs;
+    uint32_t lastUploadMs;      // uplink step of the last cycle
+    uint32_t uplinkBytes;       // application bytes sent by the uplink (cumulative)
+    uint32_t requests;          // HTTP requests started (API + uplink)
+    uint32_t cacheHits;         // cell changes and syncs served from the cell cache
+    uint32_t downloadBytes;     // API response bodies received (cumulative)
+    int32_t  lastHeapDelta;     // free heap after minus before the last cycle
+    uint32_t largestFreeBlock;  // largest allocatable block after the last cycle
+    uint32_t maxWdtGapMs;       // longest time between watchdog feeds
+    uint32_t jsonArenaHighWater;    // peak JSON arena use (json_arena.h)
+    uint32_t jsonArenaOverflows;    // responses that did not fit the arena
+    uint32_t gzipResponses;     // API responses that arrived gzip-encoded
+    uint32_t decodedBytes;      // JSON fed to the parser (downloadBytes before compression)
+    uint32_t transferMs;        // GET until body parsed, i.e. radio busy (cumulative)
+    uint32_t gzipHeapBytes;     // heap taken by the inflater during a fetch (largest seen)
+    uint32_t gzipFallbacks;     // gzip responses past GZIP_JSON_WINDOW, fetched again uncompressed
+    uint32_t flatBufferResponses;   // API responses decoded from FlatBuffers
+    uint32_t flatBufferFallbacks;   // FlatBuffers requests that failed and went to JSON
+};
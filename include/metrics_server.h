@@ -0,0 +1,71 @@
+#pragma once
+
+// ==========================================
+// LOCAL HTTP ENDPOINT
+// ==========================================
+//   GET /metrics                     Prometheus text format
+//   GET /readings?format=csv|json&since=<unix>
+//                                    history, chunked, streamed from ReadingLog
+//
+// Polled from loop(): each poll() does a bounded amount of work (one accept,
+// one request read, one /metrics section or at most HTTP_RECORDS_PER_POLL
+// records per connection) with fixed per-connection buffers, so a scraper
+// can never starve LVGL. Output is formatted into the connection's buffer
+// and written only as far as the socket takes it without blocking
+// (availableForWrite()); the rest goes out on later polls.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "metrics.h"
+#include "record_codec.h"
+#include "rolling_stats.h"
+
+constexpr uint8_t  HTTP_MAX_CLIENTS       = 2;
+constexpr size_t   HTTP_REQUEST_MAX       = 256;   // request line + headers we keep
+constexpr size_t   HTTP_CHUNK_MAX         = 768;   // output buffer: one /readings chunk or /metrics section
+constexpr uint16_t HTTP_RECORDS_PER_POLL  = 6;
+constexpr uint32_t HTTP_IDLE_TIMEOUT_MS   = 3000;
+
+class MetricsServer {
+public:
+    explicit MetricsServer(uint16_t port = 80) : server_(port) {}
+
+    void begin(const float* values, const StatsTable& stats, const ReadingLog& log, const SyncStats& sync);
+    void poll();
+
+private:
+    enum class State : uint8_t { Free, Request, Metrics, Streaming };
+    enum class Format : uint8_t { Csv, Json };
+
+    struct Conn {
+        WiFiClient client;
+        State state = State::Free;
+        Format format = Format::Csv;
+        bool first = true;
+        bool last = false;          // out holds the end of the response
+        uint8_t section = 0;        // next /metrics section
+        uint16_t reqLen = 0;
+        uint16_t outLen = 0, outPos = 0;
+        uint32_t lastActivity = 0;
+        ReadingLog::Cursor cursor;
+        char req[HTTP_REQUEST_MAX];
+        char out[HTTP_CHUNK_MAX];
+    };
+
+    void accept();
+    void readRequest(Conn& c);
+    void route(Conn& c);
+    bool flush(Conn& c);
+    void sendMetrics(Conn& c);
+    size_t renderMetrics(uint8_t section, char* buf, size_t cap);
+    void streamReadings(Conn& c);
+    void sendStatus(WiFiClient& client, const char* status);
+    void close(Conn& c);
+
+    WiFiServer server_;
+    Conn conns_[HTTP_MAX_CLIENTS];
+    const float* values_ = nullptr;
+    const MetricStats* stats_ = nullptr;
+    const ReadingLog* log_ = nullptr;
+    const SyncStats* sync_ = nullptr;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+// ==========================================
+// MQTT UPLINK
+// ==========================================
+// Alternative to the per-sample ThingSpeak HTTP GET: one persistent MQTT
+// connection (clean session off, stable client id, so the broker resumes
+// the session on reconnect) carrying one compact CSV line per sample:
+//
+//   <unix ts>,<8 metrics in Metric order>,<free heap>,<rssi>,<uptime s>
+//
+// Missing metrics are empty fields. Samples taken while the broker is
+// unreachable are queued (oldest dropped when full) and flushed in order
+// after reconnecting.
+// tools/host mqtt_uplink_test runs it against an in-process broker.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include "record_codec.h"
+#include "counting_client.h"
+
+constexpr uint8_t  MQTT_QUEUE_LEN        = 32;
+constexpr uint16_t MQTT_KEEPALIVE_S      = 90;     // sync interval is 60 s
+constexpr uint32_t MQTT_BACKOFF_MIN_MS   = 1000;
+constexpr uint32_t MQTT_BACKOFF_MAX_MS   = 60000;
+constexpr size_t   MQTT_PAYLOAD_MAX      = 160;
+
+struct MqttStats {
+    uint32_t published;
+    uint32_t dropped;           // overwritten in a full queue
+    uint32_t reconnects;
+    uint32_t bytesOut;          // every MQTT packet written (CONNECT, PUBLISH, PINGREQ...)
+    uint32_t lastPublishUs;     // time to hand the last batch to the socket
+};
+
+class MqttUplink {
+public:
+    MqttUplink() : mqtt_(net_) {}
+
+    void begin(const char* host, uint16_t port, const char* clientId,
+               const char* user, const char* pass, const char* topic);
+
+    // Queue a sample and flush if connected
+    void publish(const Reading& r);
+
+    // Call from loop(): keep-alive, reconnect with backoff, flush queue
+    void loop();
+
+    bool connected() { return mqtt_.connected(); }
+    uint8_t queued() const { return count_; }
+    const MqttStats& stats();
+
+private:
+    struct Sample {
+        Reading reading;
+        uint32_t freeHeap;
+        uint32_t uptime;
+        int8_t rssi;
+    };
+
+    bool reconnect();
+    void flush();
+    size_t format(const Sample& s, char* out, size_t cap) const;
+
+    CountingClient<WiFiClient> net_;
+    PubSubClient mqtt_;
+    const char* clientId_ = nullptr;
+    const char* user_ = nullptr;
+    const char* pass_ = nullptr;
+    const char* topic_ = nullptr;
+
+    Sample queue_[MQTT_QUEUE_LEN];
+    uint8_t head_ = 0, count_ = 0;      // head_ = oldest
+
+    uint32_t nextAttempt_ = 0;
+    uint32_t backoff_ = MQTT_BACKOFF_MIN_MS;
+    MqttStats stats_ = {0, 0, 0, 0, 0};
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+// ==========================================
+// OPEN-METEO FLATBUFFERS READER
+// ==========================================
+// Reads the binary response Open-Meteo sends for &format=flatbuffers (the
+// format of its official SDKs) in place: every accessor is a couple of
+// bounds-checked offset lookups into the received bytes. Nothing is parsed
+// up front, no number is converted from text and nothing is allocated.
+//
+// Only the parts of the schema (weather_api.fbs) the station can use are
+// mapped. Variables come back in the order they were listed in the request
+// (&current=a,b,c), so they are looked up by index rather than by the
+// schema's Variable enum. Every read of a truncated or foreign buffer yields
+// "absent" (an invalid table, count 0, NAN) instead of reading past the end.
+// Builders leave out scalars equal to the schema default (0), so a valid
+// table without the field reads as 0, not as absent.
+// Header-only and free of Arduino dependencies so host tools can reuse it.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+namespace omfb {
+
+// Table field ids in weather_api.fbs
+enum class ResponseField : uint8_t {
+    Latitude = 0, Longitude = 1, Elevation = 2, UtcOffsetSeconds = 6,
+    Current = 9, Daily = 10, Hourly = 11, Minutely15 = 12
+};
+enum class TimeField : uint8_t { Time = 0, TimeEnd = 1, Interval = 2, Variables = 3 };
+enum class VariableField : uint8_t { Variable = 0, Unit = 1, Value = 2, Values = 3 };
+
+// One FlatBuffers table: a position in the buffer plus the vtable that
+// says where (and whether) each field is stored
+class Table {
+public:
+    Table() = default;
+    Table(const uint8_t* buf, size_t len, size_t pos) : buf_(buf), len_(len) {
+        if (pos + 4 > len) return;
+        int64_t vt = (int64_t)pos - read<int32_t>(pos);
+        if (vt < 0 || (size_t)vt + 4 > len) return;
+        vtSize_ = read<uint16_t>((size_t)vt);
+        if ((size_t)vt + vtSize_ > len || vtSize_ < 4) return;
+        vtable_ = (size_t)vt;
+        pos_ = pos;
+    }
+
+    bool valid() const { return vtSize_ != 0; }
+
+    template <typename T>
+    T scalar(uint8_t field, T absent) const {
+        size_t off = fieldPos(field);
+        return off && off + sizeof(T) <= len_ ? read<T>(off) : absent;
+    }
+
+    Table table(uint8_t field) const {
+        size_t at = target(field);
+        return at ? Table(buf_, len_, at) : Table();
+    }
+
+    // Start of a vector's elements and its length (0 if absent or out of bounds)
+    size_t vector(uint8_t field, size_t elemSize, uint32_t& count) const {
+        count = 0;
+        size_t at = target(field);
+        if (!at || at + 4 > len_) return 0;
+        uint32_t n = read<uint32_t>(at);
+        if (n > (len_ - at - 4) / elemSize) return 0;
+        count = n;
+        return at + 4;
+    }
+
+    // Table referenced by element i of a vector of tables starting at elems
+    Table element(size_t elems, uint32_t i) const {
+        size_t at = elems + (size_t)i * 4;
+        uint32_t rel = read<uint32_t>(at);
+        return rel && at + rel < len_ ? Table(buf_, len_, at + rel) : Table();
+    }
+
+    template <typename T>
+    T read(size_t pos) const {
+        T v;
+        memcpy(&v, buf_ + pos, sizeof(T));  // little-endian, possibly unaligned
+        return v;
+    }
+
+private:
+    // Absolute position of a field's inline data, 0 if the field is absent
+    size_t fieldPos(uint8_t field) const {
+        size_t entry = 4 + 2 * (size_t)field;
+        if (!valid() || entry + 2 > vtSize_) return 0;
+        uint16_t off = read<uint16_t>(vtable_ + entry);
+        return off ? pos_ + off : 0;
+    }
+
+    // Absolute position an offset field points at, 0 if absent or out of bounds
+    size_t target(uint8_t field) const {
+        size_t off = fieldPos(field);
+        if (!off || off + 4 > len_) return 0;
+        uint32_t rel = read<uint32_t>(off);
+        return rel && off + rel < len_ ? off + rel : 0;
+    }
+
+    const uint8_t* buf_ = nullptr;
+    size_t len_ = 0;
+    size_t pos_ = 0;
+    size_t vtable_ = 0;
+    uint16_t vtSize_ = 0;
+};
+
+class Variable {
+public:
+    explicit Variable(const Table& t) : t_(t) {}
+
+    bool valid() const { return t_.valid(); }
+    uint8_t id() const { return t_.scalar<uint8_t>((uint8_t)VariableField::Variable, 0); }
+
+    // Current conditions carry a single value...
+    float value() const { return valid() ? t_.scalar<float>((uint8_t)VariableField::Value, 0.0f) : NAN; }
+
+    // ...hourly / daily ones a series
+    uint32_t count() const {
+        uint32_t n;
+        t_.vector((uint8_t)VariableField::Values, sizeof(float), n);
+        return n;
+    }
+    float at(uint32_t i) const {
+        uint32_t n;
+        size_t elems = t_.vector((uint8_t)VariableField::Values, sizeof(float), n);
+        return i < n ? t_.read<float>(elems + (size_t)i * sizeof(float)) : NAN;
+    }
+
+private:
+    Table t_;
+};
+
+// A "current", "hourly", ... block: its time axis and one entry per variable
+class VariablesWithTime {
+public:
+    explicit VariablesWithTime(const Table& t) : t_(t) {}
+
+    bool valid() const { return t_.valid(); }
+    int64_t time() const { return t_.scalar<int64_t>((uint8_t)TimeField::Time, 0); }
+    int64_t timeEnd() const { return t_.scalar<int64_t>((uint8_t)TimeField::TimeEnd, 0); }
+    int32_t interval() const { return t_.scalar<int32_t>((uint8_t)TimeField::Interval, 0); }
+
+    uint32_t count() const {
+        uint32_t n;
+        t_.vector((uint8_t)TimeField::Variables, 4, n);
+        return n;
+    }
+    Variable variable(uint32_t i) const {
+        uint32_t n;
+        size_t elems = t_.vector((uint8_t)TimeField::Variables, 4, n);
+        return Variable(i < n ? t_.element(elems, i) : Table());
+    }
+
+private:
+    Table t_;
+};
+
+class Response {
+public:
+    // buf holds one size-prefixed response (one location was requested)
+    Response(const uint8_t* buf, size_t len) {
+        if (len < 8) return;
+        uint32_t size, root;
+        memcpy(&size, buf, 4);
+        memcpy(&root, buf + 4, 4);
+        if (size > len - 4) return;         // truncated
+        if (root < size) t_ = Table(buf + 4, size, root);
+    }
+
+    bool valid() const { return t_.valid(); }
+    float latitude() const { return valid() ? t_.scalar<float>((uint8_t)ResponseField::Latitude, 0.0f) : NAN; }
+    float longitude() const { return valid() ? t_.scalar<float>((uint8_t)ResponseField::Longitude, 0.0f) : NAN; }
+    int32_t utcOffsetSeconds() const { return t_.scalar<int32_t>((uint8_t)ResponseField::UtcOffsetSeconds, 0); }
+
+    VariablesWithTime current() const { return VariablesWithTime(t_.table((uint8_t)ResponseField::Current)); }
+    VariablesWithTime hourly() const { return VariablesWithTime(t_.table((uint8_t)ResponseField::Hourly)); }
+    VariablesWithTime daily() const { return VariablesWithTime(t_.table((uint8_t)ResponseField::Daily)); }
+
+private:
+    Table t_;
+};
+
+} // namespace omfb
@@ -0,0 +1,59 @@
+#pragma once
+
+// ==========================================
+// OTA FIRMWARE UPDATE
+// ==========================================
+// Polls a manifest over HTTP; when it names a newer version, the gzip'ed
+// image is inflated on the fly (GzipStream) into the inactive app slot in
+// OTA_CHUNK pieces, hashed with SHA-256 while it is written, and only made
+// bootable when the hash matches. Needs a two-slot partition table
+// (min_spiffs.csv).
+//
+// Manifest, one line (see tools/make_ota.py):
+//   <version> <sha256 of firmware.bin, hex> <url of firmware.bin.gz>
+//
+// Rollback: the Arduino bootloader is built without app rollback, so the new
+// image starts on trial (a counter in NVS). It must call markHealthy() once
+// it works (first successful sync); if it resets OTA_TRIAL_BOOTS times
+// before that, checkBoot() boots the previous slot again. The version rolled
+// back is kept in NVS and check() skips it (and anything older), so a bad
+// release is not reinstalled at every check; publish a higher version.
+
+#include <Arduino.h>
+
+constexpr uint32_t OTA_CHECK_INTERVAL = 6UL * 3600 * 1000;
+constexpr uint32_t OTA_FIRST_CHECK    = 2UL * 60 * 1000;   // after boot
+constexpr uint32_t OTA_TIMEOUT_MS     = 10000;
+constexpr size_t   OTA_CHUNK          = 1024;
+constexpr uint8_t  OTA_TRIAL_BOOTS    = 3;
+
+struct OtaStats {
+    uint32_t checks;
+    uint32_t failures;
+    uint32_t lastCompressedBytes;   // bytes on air
+    uint32_t lastImageBytes;        // bytes written to flash
+    uint32_t lastDurationMs;
+};
+
+class OtaUpdater {
+public:
+    void begin(const char* manifestUrl, uint32_t currentVersion);
+
+    // Checks the manifest when due. A successful update restarts the board.
+    void poll();
+
+    static void checkBoot();        // early in setup()
+    static void markHealthy();
+
+    const OtaStats& stats() const { return stats_; }
+
+private:
+    bool check();
+    bool install(uint32_t version, const char* url, const char* sha256Hex);
+
+    const char* manifestUrl_ = nullptr;
+    uint32_t version_ = 0;
+    uint32_t rejected_ = 0;         // last version rolled back (NVS)
+    uint32_t nextCheck_ = OTA_FIRST_CHECK;
+    OtaStats stats_ = {};
+};
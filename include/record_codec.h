@@ -0,0 +1,120 @@
+#pragma once
+
+// ==========================================
+// BINARY READING RECORDS
+// ==========================================
+// Compact encoding of one timestamped set of the eight metrics:
+//
+//   flags (1 byte)   bit0 = keyframe
+//   mask  (1 byte)   bit i set = metric i present
+//   time  (varint)   keyframe: absolute unix seconds, else delta to previous
+//   value (zig-zag varint) per present metric, fixed point (RECORD_SCALE);
+//                    keyframe: absolute, else delta to the metric's last value
+//
+// A typical one-minute delta record is ~11 bytes instead of 36 for raw
+// floats (tools/record_bench). Decoding must start at a keyframe. No Arduino dependencies, so
+// host tools can read exported logs with the same code.
+
+#include <stdint.h>
+#include <stddef.h>
+#include "metrics.h"
+
+struct Reading {
+    uint32_t timestamp;             // unix seconds
+    float value[METRIC_COUNT];      // NAN = missing
+};
+
+// Fixed-point multiplier per metric (indexed by Metric)
+constexpr float RECORD_SCALE[METRIC_COUNT] = {
+    100,    // Temperature: 0.01 C
+    10,     // Pressure:    0.1 hPa
+    10,     // PM2.5
+    10,     // PM10
+    10,     // NO2
+    10,     // SO2
+    10,     // O3
+    10,     // CO
+};
+
+// flags + mask + 5-byte varint time + 5-byte varint per metric
+constexpr size_t RECORD_MAX_SIZE = 2 + 5 + 5 * METRIC_COUNT;
+
+class RecordEncoder {
+public:
+    // Forget the previous record: the next one is written as a keyframe
+    void reset() { havePrev_ = false; }
+
+    // Encode r into out. Writes a keyframe when asked to, after reset() or
+    // when time runs backwards. Returns bytes written, or 0 (state unchanged)
+    // if the record does not fit into cap bytes.
+    size_t encode(const Reading& r, uint8_t* out, size_t cap, bool keyframe = false);
+
+private:
+    bool havePrev_ = false;
+    uint32_t prevTime_ = 0;
+    int32_t prevValue_[METRIC_COUNT] = {};
+};
+
+class RecordDecoder {
+public:
+    void reset() { havePrev_ = false; }
+
+    // Decode one record from in. Returns bytes consumed, or 0 when the input
+    // is truncated, malformed, or a delta record arrives before any keyframe.
+    size_t decode(const uint8_t* in, size_t len, Reading& r);
+
+private:
+    bool havePrev_ = false;
+    uint32_t prevTime_ = 0;
+    int32_t prevValue_[METRIC_COUNT] = {};
+};
+
+// ------------------------------------------
+// In-RAM history: a ring of fixed-size blocks, each starting with a
+// keyframe so any block can be decoded on its own. When full, the oldest
+// block is recycled.
+// ------------------------------------------
+constexpr size_t HISTORY_BLOCK_SIZE  = 512;
+constexpr size_t HISTORY_BLOCK_COUNT = 16;
+
+class ReadingLog {
+public:
+    void append(const Reading& r);
+    void clear();
+
+    uint32_t recordCount() const;
+    size_t bytesUsed() const;
+
+    // Sequential reader. Survives appends between calls: if the block it is
+    // reading gets recycled it skips ahead to the oldest remaining block.
+    class Cursor {
+    public:
+        bool next(Reading& r);
+    private:
+        friend class ReadingLog;
+        const ReadingLog* log_ = nullptr;
+        uint32_t since_ = 0;
+        uint32_t blockSeq_ = 0;     // sequence number of the block being read
+        uint16_t offset_ = 0;
+        RecordDecoder decoder_;
+    };
+
+    // Cursor over all records with timestamp >= since (0 = everything)
+    Cursor from(uint32_t since = 0) const;
+
+private:
+    struct Block {
+        uint8_t data[HISTORY_BLOCK_SIZE];
+        uint16_t used;
+        uint16_t records;
+        uint32_t firstTime;
+    };
+
+    const Block* blockBySeq(uint32_t seq) const;
+    uint32_t oldestSeq() const { return nextSeq_ - blockCount_; }
+
+    Block blocks_[HISTORY_BLOCK_COUNT];
+    uint32_t nextSeq_ = 0;      // sequence number the next new block gets
+    uint16_t blockCount_ = 0;   // blocks in use
+    RecordEncoder encoder_;
+};
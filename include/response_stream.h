@@ -0,0 +1,45 @@
+#pragma once
+
+// ==========================================
+// RESPONSE STREAM
+// ==========================================
+// Read-only pass-through over an HTTP body (HTTPClient::getStream()) so the
+// JSON parser can consume it directly instead of a String copy. Counts the
+// bytes read and the time the parser spent pulling them (waiting on the
+// socket).
+
+#include <Arduino.h>
+
+class ResponseStream : public Stream {
+public:
+    ResponseStream(Stream& in, uint32_t timeoutMs) : in_(in) { setTimeout(timeoutMs); }
+
+    int available() override { return in_.available(); }
+
+    int read() override {
+        int c = in_.read();
+        if (c >= 0) bytes_++;
+        return c;
+    }
+
+    int peek() override { return in_.peek(); }
+
+    // ArduinoJson pulls every character through readBytes(), so this is the
+    // download share of deserializeJson(); the rest is parsing
+    size_t readBytes(char* buffer, size_t length) override {
+        uint32_t start = micros();
+        size_t n = Stream::readBytes(buffer, length);
+        readMicros_ += micros() - start;
+        return n;
+    }
+
+    size_t write(uint8_t) override { return 0; }
+
+    size_t bytes() const { return bytes_; }
+    uint32_t readMicros() const { return readMicros_; }
+
+private:
+    Stream& in_;
+    size_t bytes_ = 0;
+    uint32_t readMicros_ = 0;
+};
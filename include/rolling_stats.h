@@ -0,0 +1,161 @@
+#pragma once
+
+// ==========================================
+// ROLLING STATISTICS
+// ==========================================
+// Sliding-window min / max / mean and EWMA with O(1) amortised update and
+// fixed memory. Samples are folded into time buckets; the window keeps the
+// last N closed buckets and tracks min/max with monotonic deques over the
+// bucket ring, so nothing is ever rescanned.
+//
+// One MetricStats is 2280 B, of which 432 B are the min/max deques; the
+// StatsTable for all eight metrics is 18240 B of .bss
+// (tools/host/test/rolling_stats_test prints and checks these).
+
+#include <stdint.h>
+#include <math.h>
+#include "metrics.h"
+
+struct WindowSummary {
+    float min;
+    float max;
+    float mean;
+    uint32_t count;     // samples in the window (0 = no data)
+};
+
+// ------------------------------------------
+// Min / max / sum over the last N slots
+// ------------------------------------------
+template <uint16_t N>
+class SlidingWindow {
+public:
+    struct Slot {
+        float lo, hi, sum;
+        uint16_t n;
+    };
+
+    void clear() {
+        head_ = size_ = 0;
+        minFront_ = minLen_ = maxFront_ = maxLen_ = 0;
+        sum_ = 0;
+        count_ = 0;
+    }
+
+    // Append a slot, evicting the oldest once N slots are held.
+    void push(const Slot& s) {
+        uint16_t pos = head_;
+        if (size_ == N) {
+            // The slot about to be overwritten is the oldest one
+            sum_ -= slots_[pos].sum;
+            count_ -= slots_[pos].n;
+            if (minLen_ && minQ_[minFront_] == pos) { minFront_ = next(minFront_); minLen_--; }
+            if (maxLen_ && maxQ_[maxFront_] == pos) { maxFront_ = next(maxFront_); maxLen_--; }
+        } else {
+            size_++;
+        }
+        slots_[pos] = s;
+        sum_ += s.sum;
+        count_ += s.n;
+        head_ = next(head_);
+        if (s.n == 0) return; // empty slots never become min or max
+
+        // Min deque: ascending from front, drop everything not smaller than the new value
+        while (minLen_ && slots_[minQ_[back(minFront_, minLen_)]].lo >= s.lo) minLen_--;
+        minQ_[wrap(minFront_ + minLen_)] = pos; minLen_++;
+        // Max deque: descending from front
+        while (maxLen_ && slots_[maxQ_[back(maxFront_, maxLen_)]].hi <= s.hi) maxLen_--;
+        maxQ_[wrap(maxFront_ + maxLen_)] = pos; maxLen_++;
+    }
+
+    uint32_t count() const { return count_; }
+    float sum() const { return (float)sum_; }
+    float lowest() const { return minLen_ ? slots_[minQ_[minFront_]].lo : INFINITY; }
+    float highest() const { return maxLen_ ? slots_[maxQ_[maxFront_]].hi : -INFINITY; }
+
+private:
+    static uint16_t next(uint16_t i) { return i + 1 == N ? 0 : i + 1; }
+    static uint16_t wrap(uint16_t i) { return i >= N ? i - N : i; }
+    static uint16_t back(uint16_t front, uint16_t len) { return wrap(front + len - 1); }
+
+    Slot slots_[N];
+    uint16_t minQ_[N], maxQ_[N];
+    uint16_t head_ = 0, size_ = 0;
+    uint16_t minFront_ = 0, minLen_ = 0;
+    uint16_t maxFront_ = 0, maxLen_ = 0;
+    double sum_ = 0;    // double: avoids drift from repeated add/subtract
+    uint32_t count_ = 0;
+};
+
+// ------------------------------------------
+// Time-bucketed window: N buckets of BucketSec seconds plus the bucket
+// currently being filled. A sample from before the current bucket (the
+// clock was set back) empties the window like a gap longer than it.
+// ------------------------------------------
+template <uint16_t N, uint32_t BucketSec>
+class BucketedWindow {
+public:
+    void add(float v, uint32_t nowSec) {
+        uint32_t id = nowSec / BucketSec;
+        if (!started_) {
+            started_ = true;
+            bucketId_ = id;
+        } else if (id != bucketId_) {
+            window_.push(cur_);
+            // Buckets without samples still age the window
+            uint32_t gap = id - bucketId_ - 1;
+            if (gap > N) gap = N;
+            for (uint32_t i = 0; i < gap; i++) window_.push(EMPTY);
+            cur_ = EMPTY;
+            bucketId_ = id;
+        }
+        if (v < cur_.lo) cur_.lo = v;
+        if (v > cur_.hi) cur_.hi = v;
+        cur_.sum += v;
+        cur_.n++;
+    }
+
+    WindowSummary summary() const {
+        WindowSummary s;
+        s.count = window_.count() + cur_.n;
+        s.min = fminf(window_.lowest(), cur_.lo);
+        s.max = fmaxf(window_.highest(), cur_.hi);
+        s.mean = s.count ? (window_.sum() + cur_.sum) / s.count : NAN;
+        if (!s.count) s.min = s.max = NAN;
+        return s;
+    }
+
+private:
+    typedef typename SlidingWindow<N>::Slot Slot;
+    static constexpr Slot EMPTY = {INFINITY, -INFINITY, 0, 0};
+
+    SlidingWindow<N> window_;
+    Slot cur_ = EMPTY;
+    uint32_t bucketId_ = 0;
+    bool started_ = false;
+};
+
+template <uint16_t N, uint32_t BucketSec>
+constexpr typename BucketedWindow<N, BucketSec>::Slot BucketedWindow<N, BucketSec>::EMPTY;
+
+// ------------------------------------------
+// Per-metric statistics: 1 h at 1 min resolution, 24 h at 30 min
+// resolution, and an exponentially weighted moving average (/metrics:
+// station_reading_ewma).
+// ------------------------------------------
+constexpr float EWMA_ALPHA = 0.2f;
+
+struct MetricStats {
+    BucketedWindow<60, 60>   hour;
+    BucketedWindow<48, 1800> day;
+    float ewma = NAN;
+
+    void add(float v, uint32_t nowSec) {
+        if (isnan(v)) return;
+        hour.add(v, nowSec);
+        day.add(v, nowSec);
+        ewma = isnan(ewma) ? v : ewma + EWMA_ALPHA * (v - ewma);
+    }
+};
+
+// One MetricStats per Metric, indexed by metricIndex()
+typedef MetricStats StatsTable[METRIC_COUNT];
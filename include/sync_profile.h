@@ -0,0 +1,115 @@
+#pragma once
+
+// ==========================================
+// SYNC PROFILE
+// ==========================================
+// Where a sync spends its time. Every phase of every request is timed with
+// micros() and folded into a fixed-bucket log-scale histogram, so p50/p95/p99
+// stay available for the whole uptime at a constant ~170 bytes per phase.
+//
+// Buckets: 4 per power of two from 64 us to 67 s, i.e. a reported percentile
+// is the upper edge of its bucket and at most 25% above the true value.
+// Counts saturate at 65535 samples per bucket (45 days at one sync a minute).
+
+#include <Arduino.h>
+
+enum class SyncPhase : uint8_t {
+    Dns,            // host name lookup
+    Connect,        // TCP connect (+ TLS handshake)
+    Ttfb,           // request sent until the response headers are in
+    Download,       // waiting for / reading body bytes
+    Parse,          // deserializeJson() (incl. gzip inflate) minus the time spent reading
+    Ui,             // widget updates under the LVGL lock (drawing happens later)
+    Upload,         // ThingSpeak GET or MQTT publish
+    Cycle,          // the whole syncData()
+    Count
+};
+constexpr size_t SYNC_PHASE_COUNT = static_cast<size_t>(SyncPhase::Count);
+
+class LatencyHistogram {
+public:
+    static constexpr uint8_t SUB_BITS  = 2;                 // 4 buckets per octave
+    static constexpr uint8_t MIN_SHIFT = 6;                 // 64 us
+    static constexpr uint8_t MAX_SHIFT = 26;                // 67 s
+    static constexpr size_t  BUCKETS   = (MAX_SHIFT - MIN_SHIFT) << SUB_BITS;
+
+    void add(uint32_t us) {
+        size_t i = bucketOf(us);
+        if (counts_[i] != UINT16_MAX) counts_[i]++;
+        if (total_ != UINT32_MAX) total_++;
+        if (us > max_) max_ = us;
+    }
+
+    // Upper edge of the bucket holding the p-th percentile (0 with no samples)
+    uint32_t percentile(uint8_t p) const {
+        if (!total_) return 0;
+        uint32_t target = (uint32_t)(((uint64_t)total_ * p + 99) / 100);
+        if (!target) target = 1;
+        uint32_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            seen += counts_[i];
+            if (seen >= target) return upperEdge(i) < max_ ? upperEdge(i) : max_;
+        }
+        return max_;        // only reached once buckets have saturated
+    }
+
+    uint32_t count() const { return total_; }
+    uint32_t highest() const { return max_; }
+
+private:
+    static size_t bucketOf(uint32_t us) {
+        if (us < (1UL << MIN_SHIFT)) return 0;
+        uint8_t msb = 31 - __builtin_clz(us);
+        if (msb >= MAX_SHIFT) return BUCKETS - 1;
+        return ((msb - MIN_SHIFT) << SUB_BITS) + ((us >> (msb - SUB_BITS)) & ((1u << SUB_BITS) - 1));
+    }
+
+    static uint32_t upperEdge(size_t i) {
+        uint8_t msb = MIN_SHIFT + (i >> SUB_BITS);
+        uint32_t sub = i & ((1u << SUB_BITS) - 1);
+        return ((1UL << SUB_BITS) + sub + 1) << (msb - SUB_BITS);
+    }
+
+    uint16_t counts_[BUCKETS] = {};
+    uint32_t total_ = 0;
+    uint32_t max_ = 0;
+};
+
+// Stopwatch for consecutive phases: lap() returns the time since the
+// previous lap (or construction) and restarts
+class PhaseClock {
+public:
+    PhaseClock() : last_(micros()) {}
+
+    uint32_t lap() {
+        uint32_t now = micros();
+        uint32_t us = now - last_;
+        last_ = now;
+        return us;
+    }
+
+private:
+    uint32_t last_;
+};
+
+class SyncProfile {
+public:
+    void add(SyncPhase p, uint32_t us) { phase_[(uint8_t)p].add(us); }
+
+    const LatencyHistogram& phase(SyncPhase p) const { return phase_[(uint8_t)p]; }
+
+    void report() const {
+        static const char* const names[] = {"dns", "connect", "ttfb", "download", "parse", "ui", "upload", "cycle"};
+        Serial.println("[PHASE] ms         n     p50     p95     p99     max");
+        for (uint8_t i = 0; i < SYNC_PHASE_COUNT; i++) {
+            const LatencyHistogram& h = phase_[i];
+            if (!h.count()) continue;
+            Serial.printf("[PHASE] %-8s %5u %7.1f %7.1f %7.1f %7.1f\n", names[i], (unsigned)h.count(),
+                          h.percentile(50) / 1000.0f, h.percentile(95) / 1000.0f,
+                          h.percentile(99) / 1000.0f, h.highest() / 1000.0f);
+        }
+    }
+
+private:
+    LatencyHistogram phase_[SYNC_PHASE_COUNT];
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+// ==========================================
+// UI LAYOUT
+// ==========================================
+// The whole screen as constexpr data: one WidgetSpec per widget, built in a
+// single pass by create_gui(). Value labels are bound to a Metric and render
+// "<text><value> <unit>" from METRIC_INFO, so adding a metric to the screen
+// is one table row. Widgets are addressed by UiId (or by Metric for bound
+// labels) instead of one global per widget.
+
+#include <lvgl.h>
+#include "metrics.h"
+
+enum class Tab : uint8_t { System, Air, Weather, Count };
+constexpr size_t TAB_COUNT = static_cast<size_t>(Tab::Count);
+constexpr const char* TAB_NAMES[TAB_COUNT] = {"SYSTEM", "AIR QUAL", "WEATHER"};
+
+// Table order: UI_LAYOUT[i].id == i (checked below)
+enum class UiId : uint8_t {
+    // SYSTEM
+    Clock, Status, GpsPanel, Lat, Lng, InfoMode,
+    // AIR QUAL
+    Pm25, Pm10, Pm25Stats, No2, O3, So2, Co, Aqi, AqiBar,
+    // WEATHER
+    Temp, Pressure, TempRange,
+    Count,
+    None = 0xFF
+};
+constexpr size_t UI_WIDGET_COUNT = static_cast<size_t>(UiId::Count);
+
+enum class WidgetKind : uint8_t { Label, Panel, Bar };
+
+constexpr uint32_t UI_NO_COLOR = 0xFFFFFFFF;     // keep the theme's colour
+constexpr uint32_t UI_WHITE    = 0xFFFFFF;
+constexpr uint32_t UI_CYAN     = 0x00FFFF;
+constexpr uint32_t UI_GREY     = 0x9E9E9E;       // lv_palette_main(LV_PALETTE_GREY)
+constexpr uint32_t UI_GREEN    = 0x4CAF50;       // lv_palette_main(LV_PALETTE_GREEN)
+
+struct WidgetSpec {
+    UiId id;
+    WidgetKind kind;
+    Tab tab;
+    UiId parent;            // a Panel in the same tab, or None = the tab itself
+    lv_align_t align;
+    int16_t x, y;
+    int16_t w, h;           // 0 = size to content
+    uint8_t font;           // Montserrat size, 0 = theme default
+    uint32_t color;         // text colour (Label) / border colour (Panel)
+    uint32_t bg;            // background (Panel)
+    Metric metric;          // bound value, Metric::Count = static text
+    const char* text;       // initial text, or the prefix of a bound value
+};
+
+constexpr WidgetSpec UI_LAYOUT[UI_WIDGET_COUNT] = {
+    // id               kind               tab           parent          align                  x    y    w    h  font color        bg           metric               text
+    {UiId::Clock,       WidgetKind::Label, Tab::System,  UiId::None,     LV_ALIGN_TOP_RIGHT,  -10,   5,   0,   0, 20, UI_CYAN,     UI_NO_COLOR, Metric::Count,       "00:00"},
+    {UiId::Status,      WidgetKind::Label, Tab::System,  UiId::None,     LV_ALIGN_TOP_LEFT,    10,   5,   0,   0,  0, UI_NO_COLOR, UI_NO_COLOR, Metric::Count,       "WiFi: ... | Gdansk"},
+    {UiId::GpsPanel,    WidgetKind::Panel, Tab::System,  UiId::None,     LV_ALIGN_TOP_MID,      0,  40, 280,  90,  0, UI_GREEN,    0x000000,    Metric::Count,       nullptr},
+    {UiId::Lat,         WidgetKind::Label, Tab::System,  UiId::GpsPanel, LV_ALIGN_TOP_MID,      0,  10,   0,   0, 20, UI_WHITE,    UI_NO_COLOR, Metric::Count,       "LAT: --"},
+    {UiId::Lng,         WidgetKind::Label, Tab::System,  UiId::GpsPanel, LV_ALIGN_BOTTOM_MID,   0, -10,   0,   0, 20, UI_WHITE,    UI_NO_COLOR, Metric::Count,       "LNG: --"},
+    {UiId::InfoMode,    WidgetKind::Label, Tab::System,  UiId::None,     LV_ALIGN_TOP_LEFT,    10, 140,   0,   0,  0, UI_GREY,     UI_NO_COLOR, Metric::Count,       "Loc Source: --\nAuto-Update: Every 60s\nNTP Clock: Enabled"},
+
+    {UiId::Pm25,        WidgetKind::Label, Tab::Air,     UiId::None,     LV_ALIGN_TOP_LEFT,    10,  20,   0,   0,  0, UI_NO_COLOR, UI_NO_COLOR, Metric::PM25,        "PM 2.5: "},
+    {UiId::Pm10,        WidgetKind::Label, Tab::Air,     UiId::None,     LV_ALIGN_TOP_LEFT,    10,  50,   0,   0,  0, UI_NO_COLOR, UI_NO_COLOR, Metric::PM10,        "PM 10:  "},
+    {UiId::Pm25Stats,   WidgetKind::Label, Tab::Air,     UiId::None,     LV_ALIGN_TOP_LEFT,    10,  80,   0,   0,  0, UI_GREY,     UI_NO_COLOR, Metric::Count,       "PM2.5 24h max: --\n1h avg: --"},
+    {UiId::No2,         WidgetKind::Label, Tab::Air,     UiId::None,     LV_ALIGN_TOP_RIGHT,  -10,  20,   0,   0,  0, UI_NO_COLOR, UI_NO_COLOR, Metric::NO2,         "NO2: "},
+    {UiId::O3,          WidgetKind::Label, Tab::Air,     UiId::None,     LV_ALIGN_TOP_RIGHT,  -10,  45,   0,   0,  0, UI_NO_COLOR, UI_NO_COLOR, Metric::O3,          "O3:  "},
+    {UiId::So2,         WidgetKind::Label, Tab::Air,     UiId::None,     LV_ALIGN_TOP_RIGHT,  -10,  70,   0,   0,  0, UI_NO_COLOR, UI_NO_COLOR, Metric::SO2,         "SO2: "},
+    {UiId::Co,          WidgetKind::Label, Tab::Air,     UiId::None,     LV_ALIGN_TOP_RIGHT,  -10,  95,   0,   0,  0, UI_NO_COLOR, UI_NO_COLOR, Metric::CO,          "CO:  "},
+    {UiId::Aqi,         WidgetKind::Label, Tab::Air,     UiId::None,     LV_ALIGN_BOTTOM_MID,   0, -32,   0,   0,  0, UI_NO_COLOR, UI_NO_COLOR, Metric::Count,       "AQI: --"},
+    {UiId::AqiBar,      WidgetKind::Bar,   Tab::Air,     UiId::None,     LV_ALIGN_BOTTOM_MID,   0, -10, 260,  15,  0, UI_NO_COLOR, UI_NO_COLOR, Metric::Count,       nullptr},
+
+    {UiId::Temp,        WidgetKind::Label, Tab::Weather, UiId::None,     LV_ALIGN_CENTER,       0,   0,   0,   0, 48, UI_NO_COLOR, UI_NO_COLOR, Metric::Temperature, ""},
+    {UiId::Pressure,    WidgetKind::Label, Tab::Weather, UiId::None,     LV_ALIGN_BOTTOM_MID,   0, -30,   0,   0,  0, UI_NO_COLOR, UI_NO_COLOR, Metric::Pressure,    "Pressure: "},
+    {UiId::TempRange,   WidgetKind::Label, Tab::Weather, UiId::None,     LV_ALIGN_TOP_MID,      0,   5,   0,   0,  0, UI_GREY,     UI_NO_COLOR, Metric::Count,       "24h: -- .. -- C"},
+};
+
+// Rows in UiId order, parents declared before (and in the same tab as) children
+constexpr bool layoutValid(size_t i = 0) {
+    return i == UI_WIDGET_COUNT ||
+           (static_cast<size_t>(UI_LAYOUT[i].id) == i &&
+            (UI_LAYOUT[i].parent == UiId::None ||
+             (static_cast<size_t>(UI_LAYOUT[i].parent) < i &&
+              UI_LAYOUT[static_cast<size_t>(UI_LAYOUT[i].parent)].kind == WidgetKind::Panel &&
+              UI_LAYOUT[static_cast<size_t>(UI_LAYOUT[i].parent)].tab == UI_LAYOUT[i].tab)) &&
+            layoutValid(i + 1));
+}
+static_assert(layoutValid(), "UI_LAYOUT rows must follow UiId order, parents first");
+
+constexpr const WidgetSpec& widgetSpec(UiId id) { return UI_LAYOUT[static_cast<size_t>(id)]; }
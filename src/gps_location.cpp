@@ -0,0 +1,41 @@
+#include "gps_location.h"
+
+void GpsLocation::begin(HardwareSerial& port, int rxPin, int txPin, float fallbackLat, float fallbackLng) {
+    port_ = &port;
+    fallbackLat_ = fallbackLat;
+    fallbackLng_ = fallbackLng;
+    port.begin(GPS_BAUD, SERIAL_8N1, rxPin, txPin);
+    // Runs in the UART driver's event task whenever bytes arrive
+    port.onReceive([this]() { onReceive(); });
+}
+
+void GpsLocation::onReceive() {
+    while (port_->available() > 0) {
+        if (!gps_.encode(port_->read())) continue;
+        // A complete, checksummed sentence
+        if (!gps_.location.isUpdated() || !gps_.location.isValid()) continue;
+        float lat = gps_.location.lat();
+        float lng = gps_.location.lng();
+        uint8_t sats = gps_.satellites.isValid() ? gps_.satellites.value() : 0;
+        portENTER_CRITICAL(&mux_);
+        lat_ = lat;
+        lng_ = lng;
+        sats_ = sats;
+        fixAt_ = millis();
+        hasFix_ = true;
+        fixes_++;
+        portEXIT_CRITICAL(&mux_);
+    }
+}
+
+GpsFix GpsLocation::current() {
+    GpsFix fix;
+    portENTER_CRITICAL(&mux_);
+    bool fresh = hasFix_ && millis() - fixAt_ < GPS_FIX_MAX_AGE;
+    fix.lat = fresh ? lat_ : fallbackLat_;
+    fix.lng = fresh ? lng_ : fallbackLng_;
+    fix.satellites = fresh ? sats_ : 0;
+    fix.fromGps = fresh;
+    portEXIT_CRITICAL(&mux_);
+    return fix;
+}
@@ -0,0 +1,148 @@
+#include "gzip_stream.h"
+
+#include <string.h>
+
+// gzip header flags (RFC 1952)
+#define GZIP_FHCRC    0x02
+#define GZIP_FEXTRA   0x04
+#define GZIP_FNAME    0x08
+#define GZIP_FCOMMENT 0x10
+
+bool GzipStream::begin() {
+    end();
+    inflater_ = (tinfl_decompressor*)malloc(sizeof(tinfl_decompressor));
+    window_ = (uint8_t*)malloc(windowSize_);
+    if (!inflater_ || !window_) {
+        end();
+        state_ = State::Error;
+        return false;
+    }
+    tinfl_init(inflater_);
+    windowPos_ = outPos_ = outLen_ = 0;
+    inPos_ = inLen_ = 0;
+    bytesIn_ = bytesOut_ = 0;
+    needsInput_ = true;
+    state_ = readHeader() ? State::Body : State::Error;
+    return state_ == State::Body;
+}
+
+void GzipStream::end() {
+    free(inflater_);
+    free(window_);
+    inflater_ = nullptr;
+    window_ = nullptr;
+    outLen_ = 0;
+}
+
+// ==========================================
+// INPUT
+// ==========================================
+bool GzipStream::refill() {
+    // Take what has arrived; block (up to in's timeout) only for the next byte
+    int avail = in_.available();
+    size_t want = avail > 0 ? min((size_t)avail, sizeof(input_)) : 1;
+    inLen_ = in_.readBytes((char*)input_, want);
+    inPos_ = 0;
+    bytesIn_ += inLen_;
+    return inLen_ > 0;
+}
+
+int GzipStream::nextInput() {
+    if (inPos_ == inLen_ && !refill()) return -1;
+    return input_[inPos_++];
+}
+
+// Zero-terminated header field (file name, comment)
+bool GzipStream::skipString() {
+    int c;
+    while ((c = nextInput()) > 0) {}
+    return c == 0;
+}
+
+bool GzipStream::readHeader() {
+    uint8_t h[10];
+    for (uint8_t& b : h) {
+        int c = nextInput();
+        if (c < 0) return false;
+        b = c;
+    }
+    if (h[0] != 0x1F || h[1] != 0x8B || h[2] != 8) return false;   // magic, deflate
+    uint8_t flags = h[3];
+
+    if (flags & GZIP_FEXTRA) {
+        int lo = nextInput(), hi = nextInput();
+        if (lo < 0 || hi < 0) return false;
+        for (int n = lo | hi << 8; n > 0; n--) {
+            if (nextInput() < 0) return false;
+        }
+    }
+    if ((flags & GZIP_FNAME) && !skipString()) return false;
+    if ((flags & GZIP_FCOMMENT) && !skipString()) return false;
+    if (flags & GZIP_FHCRC) {
+        if (nextInput() < 0 || nextInput() < 0) return false;
+    }
+    return true;
+}
+
+// ==========================================
+// OUTPUT
+// ==========================================
+bool GzipStream::fill() {
+    // A short window is never wrapped: tinfl then also rejects any distance
+    // reaching before its start
+    bool bounded = windowSize_ < TINFL_LZ_DICT_SIZE;
+    while (outLen_ == 0 && state_ == State::Body) {
+        if (bounded && windowPos_ == windowSize_) {
+            state_ = State::Overflow;   // output larger than the window
+            break;
+        }
+        if (needsInput_ && inPos_ == inLen_ && !refill()) {
+            state_ = State::Error;      // source ended or timed out mid-stream
+            break;
+        }
+        size_t inBytes = inLen_ - inPos_;
+        size_t outBytes = windowSize_ - windowPos_;
+        tinfl_status status = tinfl_decompress(inflater_, input_ + inPos_, &inBytes,
+                                               window_, window_ + windowPos_, &outBytes,
+                                               TINFL_FLAG_HAS_MORE_INPUT |
+                                               (bounded ? TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF : 0));
+        inPos_ += inBytes;
+        outPos_ = windowPos_;
+        outLen_ = outBytes;
+        bytesOut_ += outBytes;
+        windowPos_ += outBytes;
+        if (!bounded) windowPos_ &= windowSize_ - 1;
+
+        needsInput_ = status == TINFL_STATUS_NEEDS_MORE_INPUT;
+        if (status == TINFL_STATUS_DONE) state_ = State::Done;
+        else if (status < 0) state_ = State::Error;
+    }
+    return outLen_ > 0;
+}
+
+int GzipStream::available() {
+    return outLen_;
+}
+
+int GzipStream::read() {
+    if (outLen_ == 0 && !fill()) return -1;
+    outLen_--;
+    return window_[outPos_++];
+}
+
+int GzipStream::peek() {
+    if (outLen_ == 0 && !fill()) return -1;
+    return window_[outPos_];
+}
+
+size_t GzipStream::readBytes(char* buffer, size_t length) {
+    size_t n = 0;
+    while (n < length && (outLen_ > 0 || fill())) {
+        size_t take = min(outLen_, length - n);
+        memcpy(buffer + n, window_ + outPos_, take);
+        outPos_ += take;
+        outLen_ -= take;
+        n += take;
+    }
+    return n;
+}
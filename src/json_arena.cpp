@@ -0,0 +1,49 @@
+#include "json_arena.h"
+
+#include <string.h>
+
+void* JsonArena::allocate(size_t size) {
+    size_t n = align(size);
+    if (top_ + HEADER + n > size_) {
+        overflows_++;
+        return nullptr;
+    }
+    void* ptr = buf_ + top_ + HEADER;
+    blockSize(ptr) = n;
+    top_ += HEADER + n;
+    if (top_ > highWater_) highWater_ = top_;
+    last_ = ptr;
+    return ptr;
+}
+
+void JsonArena::deallocate(void* ptr) {
+    // Only the top block can be given back; the rest waits for reset()
+    if (ptr && ptr == last_) {
+        top_ = (uint8_t*)ptr - HEADER - buf_;
+        last_ = nullptr;
+    }
+}
+
+void* JsonArena::reallocate(void* ptr, size_t newSize) {
+    if (!ptr) return allocate(newSize);
+    size_t n = align(newSize);
+    size_t old = blockSize(ptr);
+
+    if (ptr == last_) {
+        // Top block: grow or shrink in place
+        size_t start = (uint8_t*)ptr - buf_;
+        if (start + n > size_) {
+            overflows_++;
+            return nullptr;
+        }
+        blockSize(ptr) = n;
+        top_ = start + n;
+        if (top_ > highWater_) highWater_ = top_;
+        return ptr;
+    }
+    if (n <= old) return ptr;
+
+    void* moved = allocate(newSize);
+    if (moved) memcpy(moved, ptr, old);
+    return moved;
+}
@@ -0,0 +1,62 @@
+#include "last_readings.h"
+
+#include <Preferences.h>
+#include <string.h>
+
+#define LAST_READINGS_NVS_NAMESPACE "last"
+#define LAST_READINGS_NVS_KEY       "readings"
+#define LAST_READINGS_MAGIC         0x4C415354u     // "LAST"
+
+namespace {
+
+// Not cleared by the startup code, so it is garbage after power-on: the
+// magic and checksum tell a valid copy apart
+struct RtcCopy {
+    uint32_t magic;
+    LastReadings data;
+    uint32_t checksum;
+};
+RTC_NOINIT_ATTR RtcCopy rtcCopy;
+
+uint32_t checksum(const LastReadings& r) {
+    // FNV-1a
+    const uint8_t* p = (const uint8_t*)&r;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < sizeof(r); i++) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+} // namespace
+
+void LastReadingsStore::save(const float* values, uint32_t timestamp) {
+    LastReadings r;
+    r.timestamp = timestamp;
+    memcpy(r.value, values, sizeof(r.value));
+
+    rtcCopy.data = r;
+    rtcCopy.checksum = checksum(r);
+    rtcCopy.magic = LAST_READINGS_MAGIC;
+
+    if (nvsWritten_ && millis() - lastNvsWrite_ < LAST_READINGS_NVS_INTERVAL) return;
+    Preferences prefs;
+    prefs.begin(LAST_READINGS_NVS_NAMESPACE, false);
+    prefs.putBytes(LAST_READINGS_NVS_KEY, &r, sizeof(r));
+    prefs.end();
+    lastNvsWrite_ = millis();
+    nvsWritten_ = true;
+}
+
+bool LastReadingsStore::load(LastReadings& out) {
+    bool haveRtc = rtcCopy.magic == LAST_READINGS_MAGIC && rtcCopy.checksum == checksum(rtcCopy.data);
+
+    LastReadings nvs;
+    Preferences prefs;
+    prefs.begin(LAST_READINGS_NVS_NAMESPACE, true);
+    bool haveNvs = prefs.getBytes(LAST_READINGS_NVS_KEY, &nvs, sizeof(nvs)) == sizeof(nvs);
+    prefs.end();
+
+    if (haveRtc && (!haveNvs || rtcCopy.data.timestamp >= nvs.timestamp)) out = rtcCopy.data;
+    else if (haveNvs) out = nvs;
+    else return false;
+    return true;
+}
@@ -0,0 +1,256 @@
+#include "lean_tls.h"
+
+#include <esp_system.h>
+#include <fcntl.h>
+#include <string.h>
+#include "mbedtls/x509_crt.h"
+
+// ==========================================
+// SHARED STATE
+// ==========================================
+struct LeanTlsClient::Session {
+    char host[48];
+    bool valid;
+    uint32_t lastUsed;
+    mbedtls_ssl_session data;
+};
+
+namespace {
+
+bool sharedReady = false;
+mbedtls_ssl_config sharedConf;
+mbedtls_x509_crt sharedCa;
+LeanTlsClient::Session sessions[TLS_SESSION_CACHE];
+TlsStats tlsStats = {0, 0, 0, 0, false, 0, 0, UINT32_MAX, UINT32_MAX};
+
+// Hardware RNG (true random while the radio is on): no CTR-DRBG/entropy contexts needed
+int hwRandom(void*, unsigned char* out, size_t len) {
+    esp_fill_random(out, len);
+    return 0;
+}
+
+} // namespace
+
+bool LeanTlsClient::initShared(const char* rootCaPem, bool allowUnverified) {
+    if (sharedReady) return true;
+    bool haveCa = rootCaPem && *rootCaPem;
+    if (!haveCa && !allowUnverified) {
+        Serial.println("[TLS] No root CA: HTTPS disabled");
+        return false;
+    }
+
+    mbedtls_ssl_config_init(&sharedConf);
+    mbedtls_x509_crt_init(&sharedCa);
+    if (mbedtls_ssl_config_defaults(&sharedConf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                    MBEDTLS_SSL_PRESET_DEFAULT) != 0) {
+        mbedtls_ssl_config_free(&sharedConf);
+        return false;
+    }
+    mbedtls_ssl_conf_rng(&sharedConf, hwRandom, nullptr);
+
+    if (haveCa) {
+        // A CA that was meant to be used but does not parse never falls back to unverified
+        int ret = mbedtls_x509_crt_parse(&sharedCa, (const unsigned char*)rootCaPem, strlen(rootCaPem) + 1);
+        if (ret != 0) {
+            Serial.printf("[TLS] Root CA does not parse (%d): HTTPS disabled\n", ret);
+            mbedtls_x509_crt_free(&sharedCa);
+            mbedtls_ssl_config_free(&sharedConf);
+            return false;
+        }
+        mbedtls_ssl_conf_ca_chain(&sharedConf, &sharedCa, nullptr);
+        mbedtls_ssl_conf_authmode(&sharedConf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    } else {
+        Serial.println("[TLS] No root CA: server certificates are NOT verified");
+        mbedtls_ssl_conf_authmode(&sharedConf, MBEDTLS_SSL_VERIFY_NONE);
+    }
+
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH) && LEAN_TLS_MAX_FRAG
+    mbedtls_ssl_conf_max_frag_len(&sharedConf, MBEDTLS_SSL_MAX_FRAG_LEN_2048);
+#endif
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_conf_session_tickets(&sharedConf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+
+    for (Session& s : sessions) {
+        s.valid = false;
+        s.host[0] = '\0';
+        mbedtls_ssl_session_init(&s.data);
+    }
+    sharedReady = true;
+    return true;
+}
+
+const TlsStats& LeanTlsClient::stats() { return tlsStats; }
+
+// ==========================================
+// CONNECTION
+// ==========================================
+int LeanTlsClient::connect(IPAddress ip, uint16_t port) {
+    return connect(ip.toString().c_str(), port, TLS_HANDSHAKE_TIMEOUT_MS);
+}
+
+int LeanTlsClient::connect(IPAddress ip, uint16_t port, int32_t timeout) {
+    return connect(ip.toString().c_str(), port, timeout);
+}
+
+int LeanTlsClient::connect(const char* host, uint16_t port) {
+    return connect(host, port, TLS_HANDSHAKE_TIMEOUT_MS);
+}
+
+int LeanTlsClient::connect(const char* host, uint16_t port, int32_t timeout) {
+    if (!sharedReady) return 0;     // initShared() failed or never ran: no connection
+    stop();
+    tlsStats.heapBefore = ESP.getFreeHeap();
+    tlsStats.lastHeapLowest = tlsStats.heapBefore;
+
+    if (!WiFiClient::connect(host, port, timeout)) return 0;
+    // Non-blocking socket: the handshake and writes below carry their own timeouts
+    fcntl(fd(), F_SETFL, fcntl(fd(), F_GETFL, 0) | O_NONBLOCK);
+
+    uint32_t start = millis();
+    if (!handshake(host, timeout > 0 ? timeout : TLS_HANDSHAKE_TIMEOUT_MS)) {
+        tlsStats.failures++;
+        stop();
+        return 0;
+    }
+    tlsStats.handshakes++;
+    tlsStats.lastHandshakeMs = millis() - start;
+    trackHeap();
+    return 1;
+}
+
+bool LeanTlsClient::handshake(const char* host, uint32_t timeoutMs) {
+    mbedtls_ssl_context* ssl = (mbedtls_ssl_context*)malloc(sizeof(mbedtls_ssl_context));
+    if (!ssl) return false;
+    mbedtls_ssl_init(ssl);
+    ssl_ = ssl;     // freed by stop()
+    if (mbedtls_ssl_setup(ssl, &sharedConf) != 0) return false;
+    mbedtls_ssl_set_hostname(ssl, host);
+
+    // Reuse this host's session slot, or take the least recently used one
+    session_ = nullptr;
+    for (Session& s : sessions) {
+        if (strncmp(s.host, host, sizeof(s.host)) == 0) { session_ = &s; break; }
+    }
+    if (!session_) {
+        session_ = &sessions[0];
+        for (Session& s : sessions) if (s.lastUsed < session_->lastUsed) session_ = &s;
+        mbedtls_ssl_session_free(&session_->data);
+        mbedtls_ssl_session_init(&session_->data);
+        session_->valid = false;
+        strncpy(session_->host, host, sizeof(session_->host) - 1);
+        session_->host[sizeof(session_->host) - 1] = '\0';
+    }
+    session_->lastUsed = millis();
+    // A resumed session keeps its master secret, a full handshake makes a new one
+    unsigned char offered[sizeof(session_->data.master)];
+    bool offering = session_->valid && mbedtls_ssl_set_session(ssl, &session_->data) == 0;
+    if (offering) {
+        tlsStats.resumedOffers++;
+        memcpy(offered, session_->data.master, sizeof(offered));
+    }
+
+    net_.fd = fd();
+    mbedtls_ssl_set_bio(ssl, &net_, mbedtls_net_send, mbedtls_net_recv, nullptr);
+
+    uint32_t start = millis();
+    int ret;
+    while ((ret = mbedtls_ssl_handshake(ssl)) != 0) {
+        if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+            session_->valid = false;    // stale ticket or server rejected it
+            return false;
+        }
+        if (millis() - start > timeoutMs) return false;
+        trackHeap();
+        delay(2);
+    }
+
+    // Remember the (possibly renewed) session for the next connect
+    mbedtls_ssl_session_free(&session_->data);
+    mbedtls_ssl_session_init(&session_->data);
+    session_->valid = mbedtls_ssl_get_session(ssl, &session_->data) == 0;
+    tlsStats.lastResumed = offering && session_->valid &&
+                           memcmp(offered, session_->data.master, sizeof(offered)) == 0;
+    if (tlsStats.lastResumed) tlsStats.resumed++;
+    return true;
+}
+
+void LeanTlsClient::stop() {
+    if (ssl_) {
+        trackHeap();
+        mbedtls_ssl_close_notify(ssl_);
+        mbedtls_ssl_free(ssl_);
+        free(ssl_);
+        ssl_ = nullptr;
+    }
+    peeked_ = -1;
+    WiFiClient::stop();
+}
+
+uint8_t LeanTlsClient::connected() {
+    return ssl_ && (peeked_ >= 0 || mbedtls_ssl_get_bytes_avail(ssl_) > 0 || WiFiClient::connected());
+}
+
+void LeanTlsClient::trackHeap() {
+    uint32_t heap = ESP.getFreeHeap();
+    if (heap < tlsStats.heapLowest) tlsStats.heapLowest = heap;
+    if (heap < tlsStats.lastHeapLowest) tlsStats.lastHeapLowest = heap;
+}
+
+// ==========================================
+// I/O
+// ==========================================
+size_t LeanTlsClient::write(const uint8_t* buf, size_t size) {
+    if (!ssl_) return 0;
+    size_t sent = 0;
+    uint32_t start = millis();
+    while (sent < size) {
+        int ret = mbedtls_ssl_write(ssl_, buf + sent, size - sent);
+        if (ret > 0) {
+            sent += ret;
+            start = millis();
+        } else if (ret == MBEDTLS_ERR_SSL_WANT_WRITE || ret == MBEDTLS_ERR_SSL_WANT_READ) {
+            if (millis() - start > TLS_HANDSHAKE_TIMEOUT_MS) break;
+            delay(1);
+        } else {
+            break;
+        }
+    }
+    return sent;
+}
+
+int LeanTlsClient::available() {
+    if (!ssl_) return 0;
+    // Zero-length read pulls in a pending record without consuming data
+    mbedtls_ssl_read(ssl_, nullptr, 0);
+    return mbedtls_ssl_get_bytes_avail(ssl_) + (peeked_ >= 0 ? 1 : 0);
+}
+
+int LeanTlsClient::read(uint8_t* buf, size_t size) {
+    if (!ssl_ || !size) return -1;
+    size_t n = 0;
+    if (peeked_ >= 0) {
+        buf[n++] = (uint8_t)peeked_;
+        peeked_ = -1;
+    }
+    if (n < size) {
+        int ret = mbedtls_ssl_read(ssl_, buf + n, size - n);
+        if (ret > 0) n += ret;
+        else if (n == 0) return -1;
+    }
+    return n;
+}
+
+int LeanTlsClient::read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int LeanTlsClient::peek() {
+    if (peeked_ < 0) {
+        uint8_t b;
+        if (!ssl_ || mbedtls_ssl_read(ssl_, &b, 1) != 1) return -1;
+        peeked_ = b;
+    }
+    return peeked_;
+}
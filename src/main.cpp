@@ -8,8 +8,27 @@
 #include <ArduinoJson.h>
 #include <time.h>              
 #include <esp_task_wdt.h>      
+#include <esp_sntp.h>
 #include "soc/soc.h"
 #include "soc/rtc_cntl_reg.h"
+#include "aqi.h"
+#include "metrics.h"
+#include "rolling_stats.h"
+#include "record_codec.h"
+#include "metrics_server.h"
+#include "mqtt_uplink.h"
+#include "counting_client.h"
+#include "lean_tls.h"
+#include "gps_location.h"
+#include "json_arena.h"
+#include "response_stream.h"
+#include "gzip_stream.h"
+#include "open_meteo_fb.h"
+#include "ota_update.h"
+#include "boot_profile.h"
+#include "last_readings.h"
+#include "ui_layout.h"
+#include "sync_profile.h"
 
 // ==========================================
 // 1. CONFIGURATION
@@ -18,13 +37,113 @@ const char* ssid     = "*********";
 const char* password = "*********"; 
 String thingSpeakApiKey = "******"; 
 
-// Location: GDANSK
+// HTTPS for Open-Meteo and ThingSpeak via the lean TLS client (lean_tls.h).
+// Paste the PEM root CA chain to verify servers. Without a CA (or with one
+// that does not parse) no HTTPS request is made, unless TLS_ALLOW_UNVERIFIED
+// accepts encrypted but unverified connections.
+#define USE_TLS 0
+#define TLS_ALLOW_UNVERIFIED 0
+const char* tlsRootCa = "";
+
+// Uplink backend: ThingSpeak HTTP GET per sample, or one persistent MQTT session
+#define UPLINK_THINGSPEAK 0
+#define UPLINK_MQTT       1
+#define UPLINK_BACKEND    UPLINK_THINGSPEAK
+
+const char* mqttHost     = "192.168.1.10";
+const uint16_t mqttPort  = 1883;
+const char* mqttClientId = "cyd-station-gdansk";   // must stay stable for session resumption
+const char* mqttUser     = nullptr;
+const char* mqttPassword = nullptr;
+const char* mqttTopic    = "station/gdansk/readings";
+
+// Soak test: sync back-to-back against tools/api_standin.py --faults (slow,
+// truncated, malformed, 5xx and reset responses) at SOAK_STANDIN_HOST, never
+// the production APIs, and print a report with the worst cycle, watchdog
+// margin and heap fragmentation every SOAK_REPORT_CYCLES. The same faults
+// run for weeks of cycles on the host: tools/host soak. Defined ahead of the
+// API hosts, which it redirects.
+#define SOAK_TEST 0
+#define SOAK_STANDIN_HOST  "192.168.1.10:8080"
+#define SOAK_INTERVAL_MS   2000
+#define SOAK_REPORT_CYCLES 50
+
+// API hosts. For measurements on the LAN point them at tools/api_standin.py,
+// e.g. "192.168.1.10:8080"; it answers all three. With USE_TLS run it with
+// --tls and paste its certificate as tlsRootCa.
+#if SOAK_TEST
+const char* weatherApiHost = SOAK_STANDIN_HOST;
+const char* airApiHost     = SOAK_STANDIN_HOST;
+const char* thingSpeakHost = SOAK_STANDIN_HOST;
+#else
+const char* weatherApiHost = "api.open-meteo.com";
+const char* airApiHost     = "air-quality-api.open-meteo.com";
+const char* thingSpeakHost = "api.thingspeak.com";
+#endif
+
+// Ask for gzip bodies and inflate them on the fly into the parser: fewer
+// bytes on air for ~15 KB heap during a fetch (GZIP_JSON_WINDOW plus the
+// inflater). A response inflating to more than the window is fetched again
+// uncompressed, and gzip is not asked for again until reboot.
+#define GZIP_RESPONSES 1
+#define GZIP_JSON_WINDOW 4096
+
+// Request Open-Meteo's binary FlatBuffers format instead of JSON: the values
+// are read in place from the received bytes (open_meteo_fb.h) with no text
+// parsing or document tree. A request that fails is retried as JSON; after
+// FLATBUFFER_MAX_FAILURES such fallbacks in a row JSON is used until reboot.
+#define FLATBUFFER_RESPONSES 0
+#define FLATBUFFER_MAX_FAILURES 3
+
+// Location: GDANSK (fallback while the GPS has no fix)
 float fixedLat = 54.3520; 
 float fixedLng = 18.6466; 
 
+// Air Quality Index scale: aqi::Scale::European or aqi::Scale::UsEpa
+const aqi::Scale aqiScale = aqi::Scale::European;
+
+// Upload 24h statistics to ThingSpeak fields 5-7 (temp mean, PM2.5 mean, PM2.5 max)
+#define UPLOAD_STATS 0
+
+// Print LVGL refresh times (avg/max per 5 s) over Serial, e.g. to compare
+// LV_DRAW_SW_DRAW_UNIT_CNT=1 vs 2 during a tab swipe
+#define LOG_FRAME_TIME 0
+
+// Print a per-cycle sync report over Serial (duration, requests, bytes, heap),
+// the on-device counterpart of tools/host's sync_bench
+#define LOG_SYNC_CYCLE 0
+
+// Time every sync phase (DNS, connect, TTFB, download, parse, UI, upload)
+// into latency histograms; p50/p95/p99 go to Serial every
+// SYNC_PROFILE_REPORT_CYCLES and the SYSTEM tab. 0 compiles it all out.
+#define SYNC_PROFILE 0
+#define SYNC_PROFILE_REPORT_CYCLES 10
+
+// Build tab contents when a tab is first shown, and free them again after
+// TAB_TEARDOWN_MS hidden (0 = keep). LAZY_TABS 0 builds everything at boot
+// (tools/host builds both for tab_bench).
+#ifndef LAZY_TABS
+#define LAZY_TABS 1
+#endif
+#define TAB_TEARDOWN_MS 60000
+#define LOG_TAB_BUILD 0     // build time and LVGL pool use per tab over Serial
+
+// Local scrape endpoint on port 80: /metrics (Prometheus) and /readings
+#define HTTP_SERVER_ENABLED 1
+
+// Firmware updates over HTTP (ota_update.h, tools/make_ota.py). Bump
+// FIRMWARE_VERSION for every image published to the manifest.
+#define OTA_ENABLED 0
+#define FIRMWARE_VERSION 1
+const char* otaManifestUrl = "http://192.168.1.10/station/manifest.txt";
+
 // Watchdog Timeout (seconds)
 #define WDT_TIMEOUT 30
 
+// Per-request connect/read timeout. The watchdog is fed after every request,
+// so one request (DNS + connect + read) must stay well below WDT_TIMEOUT.
+#define HTTP_TIMEOUT_MS 8000
+
 // ==========================================
 // 2. HARDWARE
 // ==========================================
@@ -35,10 +154,13 @@ float fixedLng = 18.6466;
 #define CYD_LED_RED   4
 #define CYD_LED_GREEN 16
 #define CYD_LED_BLUE  17
+#define GPS_RX_PIN    27   // NEO-6M TX -> ESP32 (CN1 connector)
+#define GPS_TX_PIN    22
 
 XPT2046_Touchscreen touchscreen(XPT_CS); 
 SPIClass touchSPI(HSPI);
 TFT_eSPI tft = TFT_eSPI();
+GpsLocation gps;
 
 // ==========================================
 // 3. UI VARIABLES
@@ -47,30 +169,77 @@ TFT_eSPI tft = TFT_eSPI();
 #define SCREEN_HEIGHT 240
 uint32_t draw_buf[SCREEN_WIDTH * SCREEN_HEIGHT / 10];
 
-lv_obj_t * lbl_clock;       
-lv_obj_t * lbl_status_header;
-lv_obj_t * lbl_lat_val;
-lv_obj_t * lbl_lng_val;
-lv_obj_t * lbl_info_mode;
-
-lv_obj_t * lbl_temp_big;
-lv_obj_t * lbl_press_val;
+// Widgets by UiId (layout in ui_layout.h), value labels by Metric
+// (nullptr while the widget's tab is not built)
+lv_obj_t * uiObj[UI_WIDGET_COUNT];
+lv_obj_t * tabView;
+lv_obj_t * tabPage[TAB_COUNT];
+bool tabBuilt[TAB_COUNT];
+uint32_t tabHiddenAt[TAB_COUNT];
+lv_obj_t * metricLabel[METRIC_COUNT];
+const char * metricPrefix[METRIC_COUNT];
 
-lv_obj_t * lbl_pm25;
-lv_obj_t * lbl_pm10;
-lv_obj_t * lbl_no2;
-lv_obj_t * lbl_so2;
-lv_obj_t * lbl_o3;
-lv_obj_t * lbl_co;
-lv_obj_t * bar_summary;
+// Status header text survives the SYSTEM tab being torn down
+char statusText[48] = "WiFi: ... | Gdansk";
+bool statusStale = false;
+uint32_t shownSince = 0;    // unix time of the readings on screen, 0 = none
 
-// Reference to Air Tab for background color changes
-lv_obj_t * tab_air; 
+inline lv_obj_t * widget(UiId id) { return uiObj[static_cast<size_t>(id)]; }
+inline bool isBuilt(Tab t) { return tabBuilt[static_cast<size_t>(t)]; }
 
 float valTemp = 0.0;
 int valPM25 = 0;
+aqi::Result valAqi = {0, 0, aqi::Pollutant::None};
+
+// Latest reading and rolling statistics per metric (NAN = no data yet)
+float metricValue[METRIC_COUNT] = {NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN};
+StatsTable stats;
+
+// All JSON parsing happens in this arena, reset before every response
+alignas(8) uint8_t jsonArenaBuf[JSON_ARENA_SIZE];
+JsonArena jsonArena(jsonArenaBuf, sizeof(jsonArenaBuf));
+
+// Boot milestones, and the last sync kept across resets for the first screen
+BootProfile boot;
+LastReadingsStore lastReadings;
+
+// Recent readings, delta/varint encoded (~11 bytes per sync, see record_codec.h)
+ReadingLog history;
+SyncStats syncStats = {};
+
+// Position: latest fix, the Open-Meteo grid cell being shown, and recent
+// readings per cell so revisiting a cell needs no API call
+GpsFix currentFix = {fixedLat, fixedLng, false, 0};
+GridCell activeCell = {0, 0};
+bool haveActiveCell = false;
+bool syncRequested = false;
+CellCache cellCache;
+
+#if UPLINK_BACKEND == UPLINK_MQTT
+MqttUplink mqttUplink;
+#endif
+
+// Socket for API and upload requests, one request at a time
+#if USE_TLS
+CountingClient<LeanTlsClient> netClient;
+#else
+CountingClient<WiFiClient> netClient;
+#endif
+
+#if SYNC_PROFILE
+SyncProfile syncProfile;
+#endif
+
+#if HTTP_SERVER_ENABLED
+MetricsServer metricsServer(80);
+#endif
+
+#if OTA_ENABLED
+OtaUpdater otaUpdater;
+#endif
 unsigned long lastUpdateTimestamp = 0;
-unsigned long updateInterval = 60000; 
+unsigned long updateInterval = SOAK_TEST ? SOAK_INTERVAL_MS : 60000; 
+bool cyclicFromCache = !SOAK_TEST;      // soaks exercise the request path every cycle
 
 // ==========================================
 // 4. HELPER FUNCTIONS
@@ -96,6 +265,36 @@ void my_touchpad_read(lv_indev_t * indev, lv_indev_data_t * data) {
     }
 }
 
+// LVGL runs with the FreeRTOS OS layer and parallel draw threads
+// (see platformio.ini), so every widget access outside lv_timer_handler()
+// must hold the LVGL lock. Scoped: { LvglLock lock; ... }
+struct LvglLock {
+    LvglLock()  { lv_lock(); }
+    ~LvglLock() { lv_unlock(); }
+    LvglLock(const LvglLock&) = delete;
+    LvglLock& operator=(const LvglLock&) = delete;
+};
+
+#if LOG_FRAME_TIME
+void frame_time_cb(lv_event_t * e) {
+    static uint32_t frameStart = 0, frames = 0, totalUs = 0, maxUs = 0, lastReport = 0;
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        frameStart = micros();
+        return;
+    }
+    uint32_t us = micros() - frameStart;
+    frames++; totalUs += us;
+    if (us > maxUs) maxUs = us;
+    if (millis() - lastReport > 5000) {
+        Serial.printf("[LVGL] %u frames, avg %u us, max %u us, draw units: %d\n",
+                      (unsigned)frames, (unsigned)(frames ? totalUs / frames : 0), (unsigned)maxUs,
+                      LV_DRAW_SW_DRAW_UNIT_CNT);
+        frames = totalUs = maxUs = 0;
+        lastReport = millis();
+    }
+}
+#endif
+
 void my_disp_flush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
     uint32_t w = area->x2 - area->x1 + 1;
     uint32_t h = area->y2 - area->y1 + 1;
@@ -103,6 +302,7 @@ void my_disp_flush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
     tft.setAddrWindow(area->x1, area->y1, w, h);
     tft.pushColors((uint16_t*)px_map, w*h, true);
     tft.endWrite();
+    if (lv_display_flush_is_last(disp)) boot.mark(BootPhase::FirstFrame);
     lv_display_flush_ready(disp);
 }
 
@@ -111,6 +311,270 @@ void initTime() {
     configTime(3600, 3600, "pool.ntp.org", "time.nist.gov"); // GMT+1 + DST
 }
 
+// metricValue and stats are read by the tab builders, under the LVGL lock
+void recordMetric(Reading& reading, Metric m, float v) {
+    LvglLock lock;
+    reading.value[metricIndex(m)] = v;
+    metricValue[metricIndex(m)] = v;
+    stats[metricIndex(m)].add(v, millis() / 1000);
+}
+
+// Uplink values follow metricValue, whether fetched or taken from the cell cache
+void setUploadValues() {
+    float pm25 = metricValue[metricIndex(Metric::PM25)];
+    valTemp = metricValue[metricIndex(Metric::Temperature)];
+    valPM25 = isnan(pm25) ? 0 : (int)pm25;
+}
+
+// url without scheme, e.g. "api.open-meteo.com/v1/forecast?..."
+bool beginRequest(HTTPClient& http, const String& url) {
+    syncStats.requests++;
+    http.setConnectTimeout(HTTP_TIMEOUT_MS);
+    http.setTimeout(HTTP_TIMEOUT_MS);
+    http.setReuse(false);   // TLS buffers are released as soon as the request ends
+#if USE_TLS
+    return http.begin(netClient, "https://" + url);
+#else
+    return http.begin(netClient, "http://" + url);
+#endif
+}
+
+// Feeds the task watchdog and keeps the longest gap between feeds, i.e. how
+// close the loop came to a WDT_TIMEOUT reset
+void feedWatchdog() {
+    static uint32_t lastFeed = millis();
+    uint32_t gap = millis() - lastFeed;
+    if (gap > syncStats.maxWdtGapMs) syncStats.maxWdtGapMs = gap;
+    lastFeed = millis();
+    esp_task_wdt_reset();
+}
+
+// Sends an API GET (url without scheme) and returns the status code. On
+// anything but 200 the request is already closed and counted as failed.
+int apiGet(HTTPClient& http, const String& url, bool acceptGzip) {
+    beginRequest(http, url);
+    http.useHTTP10(true);   // no chunked encoding: the body can be read as-is
+#if GZIP_RESPONSES
+    // HTTP/1.0 keeps HTTPClient's own "Accept-Encoding: identity" out of the request
+    static const char * encodingHeader[] = {"Content-Encoding"};
+    if (acceptGzip) http.addHeader("Accept-Encoding", "gzip");
+    http.collectHeaders(encodingHeader, 1);
+#else
+    (void)acceptGzip;
+#endif
+#if SYNC_PROFILE
+    // Resolve and connect ahead of GET() to time them apart; HTTPClient then
+    // reuses the open socket (and the lookup is cached by lwIP)
+    PhaseClock clock;
+    String host = url.substring(0, url.indexOf('/'));
+    uint16_t port = USE_TLS ? 443 : 80;
+    int colon = host.indexOf(':');
+    if (colon >= 0) {
+        port = host.substring(colon + 1).toInt();
+        host.remove(colon);
+    }
+    IPAddress ip;
+    WiFi.hostByName(host.c_str(), ip);
+    syncProfile.add(SyncPhase::Dns, clock.lap());
+    netClient.connect(host.c_str(), port, HTTP_TIMEOUT_MS);
+    syncProfile.add(SyncPhase::Connect, clock.lap());
+#endif
+    int code = http.GET();
+#if SYNC_PROFILE
+    syncProfile.add(SyncPhase::Ttfb, clock.lap());
+#endif
+    if (code != 200) {
+        http.end();
+        feedWatchdog();
+        syncStats.failedRequests++;
+    }
+    return code;
+}
+
+// GET an API url and parse the JSON body into doc (which must use jsonArena)
+// straight from the socket. Failed requests and bodies that do not parse
+// (truncated, malformed, no "current", arena too small) return false.
+bool fetchJson(HTTPClient& http, const String& url, JsonDocument& doc) {
+    static bool gzipWindowExceeded = false;
+    bool windowOverflow = false;
+    doc.clear();
+    jsonArena.reset();
+    uint32_t fetchStart = millis();
+    if (apiGet(http, url, !gzipWindowExceeded) != 200) return false;
+#if SYNC_PROFILE
+    PhaseClock clock;
+#endif
+
+    ResponseStream body(http.getStream(), HTTP_TIMEOUT_MS);
+    // Only "current" is kept; units and metadata are skipped without allocating
+    JsonDocument filter(&jsonArena);
+    filter["current"] = true;
+    DeserializationError err;
+#if GZIP_RESPONSES
+    if (http.header("Content-Encoding").equalsIgnoreCase("gzip")) {
+        // Inflated in GZIP_JSON_WINDOW steps straight into the parser
+        GzipStream inflated(body, GZIP_JSON_WINDOW);
+        uint32_t heapBefore = ESP.getFreeHeap();
+        bool started = inflated.begin();
+        uint32_t heapUsed = heapBefore - ESP.getFreeHeap();
+        if (heapUsed > syncStats.gzipHeapBytes) syncStats.gzipHeapBytes = heapUsed;
+        err = started ? deserializeJson(doc, inflated, DeserializationOption::Filter(filter))
+                      : DeserializationError(DeserializationError::InvalidInput);
+        windowOverflow = inflated.overflowed();
+        syncStats.gzipResponses++;
+        syncStats.decodedBytes += inflated.bytesOut();
+    } else
+#endif
+    {
+        err = deserializeJson(doc, body, DeserializationOption::Filter(filter));
+        syncStats.decodedBytes += body.bytes();
+    }
+#if SYNC_PROFILE
+    uint32_t bodyUs = clock.lap();
+    uint32_t readUs = body.readMicros() < bodyUs ? body.readMicros() : bodyUs;
+    syncProfile.add(SyncPhase::Download, readUs);
+    syncProfile.add(SyncPhase::Parse, bodyUs - readUs);
+#endif
+    http.end();
+    feedWatchdog();
+
+    syncStats.transferMs += millis() - fetchStart;
+    syncStats.downloadBytes += body.bytes();
+    syncStats.jsonArenaHighWater = jsonArena.highWater();
+    syncStats.jsonArenaOverflows = jsonArena.overflows();
+    if (windowOverflow) {
+        Serial.printf("[SYNC] gzip body exceeds the %u B window, fetching uncompressed\n",
+                      (unsigned)GZIP_JSON_WINDOW);
+        syncStats.gzipFallbacks++;
+        gzipWindowExceeded = true;
+        filter.clear();     // out of the arena before the retry rewinds it
+        return fetchJson(http, url, doc);
+    }
+    if (err || !doc["current"].is<JsonObject>()) {
+        syncStats.parseErrors++;
+        return false;
+    }
+    return true;
+}
+
+
+#if FLATBUFFER_RESPONSES
+// GET an API url as &format=flatbuffers and copy the n "current" values, in
+// request order, into out. The body is received into jsonArena (no
+// JsonDocument may hold data in it) and read in place. Failed requests and
+// bodies that do not decode to exactly n variables return false.
+bool fetchFlatBuffer(HTTPClient& http, const String& url, float* out, size_t n) {
+    jsonArena.reset();
+    uint32_t fetchStart = millis();
+    if (apiGet(http, url + "&format=flatbuffers", false) != 200) return false;
+#if SYNC_PROFILE
+    PhaseClock clock;
+#endif
+
+    ResponseStream body(http.getStream(), HTTP_TIMEOUT_MS);
+    // Read whole (a few hundred bytes); without a Content-Length JSON is used
+    int size = http.getSize();
+    uint8_t * buf = size > 0 ? (uint8_t *)jsonArena.allocate(size) : nullptr;
+    size_t len = buf ? body.readBytes((char *)buf, size) : 0;
+#if SYNC_PROFILE
+    syncProfile.add(SyncPhase::Download, clock.lap());
+#endif
+    http.end();
+    feedWatchdog();
+
+    omfb::VariablesWithTime current = omfb::Response(buf, len).current();
+    bool ok = buf && len == (size_t)size && current.count() == n;
+    for (size_t i = 0; i < n; i++) out[i] = ok ? current.variable(i).value() : NAN;
+#if SYNC_PROFILE
+    syncProfile.add(SyncPhase::Parse, clock.lap());
+#endif
+
+    syncStats.transferMs += millis() - fetchStart;
+    syncStats.downloadBytes += body.bytes();
+    syncStats.decodedBytes += body.bytes();
+    syncStats.jsonArenaHighWater = jsonArena.highWater();
+    syncStats.jsonArenaOverflows = jsonArena.overflows();
+    jsonArena.reset();
+    if (!ok) {
+        syncStats.parseErrors++;
+        return false;
+    }
+    syncStats.flatBufferResponses++;
+    return true;
+}
+#endif
+
+// Fetch the "current" values of vars (appended to url as &current=, in this
+// order) into out, NAN where missing. With FLATBUFFER_RESPONSES the binary
+// format is tried first and JSON fetched only when that fails. Once
+// FlatBuffers failed FLATBUFFER_MAX_FAILURES times in a row while JSON
+// worked, the server is taken not to support it and only JSON is used.
+bool fetchCurrent(HTTPClient& http, String url, const char * const * vars, size_t n,
+                  JsonDocument& doc, float* out) {
+    url += "&current=";
+    for (size_t i = 0; i < n; i++) {
+        if (i) url += ',';
+        url += vars[i];
+    }
+    doc.clear();
+#if FLATBUFFER_RESPONSES
+    static uint8_t flatFailures = 0;
+    bool flatFailed = false;
+    if (flatFailures < FLATBUFFER_MAX_FAILURES) {
+        if (fetchFlatBuffer(http, url, out, n)) {
+            flatFailures = 0;
+            return true;
+        }
+        syncStats.flatBufferFallbacks++;
+        flatFailed = true;
+    }
+#endif
+    if (!fetchJson(http, url, doc)) return false;
+#if FLATBUFFER_RESPONSES
+    if (flatFailed && ++flatFailures == FLATBUFFER_MAX_FAILURES) {
+        Serial.println("[SYNC] FlatBuffers responses keep failing, using JSON only");
+    }
+#endif
+    JsonObject current = doc["current"];
+    for (size_t i = 0; i < n; i++) out[i] = current[vars[i]] | NAN;
+    return true;
+}
+
+String statText(float v, uint8_t decimals) {
+    return isnan(v) ? String("--") : String(v, (unsigned int)decimals);
+}
+
+// Avoids invalidating (and redrawing) labels whose text did not change
+void setLabelIfChanged(lv_obj_t * label, const char * text) {
+    if (label && strcmp(lv_label_get_text(label), text) != 0) lv_label_set_text(label, text);
+}
+
+void showStatus() {
+    lv_obj_t * label = widget(UiId::Status);
+    if (!label) return;
+    lv_label_set_text(label, statusText);
+    if (statusStale) lv_obj_set_style_text_color(label, lv_palette_main(LV_PALETTE_ORANGE), 0);
+    else lv_obj_remove_local_style_prop(label, LV_STYLE_TEXT_COLOR, 0);
+}
+
+void setStatus(const char * text, bool stale = false) {
+    strncpy(statusText, text, sizeof(statusText) - 1);
+    statusStale = stale;
+    showStatus();
+}
+
+// Readings restored at boot, or kept through failed syncs, are shown with
+// their age until a sync brings new ones
+void showStale(uint32_t timestamp) {
+    char text[40] = "Stale data";
+    struct tm t;
+    time_t ts = timestamp;
+    if (timestamp > 1577836800UL && localtime_r(&ts, &t)) {
+        strftime(text, sizeof(text), "Stale: data from %d.%m %H:%M", &t);
+    }
+    setStatus(text, true);
+}
+
 String getLocalTime() {
     struct tm timeinfo;
     if(!getLocalTime(&timeinfo)){
@@ -124,169 +588,482 @@ String getLocalTime() {
 // ==========================================
 // 5. GUI SETUP
 // ==========================================
+const lv_font_t * uiFont(uint8_t size) {
+    switch (size) {
+        case 20: return &lv_font_montserrat_20;
+        case 28: return &lv_font_montserrat_28;
+        case 48: return &lv_font_montserrat_48;
+        default: return &lv_font_montserrat_14;
+    }
+}
+
+lv_obj_t * createWidget(const WidgetSpec& w, lv_obj_t * parent) {
+    lv_obj_t * obj;
+    switch (w.kind) {
+        case WidgetKind::Panel: obj = lv_obj_create(parent); break;
+        case WidgetKind::Bar:   obj = lv_bar_create(parent); break;
+        default:                obj = lv_label_create(parent); break;
+    }
+    if (w.w) lv_obj_set_size(obj, w.w, w.h);
+    lv_obj_align(obj, w.align, w.x, w.y);
+    if (w.font) lv_obj_set_style_text_font(obj, uiFont(w.font), 0);
+    if (w.color != UI_NO_COLOR) {
+        if (w.kind == WidgetKind::Panel) lv_obj_set_style_border_color(obj, lv_color_hex(w.color), 0);
+        else lv_obj_set_style_text_color(obj, lv_color_hex(w.color), 0);
+    }
+    if (w.bg != UI_NO_COLOR) lv_obj_set_style_bg_color(obj, lv_color_hex(w.bg), 0);
+    // Table strings live in flash: no copy in the LVGL pool
+    if (w.kind == WidgetKind::Label && w.metric == Metric::Count) lv_label_set_text_static(obj, w.text);
+    return obj;
+}
+
+// "<prefix><value> <unit>", "--" while there is no value
+void showMetric(Metric m) {
+    size_t i = metricIndex(m);
+    if (!metricLabel[i]) return;
+    char text[48];
+    if (isnan(metricValue[i])) {
+        snprintf(text, sizeof(text), "%s-- %s", metricPrefix[i], METRIC_INFO[i].unit);
+    } else {
+        snprintf(text, sizeof(text), "%s%.*f %s", metricPrefix[i], METRIC_INFO[i].decimals, metricValue[i], METRIC_INFO[i].unit);
+    }
+    lv_label_set_text(metricLabel[i], text);
+}
+
+// Renderers (below) repaint a tab from the data model when it is rebuilt
+void showWeather();
+void showAirQuality();
+void showLocation();
+
+void buildTab(Tab tab) {
+#if LOG_TAB_BUILD
+    uint32_t start = micros();
+#endif
+    // One pass over the tab's rows of the layout table; parents precede children
+    for (const WidgetSpec& w : UI_LAYOUT) {
+        if (w.tab != tab) continue;
+        lv_obj_t * parent = w.parent == UiId::None ? tabPage[static_cast<size_t>(w.tab)] : widget(w.parent);
+        lv_obj_t * obj = createWidget(w, parent);
+        uiObj[static_cast<size_t>(w.id)] = obj;
+        if (w.metric != Metric::Count) {
+            metricLabel[metricIndex(w.metric)] = obj;
+            metricPrefix[metricIndex(w.metric)] = w.text;
+        }
+    }
+    tabBuilt[static_cast<size_t>(tab)] = true;
+
+    switch (tab) {
+        case Tab::System:
+            showStatus();
+            showLocation();
+            break;
+        case Tab::Air:
+            lv_bar_set_range(widget(UiId::AqiBar), 0, aqi::scaleMax(aqiScale));
+            showAirQuality();
+            break;
+        case Tab::Weather:
+            showWeather();
+            break;
+        default:
+            break;
+    }
+#if LOG_TAB_BUILD
+    lv_mem_monitor_t mem;
+    lv_mem_monitor(&mem);
+    Serial.printf("[TABS] built %s in %u us, LVGL pool used %u (peak %u) of %u\n",
+                  TAB_NAMES[static_cast<size_t>(tab)], (unsigned)(micros() - start),
+                  (unsigned)(mem.total_size - mem.free_size), (unsigned)mem.max_used, (unsigned)mem.total_size);
+#endif
+}
+
+void destroyTab(Tab tab) {
+    lv_obj_clean(tabPage[static_cast<size_t>(tab)]);
+    for (const WidgetSpec& w : UI_LAYOUT) {
+        if (w.tab != tab) continue;
+        uiObj[static_cast<size_t>(w.id)] = nullptr;
+        if (w.metric != Metric::Count) metricLabel[metricIndex(w.metric)] = nullptr;
+    }
+    tabBuilt[static_cast<size_t>(tab)] = false;
+#if LOG_TAB_BUILD
+    Serial.printf("[TABS] freed %s\n", TAB_NAMES[static_cast<size_t>(tab)]);
+#endif
+}
+
+#if LAZY_TABS
+void tab_changed_cb(lv_event_t * e) {
+    static Tab shown = Tab::System;
+    Tab active = static_cast<Tab>(lv_tabview_get_tab_active(tabView));
+    tabHiddenAt[static_cast<size_t>(shown)] = millis();
+    shown = active;
+    if (!isBuilt(active)) buildTab(active);
+}
+
+#if TAB_TEARDOWN_MS
+void tab_teardown_cb(lv_timer_t * timer) {
+    uint32_t active = lv_tabview_get_tab_active(tabView);
+    for (size_t t = 0; t < TAB_COUNT; t++) {
+        if (t != active && tabBuilt[t] && millis() - tabHiddenAt[t] > TAB_TEARDOWN_MS) destroyTab(static_cast<Tab>(t));
+    }
+}
+#endif
+#endif
+
 void create_gui() {
     lv_obj_set_style_bg_color(lv_screen_active(), lv_color_hex(0x101010), 0);
-    lv_obj_t * tabview = lv_tabview_create(lv_screen_active());
-    lv_tabview_set_tab_bar_position(tabview, LV_DIR_TOP);
+    tabView = lv_tabview_create(lv_screen_active());
+    lv_tabview_set_tab_bar_position(tabView, LV_DIR_TOP);
+    for (size_t t = 0; t < TAB_COUNT; t++) tabPage[t] = lv_tabview_add_tab(tabView, TAB_NAMES[t]);
 
-    lv_obj_t * t1 = lv_tabview_add_tab(tabview, "SYSTEM");
-    lv_obj_t * t2 = lv_tabview_add_tab(tabview, "AIR QUAL");
-    lv_obj_t * t3 = lv_tabview_add_tab(tabview, "WEATHER");
-    
-    tab_air = t2; 
-
-    // --- SYSTEM ---
-    lbl_clock = lv_label_create(t1);
-    lv_label_set_text(lbl_clock, "00:00");
-    lv_obj_align(lbl_clock, LV_ALIGN_TOP_RIGHT, -10, 5);
-    lv_obj_set_style_text_font(lbl_clock, &lv_font_montserrat_20, 0);
-    lv_obj_set_style_text_color(lbl_clock, lv_color_hex(0x00FFFF), 0); // Cyan
-
-    lbl_status_header = lv_label_create(t1);
-    lv_label_set_text(lbl_status_header, "WiFi: ... | Gdansk");
-    lv_obj_align(lbl_status_header, LV_ALIGN_TOP_LEFT, 10, 5);
-
-    lv_obj_t * panel_gps = lv_obj_create(t1);
-    lv_obj_set_size(panel_gps, 280, 90);
-    lv_obj_align(panel_gps, LV_ALIGN_TOP_MID, 0, 40);
-    lv_obj_set_style_bg_color(panel_gps, lv_color_hex(0x000000), 0);
-    lv_obj_set_style_border_color(panel_gps, lv_palette_main(LV_PALETTE_GREEN), 0); 
-    
-    lbl_lat_val = lv_label_create(panel_gps);
-    lv_label_set_text(lbl_lat_val, ("LAT: " + String(fixedLat, 4)).c_str());
-    lv_obj_align(lbl_lat_val, LV_ALIGN_TOP_MID, 0, 10);
-    lv_obj_set_style_text_color(lbl_lat_val, lv_color_white(), 0);
-    lv_obj_set_style_text_font(lbl_lat_val, &lv_font_montserrat_20, 0);
-
-    lbl_lng_val = lv_label_create(panel_gps);
-    lv_label_set_text(lbl_lng_val, ("LNG: " + String(fixedLng, 4)).c_str());
-    lv_obj_align(lbl_lng_val, LV_ALIGN_BOTTOM_MID, 0, -10);
-    lv_obj_set_style_text_color(lbl_lng_val, lv_color_white(), 0);
-    lv_obj_set_style_text_font(lbl_lng_val, &lv_font_montserrat_20, 0);
-
-    lbl_info_mode = lv_label_create(t1);
-    lv_label_set_text(lbl_info_mode, "Loc Source: HARDCODED\nAuto-Update: Every 60s\nNTP Clock: Enabled");
-    lv_obj_align(lbl_info_mode, LV_ALIGN_TOP_LEFT, 10, 140);
-    lv_obj_set_style_text_color(lbl_info_mode, lv_palette_main(LV_PALETTE_GREY), 0);
-
-    // --- AIR QUALITY (With Units) ---
-    // Added "ug/m3" for scientific accuracy
-    lbl_pm25 = lv_label_create(t2); lv_label_set_text(lbl_pm25, "PM 2.5: -- ug/m3"); lv_obj_align(lbl_pm25, LV_ALIGN_TOP_LEFT, 10, 20);
-    lbl_pm10 = lv_label_create(t2); lv_label_set_text(lbl_pm10, "PM 10:  -- ug/m3"); lv_obj_align(lbl_pm10, LV_ALIGN_TOP_LEFT, 10, 50);
-    
-    // Gases
-    lbl_no2  = lv_label_create(t2); lv_label_set_text(lbl_no2,  "NO2: -- ug/m3");    lv_obj_align(lbl_no2, LV_ALIGN_TOP_RIGHT, -10, 20);
-    lbl_o3   = lv_label_create(t2); lv_label_set_text(lbl_o3,   "O3:  -- ug/m3");    lv_obj_align(lbl_o3, LV_ALIGN_TOP_RIGHT, -10, 45);
-    lbl_so2  = lv_label_create(t2); lv_label_set_text(lbl_so2,  "SO2: -- ug/m3");    lv_obj_align(lbl_so2, LV_ALIGN_TOP_RIGHT, -10, 70);
-    lbl_co   = lv_label_create(t2); lv_label_set_text(lbl_co,   "CO:  -- ug/m3");    lv_obj_align(lbl_co, LV_ALIGN_TOP_RIGHT, -10, 95);
-    
-    bar_summary = lv_bar_create(t2); 
-    lv_obj_set_size(bar_summary, 260, 15); 
-    lv_obj_align(bar_summary, LV_ALIGN_BOTTOM_MID, 0, -10);
+#if LAZY_TABS
+    // Only the start tab now; the others when first shown
+    buildTab(Tab::System);
+    lv_obj_add_event_cb(tabView, tab_changed_cb, LV_EVENT_VALUE_CHANGED, NULL);
+#if TAB_TEARDOWN_MS
+    lv_timer_create(tab_teardown_cb, 5000, NULL);
+#endif
+#else
+    for (size_t t = 0; t < TAB_COUNT; t++) buildTab(static_cast<Tab>(t));
+#endif
+}
+
+// Bar colour and tab background per AQI level (Good .. Extremely poor)
+const uint32_t AQI_LEVEL_COLOR[aqi::LEVEL_COUNT] = {0x00C853, 0x64DD17, 0xFFD600, 0xFF9100, 0xFF1744, 0xAA00FF};
+const uint32_t AQI_LEVEL_BG[aqi::LEVEL_COUNT]    = {0x101010, 0x101010, 0x202000, 0x202000, 0x300000, 0x300000};
+
+void showAqi(const aqi::Result& r) {
+    lv_obj_set_style_bg_color(tabPage[static_cast<size_t>(Tab::Air)], lv_color_hex(AQI_LEVEL_BG[r.level]), 0); // Red BG = ALARM
+    if (!isBuilt(Tab::Air)) return;
+    if (r.dominant == aqi::Pollutant::None) {
+        // No pollutant in the response: not "0 Good"
+        lv_label_set_text(widget(UiId::Aqi), "AQI: --");
+    } else {
+        lv_label_set_text(widget(UiId::Aqi), ("AQI: " + String(r.index) + " " + aqi::levelName(aqiScale, r.level) +
+                                    " (" + aqi::pollutantName(r.dominant) + ")").c_str());
+    }
+    lv_bar_set_value(widget(UiId::AqiBar), r.index, LV_ANIM_ON);
+    lv_obj_set_style_bg_color(widget(UiId::AqiBar), lv_color_hex(AQI_LEVEL_COLOR[r.level]), LV_PART_INDICATOR);
+}
+
+// Render the latest values (metricValue) - caller holds the LVGL lock
+void showWeather() {
+    if (!isBuilt(Tab::Weather)) return;
+    showMetric(Metric::Temperature);
+    showMetric(Metric::Pressure);
+
+    // Dynamic Temperature Color
+    float temp = metricValue[metricIndex(Metric::Temperature)];
+    lv_obj_t * lbl_temp = widget(UiId::Temp);
+    if(temp < 0) lv_obj_set_style_text_color(lbl_temp, lv_color_hex(0x3399FF), 0); // Cold = Blue
+    else if(temp > 25) lv_obj_set_style_text_color(lbl_temp, lv_color_hex(0xFF3333), 0); // Hot = Red
+    else lv_obj_set_style_text_color(lbl_temp, lv_color_white(), 0); // Normal = White
 
-    // --- WEATHER ---
-    lbl_temp_big = lv_label_create(t3); lv_label_set_text(lbl_temp_big, "-- C"); lv_obj_center(lbl_temp_big);
-    lv_obj_set_style_text_font(lbl_temp_big, &lv_font_montserrat_48, 0);
-    lbl_press_val = lv_label_create(t3); lv_label_set_text(lbl_press_val, "Pressure: -- hPa"); lv_obj_align(lbl_press_val, LV_ALIGN_BOTTOM_MID, 0, -30);
+    WindowSummary day = stats[metricIndex(Metric::Temperature)].day.summary();
+    lv_label_set_text(widget(UiId::TempRange), ("24h: " + statText(day.min, 1) + " .. " + statText(day.max, 1) + " C").c_str());
+}
+
+void showAirQuality() {
+    // AQI first: the tab background shows the alarm even while it is not built.
+    // Until a pollutant has arrived valAqi stays "no data" (AQI: --).
+    bool haveAir = false;
+    for (size_t m = metricIndex(Metric::PM25); m <= metricIndex(Metric::CO); m++) haveAir |= !isnan(metricValue[m]);
+    if (haveAir) {
+        const aqi::Sample sample = {
+            metricValue[metricIndex(Metric::PM25)], metricValue[metricIndex(Metric::PM10)],
+            metricValue[metricIndex(Metric::NO2)],  metricValue[metricIndex(Metric::O3)],
+            metricValue[metricIndex(Metric::SO2)],  metricValue[metricIndex(Metric::CO)]};
+        valAqi = aqi::compute(aqiScale, sample);
+    }
+    showAqi(valAqi);
+    if (!isBuilt(Tab::Air)) return;
+
+    for (size_t m = metricIndex(Metric::PM25); m <= metricIndex(Metric::CO); m++) showMetric(static_cast<Metric>(m));
+
+    const MetricStats& pmStats = stats[metricIndex(Metric::PM25)];
+    lv_label_set_text(widget(UiId::Pm25Stats), ("PM2.5 24h max: " + statText(pmStats.day.summary().max, 0) +
+                                                "\n1h avg: " + statText(pmStats.hour.summary().mean, 0)).c_str());
 }
 
 // ==========================================
-// 6. DATA SYNC LOGIC
+// 6. LOCATION
 // ==========================================
+void showLocation() {
+    char lat[24], lng[24], info[128];
+    snprintf(lat, sizeof(lat), "LAT: %.4f", currentFix.lat);
+    snprintf(lng, sizeof(lng), "LNG: %.4f", currentFix.lng);
+    if (currentFix.fromGps) {
+        snprintf(info, sizeof(info), "Loc Source: GPS (%u sats)\nAuto-Update: Every 60s\nNTP Clock: Enabled", currentFix.satellites);
+    } else {
+        snprintf(info, sizeof(info), "Loc Source: HARDCODED (no fix)\nAuto-Update: Every 60s\nNTP Clock: Enabled");
+    }
+#if SYNC_PROFILE
+    const LatencyHistogram& cycle = syncProfile.phase(SyncPhase::Cycle);
+    if (cycle.count()) {
+        size_t n = strlen(info);
+        snprintf(info + n, sizeof(info) - n, "\nSync p50/p95: %u/%u ms",
+                 (unsigned)(cycle.percentile(50) / 1000), (unsigned)(cycle.percentile(95) / 1000));
+    }
+#endif
+    setLabelIfChanged(widget(UiId::Lat), lat);
+    setLabelIfChanged(widget(UiId::Lng), lng);
+    setLabelIfChanged(widget(UiId::InfoMode), info);
+}
+
+// Called once a second: refresh the GPS panel and, when the position moved
+// into another grid cell, show cached readings for it or request a sync.
+void updateLocation() {
+    currentFix = gps.current();
+    {
+        LvglLock lock;
+        showLocation();
+    }
+
+    GridCell cell = GridCell::of(currentFix.lat, currentFix.lng);
+    if (haveActiveCell && cell == activeCell) return;
+    activeCell = cell;
+    haveActiveCell = true;
+
+    const CellCache::Entry* cached = cellCache.find(cell, millis());
+    if (!cached) {
+        syncRequested = true;
+        return;
+    }
+    syncStats.cacheHits++;
+    lastUpdateTimestamp = millis();
+    LvglLock lock;      // metricValue is read by the tab builders
+    memcpy(metricValue, cached->value, sizeof(metricValue));
+    setUploadValues();
+    showWeather();
+    showAirQuality();
+}
+
+// ==========================================
+// 7. DATA SYNC LOGIC
+// ==========================================
+#if SOAK_TEST
+// Worst case and heap trend over the soak so far. A shrinking largest block
+// at steady free heap is fragmentation; a watchdog gap close to WDT_TIMEOUT
+// is a request path that would reset the board in the field.
+void soakCycleDone() {
+    static uint32_t firstLargest = 0;
+    static uint32_t lowestLargest = UINT32_MAX;
+    uint32_t largest = syncStats.largestFreeBlock;
+    if (!firstLargest) firstLargest = largest;
+    if (largest < lowestLargest) lowestLargest = largest;
+    if (syncStats.cycles % SOAK_REPORT_CYCLES != 0) return;
+
+    uint32_t heap = ESP.getFreeHeap();
+    Serial.printf("[SOAK] %u cycles, worst cycle %u ms, worst WDT gap %u of %u ms, failed %u, parse errors %u\n",
+                  (unsigned)syncStats.cycles, (unsigned)syncStats.maxDurationMs,
+                  (unsigned)syncStats.maxWdtGapMs, (unsigned)(WDT_TIMEOUT * 1000UL),
+                  (unsigned)syncStats.failedRequests, (unsigned)syncStats.parseErrors);
+    Serial.printf("[SOAK] heap free %u (min %u), largest block %u (first %u, lowest %u), fragmentation %u%%\n",
+                  (unsigned)heap, (unsigned)ESP.getMinFreeHeap(), (unsigned)largest,
+                  (unsigned)firstLargest, (unsigned)lowestLargest, (unsigned)(100 - largest * 100ULL / heap));
+    if (syncStats.maxWdtGapMs > WDT_TIMEOUT * 1000UL * 8 / 10) {
+        Serial.println("[SOAK] WARNING: less than 20% watchdog margin");
+    }
+}
+#endif
+
 void syncData() {
     if(WiFi.status() != WL_CONNECTED) {
         setLedColor(true, false, false);
-        lv_label_set_text(lbl_status_header, "WiFi: ERROR");
+        LvglLock lock;
+        setStatus("WiFi: ERROR");
         return;
     }
 
+    syncRequested = false;      // this sync covers the active cell
     setLedColor(false, false, true); // Blue - Syncing
+    uint32_t syncStart = millis();
+#if SYNC_PROFILE
+    PhaseClock cycleClock;
+#endif
+    uint32_t heapStart = ESP.getFreeHeap();
+    uint32_t requestsStart = syncStats.requests;
+    uint32_t rxStart = syncStats.downloadBytes;
+    uint32_t decodedStart = syncStats.decodedBytes;
+    uint32_t txStart = syncStats.uplinkBytes;
     HTTPClient http;
-    JsonDocument doc; 
-
-    // 1. WEATHER REQUEST
-    String urlWeather = "http://api.open-meteo.com/v1/forecast?latitude=" + String(fixedLat, 4) + 
-                        "&longitude=" + String(fixedLng, 4) + 
-                        "&current=temperature_2m,surface_pressure";
-
-    http.begin(urlWeather);
-    if (http.GET() == 200) {
-        deserializeJson(doc, http.getString());
-        float temp  = doc["current"]["temperature_2m"];
-        float press = doc["current"]["surface_pressure"];
-        valTemp = temp;
-        
-        lv_label_set_text(lbl_temp_big, (String(temp, 1) + " C").c_str());
-        lv_label_set_text(lbl_press_val, ("Pressure: " + String(press, 0) + " hPa").c_str());
-
-        // Dynamic Temperature Color
-        if(temp < 0) lv_obj_set_style_text_color(lbl_temp_big, lv_color_hex(0x3399FF), 0); // Cold = Blue
-        else if(temp > 25) lv_obj_set_style_text_color(lbl_temp_big, lv_color_hex(0xFF3333), 0); // Hot = Red
-        else lv_obj_set_style_text_color(lbl_temp_big, lv_color_white(), 0); // Normal = White
-    }
-    http.end();
-    doc.clear();
+    JsonDocument doc(&jsonArena);
+
+    Reading reading;
+    reading.timestamp = time(nullptr);
+    for (size_t m = 0; m < METRIC_COUNT; m++) reading.value[m] = NAN;
+
+    // Open-Meteo's "current" values change every 15 minutes: while the cell
+    // cache holds the active cell, log and upload those instead of fetching
+    // them again
+    const CellCache::Entry* cached = cyclicFromCache ? cellCache.find(activeCell, millis()) : nullptr;
+    bool weatherOk = false, airOk = false;
+
+    if (cached) {
+        syncStats.cacheHits++;
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            recordMetric(reading, static_cast<Metric>(m), cached->value[m]);
+        }
+        weatherOk = airOk = true;
+        LvglLock lock;
+        showWeather();
+        showAirQuality();
+    } else {
+        // Query the centre of the active grid cell so responses are cacheable per cell
+        float cellLat = activeCell.centerLat();
+        float cellLng = activeCell.centerLng();
+
+        // 1. WEATHER REQUEST
+        static const char * const weatherVars[] = {"temperature_2m", "surface_pressure"};
+        float weather[2];
+        String urlWeather = String(weatherApiHost) + "/v1/forecast?latitude=" + String(cellLat, 4) + 
+                            "&longitude=" + String(cellLng, 4);
+
+        if (fetchCurrent(http, urlWeather, weatherVars, 2, doc, weather)) {
+            float temp  = weather[0];
+            float press = weather[1];
+            recordMetric(reading, Metric::Temperature, temp);
+            recordMetric(reading, Metric::Pressure, press);
+            weatherOk = true;
+
+#if SYNC_PROFILE
+            PhaseClock uiClock;
+#endif
+            LvglLock lock;
+            showWeather();
+#if SYNC_PROFILE
+            syncProfile.add(SyncPhase::Ui, uiClock.lap());
+#endif
+        }
+
+        // 2. AIR QUALITY REQUEST
+        static const char * const airVars[] = {"pm10", "pm2_5", "carbon_monoxide", "nitrogen_dioxide",
+                                               "sulphur_dioxide", "ozone"};
+        float air[6];
+        String urlAir = String(airApiHost) + "/v1/air-quality?latitude=" + String(cellLat, 4) + 
+                        "&longitude=" + String(cellLng, 4);
+
+        if (fetchCurrent(http, urlAir, airVars, 6, doc, air)) {
+            float pm10 = air[0];
+            float pm25 = air[1];
+            float co   = air[2];
+            float no2  = air[3];
+            float so2  = air[4];
+            float o3   = air[5];
 
-    // 2. AIR QUALITY REQUEST
-    String urlAir = "http://air-quality-api.open-meteo.com/v1/air-quality?latitude=" + String(fixedLat, 4) + 
-                    "&longitude=" + String(fixedLng, 4) + 
-                    "&current=pm10,pm2_5,carbon_monoxide,nitrogen_dioxide,sulphur_dioxide,ozone";
-
-    http.begin(urlAir);
-    if (http.GET() == 200) {
-        deserializeJson(doc, http.getString());
-        float pm25 = doc["current"]["pm2_5"];
-        float pm10 = doc["current"]["pm10"];
-        float no2  = doc["current"]["nitrogen_dioxide"];
-        float so2  = doc["current"]["sulphur_dioxide"];
-        float o3   = doc["current"]["ozone"];
-        float co   = doc["current"]["carbon_monoxide"];
-
-        valPM25 = (int)pm25;
-
-        // Update UI with Units
-        lv_label_set_text(lbl_pm25, ("PM 2.5: " + String(pm25, 0) + " ug/m3").c_str());
-        lv_label_set_text(lbl_pm10, ("PM 10:  " + String(pm10, 0) + " ug/m3").c_str());
-        lv_label_set_text(lbl_no2,  ("NO2: " + String(no2, 1) + " ug/m3").c_str());
-        lv_label_set_text(lbl_so2,  ("SO2: " + String(so2, 1) + " ug/m3").c_str());
-        lv_label_set_text(lbl_o3,   ("O3:  " + String(o3, 1) + " ug/m3").c_str());
-        lv_label_set_text(lbl_co,   ("CO:  " + String(co, 1) + " ug/m3").c_str());
-
-        // Bar & Alarm Logic
-        lv_bar_set_value(bar_summary, (int)pm25, LV_ANIM_ON);
-        if(pm25 < 25) {
-            lv_obj_set_style_bg_color(bar_summary, lv_palette_main(LV_PALETTE_GREEN), LV_PART_INDICATOR);
-            lv_obj_set_style_bg_color(tab_air, lv_color_hex(0x101010), 0); // Normal BG
-        } else if (pm25 < 50) {
-            lv_obj_set_style_bg_color(bar_summary, lv_palette_main(LV_PALETTE_ORANGE), LV_PART_INDICATOR);
-            lv_obj_set_style_bg_color(tab_air, lv_color_hex(0x202000), 0); // Yellowish BG
-        } else {
-            lv_obj_set_style_bg_color(bar_summary, lv_palette_main(LV_PALETTE_RED), LV_PART_INDICATOR);
-            lv_obj_set_style_bg_color(tab_air, lv_color_hex(0x300000), 0); // Red BG (ALARM)
+            recordMetric(reading, Metric::PM25, pm25);
+            recordMetric(reading, Metric::PM10, pm10);
+            recordMetric(reading, Metric::NO2, no2);
+            recordMetric(reading, Metric::SO2, so2);
+            recordMetric(reading, Metric::O3, o3);
+            recordMetric(reading, Metric::CO, co);
+            airOk = true;
+
+#if SYNC_PROFILE
+            PhaseClock uiClock;
+#endif
+            LvglLock lock;
+            showAirQuality();
+#if SYNC_PROFILE
+            syncProfile.add(SyncPhase::Ui, uiClock.lap());
+#endif
         }
     }
-    http.end();
+    setUploadValues();
+    if (weatherOk || airOk) shownSince = reading.timestamp;
+
+    if (weatherOk && airOk && !cached) {
+        cellCache.store(activeCell, metricValue, millis());
+        if (reading.timestamp > 1577836800UL) lastReadings.save(metricValue, reading.timestamp);
+#if OTA_ENABLED
+        OtaUpdater::markHealthy();    // this firmware works: end its trial
+#endif
+    }
+
+    // Log only once NTP has set the clock (timestamps before 2020 are bogus)
+    if (reading.timestamp > 1577836800UL) history.append(reading);
 
-    // 3. UPLOAD TO THINGSPEAK
-    String tsUrl = "http://api.thingspeak.com/update?api_key=" + thingSpeakApiKey + 
-                   "&field1=" + String(fixedLat, 5) + 
-                   "&field2=" + String(fixedLng, 5) + 
-                   "&field3=" + String(valPM25) +
-                   "&field4=" + String(valTemp);
-    http.begin(tsUrl);
-    http.GET();
+    // 3. UPLOAD
+    uint32_t uploadStart = millis();
+#if SYNC_PROFILE
+    PhaseClock uploadClock;
+#endif
+#if UPLINK_BACKEND == UPLINK_MQTT
+    mqttUplink.publish(reading);
+    syncStats.uplinkBytes = mqttUplink.stats().bytesOut;
+#else
+    String tsUrl = String(thingSpeakHost) + "/update?api_key=" + thingSpeakApiKey + 
+                   "&field1=" + String(currentFix.lat, 5) + 
+                   "&field2=" + String(currentFix.lng, 5) + 
+                   "&field" + String(THINGSPEAK_FIELD[metricIndex(Metric::PM25)]) + "=" + String(valPM25) +
+                   "&field" + String(THINGSPEAK_FIELD[metricIndex(Metric::Temperature)]) + "=" + String(valTemp);
+#if UPLOAD_STATS
+    WindowSummary tempDay = stats[metricIndex(Metric::Temperature)].day.summary();
+    WindowSummary pmDay   = stats[metricIndex(Metric::PM25)].day.summary();
+    if (tempDay.count) tsUrl += "&field5=" + String(tempDay.mean, 2);
+    if (pmDay.count)   tsUrl += "&field6=" + String(pmDay.mean, 1) + "&field7=" + String(pmDay.max, 0);
+#endif
+    uint32_t writtenBefore = netClient.written();
+    beginRequest(http, tsUrl);
+    if (http.GET() != 200) syncStats.failedRequests++;
     http.end();
+    syncStats.uplinkBytes += netClient.written() - writtenBefore;
+#endif
+    syncStats.lastUploadMs = millis() - uploadStart;
+#if SYNC_PROFILE
+    syncProfile.add(SyncPhase::Upload, uploadClock.lap());
+#endif
+
+#if USE_TLS
+    const TlsStats& tls = LeanTlsClient::stats();
+    Serial.printf("[TLS] handshakes %u (resumed %u of %u offered, failed %u), MFL %s\n", (unsigned)tls.handshakes,
+                  (unsigned)tls.resumed, (unsigned)tls.resumedOffers, (unsigned)tls.failures,
+                  LEAN_TLS_MAX_FRAG ? "2048" : "off");
+    Serial.printf("[TLS] last: %s handshake %u ms, heap before %u, lowest %u (%u B used); lowest ever %u\n",
+                  tls.lastResumed ? "resumed" : "full", (unsigned)tls.lastHandshakeMs, (unsigned)tls.heapBefore,
+                  (unsigned)tls.lastHeapLowest, (unsigned)(tls.heapBefore - tls.lastHeapLowest),
+                  (unsigned)tls.heapLowest);
+#endif
 
     setLedColor(false, true, false); // Green - Done
     lastUpdateTimestamp = millis();
-    lv_label_set_text(lbl_status_header, "WiFi: OK | Gdansk");
+    syncStats.cycles++;
+    syncStats.lastDurationMs = lastUpdateTimestamp - syncStart;
+    if (syncStats.lastDurationMs > syncStats.maxDurationMs) syncStats.maxDurationMs = syncStats.lastDurationMs;
+    syncStats.lastHeapDelta = (int32_t)ESP.getFreeHeap() - (int32_t)heapStart;
+    syncStats.largestFreeBlock = ESP.getMaxAllocHeap();
+#if LOG_SYNC_CYCLE
+    Serial.printf("[SYNC] cycle %u: %u ms (upload %u ms), %u requests, rx %u B (decoded %u B), tx %u B, "
+                  "heap %u (%+d), largest block %u\n",
+                  (unsigned)syncStats.cycles, (unsigned)syncStats.lastDurationMs,
+                  (unsigned)syncStats.lastUploadMs, (unsigned)(syncStats.requests - requestsStart),
+                  (unsigned)(syncStats.downloadBytes - rxStart), (unsigned)(syncStats.decodedBytes - decodedStart),
+                  (unsigned)(syncStats.uplinkBytes - txStart),
+                  (unsigned)ESP.getFreeHeap(), (int)syncStats.lastHeapDelta,
+                  (unsigned)syncStats.largestFreeBlock);
+#endif
+#if SYNC_PROFILE
+    syncProfile.add(SyncPhase::Cycle, cycleClock.lap());
+    if (syncStats.cycles % SYNC_PROFILE_REPORT_CYCLES == 0) syncProfile.report();
+#endif
+    {
+        LvglLock lock;
+        if (weatherOk || airOk) setStatus("WiFi: OK | Gdansk");
+        else if (shownSince) showStale(shownSince);
+    }
+    if (weatherOk && airOk && !boot.reached(BootPhase::Data)) {
+        boot.mark(BootPhase::Data);
+        boot.report();
+    }
     
     // Reset Watchdog
-    esp_task_wdt_reset();
+    feedWatchdog();
+
+#if SOAK_TEST
+    soakCycleDone();
+#endif
 }
 
 // ==========================================
-// 7. SETUP & LOOP
+// 8. SETUP & LOOP
 // ==========================================
 hw_timer_t * lvgl_timer = NULL;
 void IRAM_ATTR onTimer() { lv_tick_inc(5); }
@@ -294,16 +1071,27 @@ void IRAM_ATTR onTimer() { lv_tick_inc(5); }
 void setup() {
     WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0); 
     Serial.begin(115200);
+#if OTA_ENABLED
+    OtaUpdater::checkBoot();
+#endif
 
     // Watchdog Init
     esp_task_wdt_init(WDT_TIMEOUT, true);
     esp_task_wdt_add(NULL);
 
+    // Radio first: association, DHCP and NTP run while the GUI is built
+    WiFi.mode(WIFI_STA);
+    WiFi.setTxPower(WIFI_POWER_11dBm);
+    WiFi.begin(ssid, password);
+    sntp_set_time_sync_notification_cb([](struct timeval*) { boot.mark(BootPhase::Ntp); });
+    initTime();
+
     pinMode(CYD_LED_RED, OUTPUT); pinMode(CYD_LED_GREEN, OUTPUT); pinMode(CYD_LED_BLUE, OUTPUT);
     setLedColor(true, false, false);
 
     tft.begin(); tft.setRotation(1); tft.setSwapBytes(true);
     touchSPI.begin(XPT_CLK, XPT_MISO, XPT_MOSI, XPT_CS); touchscreen.begin(touchSPI); touchscreen.setRotation(1);
+    boot.mark(BootPhase::Display);
 
     lv_init();
     lv_display_t * disp = lv_display_create(SCREEN_WIDTH, SCREEN_HEIGHT);
@@ -317,37 +1105,90 @@ void setup() {
     timerAttachInterrupt(lvgl_timer, &onTimer, true);
     timerAlarmWrite(lvgl_timer, 5000, true);
     timerAlarmEnable(lvgl_timer);
+    boot.mark(BootPhase::Lvgl);
 
-    create_gui();
+#if LOG_FRAME_TIME
+    lv_display_add_event_cb(disp, frame_time_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, frame_time_cb, LV_EVENT_REFR_READY, NULL);
+#endif
 
-    WiFi.mode(WIFI_STA);
-    WiFi.setTxPower(WIFI_POWER_11dBm);
-    WiFi.begin(ssid, password);
-    
-    // Fetch time on start
-    initTime();
+    {
+        LvglLock lock;
+        create_gui();
+        boot.mark(BootPhase::Gui);
+
+        // Last known values until the first sync replaces them
+        LastReadings last;
+        if (lastReadings.load(last)) {
+            memcpy(metricValue, last.value, sizeof(metricValue));
+            showWeather();
+            showAirQuality();
+            shownSince = last.timestamp;
+            showStale(shownSince);
+        }
+    }
+    lv_timer_handler();     // first frame now, not after the rest of setup()
+
+#if USE_TLS
+    LeanTlsClient::initShared(tlsRootCa, TLS_ALLOW_UNVERIFIED);
+#endif
+
+#if HTTP_SERVER_ENABLED
+    metricsServer.begin(metricValue, stats, history, syncStats);
+#endif
+
+    gps.begin(Serial2, GPS_RX_PIN, GPS_TX_PIN, fixedLat, fixedLng);
+    updateLocation();
+#if UPLINK_BACKEND == UPLINK_MQTT
+    mqttUplink.begin(mqttHost, mqttPort, mqttClientId, mqttUser, mqttPassword, mqttTopic);
+#endif
+#if OTA_ENABLED
+    otaUpdater.begin(otaManifestUrl, FIRMWARE_VERSION);
+#endif
 }
 
 void loop() {
     lv_task_handler();
-    esp_task_wdt_reset();
+    feedWatchdog();
 
-    // First sync
-    if (WiFi.status() == WL_CONNECTED && lastUpdateTimestamp == 0) {
-        syncData();
-        initTime(); 
+#if HTTP_SERVER_ENABLED
+    metricsServer.poll();
+#endif
+#if UPLINK_BACKEND == UPLINK_MQTT
+    mqttUplink.loop();
+#endif
+#if OTA_ENABLED
+    otaUpdater.poll();
+#endif
+
+    // (Re)connected: retry NTP now instead of at SNTP's next backoff step
+    static bool wifiUp = false;
+    if ((WiFi.status() == WL_CONNECTED) != wifiUp) {
+        wifiUp = !wifiUp;
+        if (wifiUp) {
+            boot.mark(BootPhase::Wifi);
+            if (!boot.reached(BootPhase::Ntp)) sntp_restart();
+        }
     }
 
-    // Cyclic sync
-    if (millis() - lastUpdateTimestamp > updateInterval) {
+    // First sync (it also covers the cell requested from setup()), then
+    // cyclic syncs, or moved into a grid cell with nothing cached
+    if (wifiUp && lastUpdateTimestamp == 0) {
+        syncData();
+    } else if (millis() - lastUpdateTimestamp > updateInterval || (syncRequested && wifiUp)) {
         syncData();
     }
     
-    // Clock Update
+    // Clock & Location Update
     static unsigned long lastClockUpdate = 0;
     if(millis() - lastClockUpdate > 1000) {
         lastClockUpdate = millis();
-        lv_label_set_text(lbl_clock, getLocalTime().c_str());
+        String now = getLocalTime();
+        {
+            LvglLock lock;
+            setLabelIfChanged(widget(UiId::Clock), now.c_str());
+        }
+        updateLocation();
     }
     
     delay(5);
@@ -0,0 +1,338 @@
+#include "metrics_server.h"
+#include "json_arena.h"
+
+#include <lvgl.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+
+// ==========================================
+// HELPERS
+// ==========================================
+namespace {
+
+// Decimals that round-trip the history's fixed-point resolution
+int recordDecimals(size_t m) { return RECORD_SCALE[m] >= 100 ? 2 : 1; }
+
+// Append printf output to buf, never past cap; returns the new length
+size_t appendf(char* buf, size_t len, size_t cap, const char* fmt, ...) {
+    if (len >= cap) return len;
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + len, cap - len, fmt, args);
+    va_end(args);
+    if (n < 0) return len;
+    return (size_t)n >= cap - len ? cap - 1 : len + n;
+}
+
+// Value of ?key= in a query string, 0 if absent
+uint32_t queryUint(const char* query, const char* key) {
+    const char* p = query ? strstr(query, key) : nullptr;
+    return p ? strtoul(p + strlen(key), nullptr, 10) : 0;
+}
+
+} // namespace
+
+// ==========================================
+// CONNECTION HANDLING
+// ==========================================
+void MetricsServer::begin(const float* values, const StatsTable& stats, const ReadingLog& log, const SyncStats& sync) {
+    values_ = values;
+    stats_ = stats;
+    log_ = &log;
+    sync_ = &sync;
+    server_.begin();
+}
+
+void MetricsServer::poll() {
+    accept();
+    for (Conn& c : conns_) {
+        if (c.state == State::Free) continue;
+        if (!c.client.connected() || millis() - c.lastActivity > HTTP_IDLE_TIMEOUT_MS) {
+            close(c);
+            continue;
+        }
+        if (c.state == State::Request) readRequest(c);
+        else if (c.state == State::Metrics) sendMetrics(c);
+        else if (c.state == State::Streaming) streamReadings(c);
+    }
+}
+
+void MetricsServer::accept() {
+    WiFiClient client = server_.available();
+    if (!client) return;
+    for (Conn& c : conns_) {
+        if (c.state != State::Free) continue;
+        c.client = client;
+        c.state = State::Request;
+        c.reqLen = 0;
+        c.outLen = c.outPos = 0;
+        c.lastActivity = millis();
+        return;
+    }
+    // Connection limit reached
+    sendStatus(client, "503 Service Unavailable");
+    client.stop();
+}
+
+void MetricsServer::readRequest(Conn& c) {
+    int avail = c.client.available();
+    if (avail <= 0) return;
+    size_t room = HTTP_REQUEST_MAX - 1 - c.reqLen;
+    c.reqLen += c.client.read((uint8_t*)c.req + c.reqLen, min((size_t)avail, room));
+    c.req[c.reqLen] = '\0';
+    c.lastActivity = millis();
+
+    if (strstr(c.req, "\r\n\r\n")) {
+        route(c);
+    } else if (c.reqLen == HTTP_REQUEST_MAX - 1) {
+        // Only the request line matters; the rest of the headers are drained on close
+        if (strstr(c.req, "\r\n")) {
+            route(c);
+        } else {
+            sendStatus(c.client, "414 URI Too Long");
+            close(c);
+        }
+    }
+}
+
+void MetricsServer::close(Conn& c) {
+    // Unread request bytes would make lwIP answer the close with a RST
+    for (int n = c.client.available(); n > 0; n--) c.client.read();
+    c.client.stop();
+    c.state = State::Free;
+}
+
+void MetricsServer::sendStatus(WiFiClient& client, const char* status) {
+    client.printf("HTTP/1.1 %s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", status);
+}
+
+void MetricsServer::route(Conn& c) {
+    // "GET /path?query HTTP/1.1"
+    if (strncmp(c.req, "GET ", 4) != 0) {
+        sendStatus(c.client, "405 Method Not Allowed");
+        close(c);
+        return;
+    }
+    char* path = c.req + 4;
+    char* end = strchr(path, ' ');
+    if (end) *end = '\0';
+    char* query = strchr(path, '?');
+    if (query) *query++ = '\0';
+
+    if (strcmp(path, "/metrics") == 0) {
+        c.section = 0;
+        c.state = State::Metrics;
+        sendMetrics(c);
+    } else if (strcmp(path, "/readings") == 0) {
+        c.format = (query && strstr(query, "format=json")) ? Format::Json : Format::Csv;
+        c.cursor = log_->from(queryUint(query, "since="));
+        c.first = true;
+        c.last = false;
+        c.state = State::Streaming;
+        c.outLen = appendf(c.out, 0, sizeof(c.out),
+                           "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n",
+                           c.format == Format::Json ? "application/json" : "text/csv");
+        flush(c);
+    } else {
+        sendStatus(c.client, "404 Not Found");
+        close(c);
+    }
+}
+
+// ==========================================
+// OUTPUT
+// ==========================================
+// Writes what the socket takes right now; true once out is empty. write()
+// may take less than offered, so out advances by what it returned.
+bool MetricsServer::flush(Conn& c) {
+    if (c.outPos < c.outLen) {
+        int room = c.client.availableForWrite();
+        if (room <= 0) return false;
+        size_t n = c.client.write((const uint8_t*)c.out + c.outPos, min((size_t)room, (size_t)(c.outLen - c.outPos)));
+        if (n) c.lastActivity = millis();
+        c.outPos += n;
+        if (c.outPos < c.outLen) return false;
+    }
+    c.outPos = c.outLen = 0;
+    return true;
+}
+
+// ==========================================
+// /metrics
+// ==========================================
+// One section per poll, each formatted once the previous one has been
+// written out: no response is ever materialised, and a slow scraper only
+// holds its connection's buffer
+void MetricsServer::sendMetrics(Conn& c) {
+    if (!flush(c)) return;
+    c.outLen = renderMetrics(c.section++, c.out, sizeof(c.out));
+    if (!c.outLen) {
+        close(c);
+        return;
+    }
+    flush(c);
+}
+
+// Text of section i, 0 past the last one
+size_t MetricsServer::renderMetrics(uint8_t section, char* buf, size_t cap) {
+    size_t len = 0;
+    switch (section) {
+    case 0:
+        return appendf(buf, 0, cap, "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nConnection: close\r\n\r\n");
+    case 1:
+        len = appendf(buf, len, cap, "# HELP station_reading Latest value per metric.\n# TYPE station_reading gauge\n");
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            if (isnan(values_[m])) continue;
+            len = appendf(buf, len, cap, "station_reading{metric=\"%s\",unit=\"%s\"} %.*f\n",
+                          METRIC_INFO[m].key, METRIC_INFO[m].unit, recordDecimals(m), values_[m]);
+        }
+        return len;
+    case 2:
+        len = appendf(buf, len, cap, "# HELP station_reading_ewma Moving average per metric, weight 0.2 per reading.\n"
+                                     "# TYPE station_reading_ewma gauge\n");
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            if (isnan(stats_[m].ewma)) continue;
+            len = appendf(buf, len, cap, "station_reading_ewma{metric=\"%s\",unit=\"%s\"} %.*f\n",
+                          METRIC_INFO[m].key, METRIC_INFO[m].unit, recordDecimals(m), stats_[m].ewma);
+        }
+        return len;
+    case 3:
+        len = appendf(buf, len, cap,
+                      "# TYPE station_sync_cycles_total counter\nstation_sync_cycles_total %u\n"
+                      "# TYPE station_sync_failed_requests_total counter\nstation_sync_failed_requests_total %u\n"
+                      "# TYPE station_sync_parse_errors_total counter\nstation_sync_parse_errors_total %u\n",
+                      (unsigned)sync_->cycles, (unsigned)sync_->failedRequests, (unsigned)sync_->parseErrors);
+        len = appendf(buf, len, cap,
+                      "# TYPE station_http_requests_total counter\nstation_http_requests_total %u\n"
+                      "# TYPE station_cell_cache_hits_total counter\nstation_cell_cache_hits_total %u\n",
+                      (unsigned)sync_->requests, (unsigned)sync_->cacheHits);
+        return appendf(buf, len, cap,
+                       "# TYPE station_sync_duration_ms gauge\nstation_sync_duration_ms{stat=\"last\"} %u\n"
+                       "station_sync_duration_ms{stat=\"max\"} %u\n"
+                       "# TYPE station_wdt_max_gap_ms gauge\nstation_wdt_max_gap_ms %u\n",
+                       (unsigned)sync_->lastDurationMs, (unsigned)sync_->maxDurationMs, (unsigned)sync_->maxWdtGapMs);
+    case 4:
+        len = appendf(buf, len, cap,
+                      "# TYPE station_uplink_duration_ms gauge\nstation_uplink_duration_ms %u\n"
+                      "# TYPE station_uplink_bytes_total counter\nstation_uplink_bytes_total %u\n",
+                      (unsigned)sync_->lastUploadMs, (unsigned)sync_->uplinkBytes);
+        len = appendf(buf, len, cap,
+                      "# TYPE station_download_bytes_total counter\nstation_download_bytes_total %u\n"
+                      "# TYPE station_sync_heap_delta_bytes gauge\nstation_sync_heap_delta_bytes %d\n",
+                      (unsigned)sync_->downloadBytes, (int)sync_->lastHeapDelta);
+        return appendf(buf, len, cap,
+                       "# TYPE station_decoded_bytes_total counter\nstation_decoded_bytes_total %u\n"
+                       "# TYPE station_gzip_responses_total counter\nstation_gzip_responses_total %u\n",
+                       (unsigned)sync_->decodedBytes, (unsigned)sync_->gzipResponses);
+    case 5:
+        len = appendf(buf, len, cap,
+                      "# TYPE station_api_transfer_ms_total counter\nstation_api_transfer_ms_total %u\n"
+                      "# TYPE station_gzip_heap_bytes gauge\nstation_gzip_heap_bytes %u\n"
+                      "# TYPE station_gzip_fallbacks_total counter\nstation_gzip_fallbacks_total %u\n",
+                      (unsigned)sync_->transferMs, (unsigned)sync_->gzipHeapBytes, (unsigned)sync_->gzipFallbacks);
+        len = appendf(buf, len, cap,
+                      "# TYPE station_flatbuffer_responses_total counter\nstation_flatbuffer_responses_total %u\n"
+                      "# TYPE station_flatbuffer_fallbacks_total counter\nstation_flatbuffer_fallbacks_total %u\n",
+                      (unsigned)sync_->flatBufferResponses, (unsigned)sync_->flatBufferFallbacks);
+        return appendf(buf, len, cap,
+                       "# TYPE station_json_arena_bytes gauge\nstation_json_arena_bytes{stat=\"high_water\"} %u\n"
+                       "station_json_arena_bytes{stat=\"capacity\"} %u\n"
+                       "# TYPE station_json_arena_overflows_total counter\nstation_json_arena_overflows_total %u\n",
+                       (unsigned)sync_->jsonArenaHighWater, (unsigned)JSON_ARENA_SIZE, (unsigned)sync_->jsonArenaOverflows);
+    case 6: {
+        lv_mem_monitor_t lvMem;
+        lv_lock();
+        lv_mem_monitor(&lvMem);
+        lv_unlock();
+        len = appendf(buf, len, cap,
+                      "# TYPE station_heap_bytes gauge\nstation_heap_bytes{stat=\"free\"} %u\n"
+                      "station_heap_bytes{stat=\"min_free\"} %u\nstation_heap_bytes{stat=\"max_alloc\"} %u\n",
+                      (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(), (unsigned)ESP.getMaxAllocHeap());
+        return appendf(buf, len, cap,
+                       "# TYPE station_lvgl_mem_bytes gauge\nstation_lvgl_mem_bytes{stat=\"free\"} %u\n"
+                       "station_lvgl_mem_bytes{stat=\"max_used\"} %u\n",
+                       (unsigned)lvMem.free_size, (unsigned)lvMem.max_used);
+    }
+    case 7:
+        return appendf(buf, len, cap,
+                       "# TYPE station_history_records gauge\nstation_history_records %u\n"
+                       "# TYPE station_history_bytes gauge\nstation_history_bytes %u\n"
+                       "# TYPE station_uptime_seconds gauge\nstation_uptime_seconds %u\n",
+                       (unsigned)log_->recordCount(), (unsigned)log_->bytesUsed(), (unsigned)(millis() / 1000));
+    default:
+        return 0;
+    }
+}
+
+// ==========================================
+// /readings (chunked)
+// ==========================================
+void MetricsServer::streamReadings(Conn& c) {
+    // The previous chunk goes out first
+    if (!flush(c)) return;
+    if (c.last) {
+        close(c);
+        return;
+    }
+
+    // Chunk layout: "XXX\r\n" <payload> "\r\n" - fixed-width size prefix
+    // lets the payload be formatted in place; room is left for the final
+    // zero-length chunk
+    const size_t PREFIX = 5;
+    const size_t RECORD_ROOM = 200;     // worst-case formatted record
+    char* buf = c.out;
+    size_t len = PREFIX;
+    const size_t cap = sizeof(c.out) - 2 - 5;
+
+    if (c.first) {
+        if (c.format == Format::Csv) {
+            len = appendf(buf, len, cap, "timestamp");
+            for (size_t m = 0; m < METRIC_COUNT; m++) len = appendf(buf, len, cap, ",%s", METRIC_INFO[m].key);
+            len = appendf(buf, len, cap, "\n");
+        } else {
+            len = appendf(buf, len, cap, "[");
+        }
+    }
+
+    Reading r;
+    bool done = false;
+    for (uint16_t n = 0; n < HTTP_RECORDS_PER_POLL && len + RECORD_ROOM < cap; n++) {
+        if (!c.cursor.next(r)) { done = true; break; }
+        if (c.format == Format::Csv) {
+            len = appendf(buf, len, cap, "%u", (unsigned)r.timestamp);
+            for (size_t m = 0; m < METRIC_COUNT; m++) {
+                len = isnan(r.value[m]) ? appendf(buf, len, cap, ",")
+                                        : appendf(buf, len, cap, ",%.*f", recordDecimals(m), r.value[m]);
+            }
+            len = appendf(buf, len, cap, "\n");
+        } else {
+            len = appendf(buf, len, cap, "%s{\"t\":%u", c.first ? "" : ",", (unsigned)r.timestamp);
+            for (size_t m = 0; m < METRIC_COUNT; m++) {
+                len = isnan(r.value[m]) ? appendf(buf, len, cap, ",\"%s\":null", METRIC_INFO[m].key)
+                                        : appendf(buf, len, cap, ",\"%s\":%.*f", METRIC_INFO[m].key, recordDecimals(m), r.value[m]);
+            }
+            len = appendf(buf, len, cap, "}");
+        }
+        c.first = false;
+    }
+    if (done && c.format == Format::Json) len = appendf(buf, len, cap, "]");
+    c.first = false;
+
+    if (len > PREFIX) {
+        char size[PREFIX + 1];
+        snprintf(size, sizeof(size), "%03X\r\n", (unsigned)(len - PREFIX));
+        memcpy(buf, size, PREFIX);
+        buf[len++] = '\r';
+        buf[len++] = '\n';
+    } else {
+        len = 0;
+    }
+    if (done) {
+        memcpy(buf + len, "0\r\n\r\n", 5);
+        len += 5;
+        c.last = true;
+    }
+    c.outLen = len;
+    if (flush(c) && c.last) close(c);
+}
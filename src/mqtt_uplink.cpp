@@ -0,0 +1,82 @@
+#include "mqtt_uplink.h"
+
+void MqttUplink::begin(const char* host, uint16_t port, const char* clientId,
+                       const char* user, const char* pass, const char* topic) {
+    clientId_ = clientId;
+    user_ = user;
+    pass_ = pass;
+    topic_ = topic;
+    mqtt_.setServer(host, port);
+    mqtt_.setKeepAlive(MQTT_KEEPALIVE_S);
+    mqtt_.setSocketTimeout(5);
+    mqtt_.setBufferSize(MQTT_PAYLOAD_MAX + 64);
+}
+
+void MqttUplink::publish(const Reading& r) {
+    if (count_ == MQTT_QUEUE_LEN) {
+        // Full: drop the oldest sample
+        head_ = (head_ + 1) % MQTT_QUEUE_LEN;
+        count_--;
+        stats_.dropped++;
+    }
+    Sample& s = queue_[(head_ + count_) % MQTT_QUEUE_LEN];
+    s.reading = r;
+    s.freeHeap = ESP.getFreeHeap();
+    s.uptime = millis() / 1000;
+    s.rssi = WiFi.RSSI();
+    count_++;
+    flush();
+}
+
+void MqttUplink::loop() {
+    if (mqtt_.connected()) {
+        mqtt_.loop();
+        return;
+    }
+    if (WiFi.status() != WL_CONNECTED || (int32_t)(millis() - nextAttempt_) < 0) return;
+    if (reconnect()) {
+        backoff_ = MQTT_BACKOFF_MIN_MS;
+        flush();
+    } else {
+        nextAttempt_ = millis() + backoff_;
+        backoff_ = min(backoff_ * 2, MQTT_BACKOFF_MAX_MS);
+    }
+}
+
+bool MqttUplink::reconnect() {
+    // cleanSession = false: the broker keeps our session across reconnects
+    bool ok = mqtt_.connect(clientId_, user_, pass_, nullptr, 0, false, nullptr, false);
+    if (ok) stats_.reconnects++;
+    return ok;
+}
+
+void MqttUplink::flush() {
+    if (!mqtt_.connected() || !count_) return;
+    uint32_t start = micros();
+    char payload[MQTT_PAYLOAD_MAX];
+    while (count_) {
+        size_t len = format(queue_[head_], payload, sizeof(payload));
+        if (!mqtt_.publish(topic_, (const uint8_t*)payload, len, false)) break;
+        stats_.published++;
+        head_ = (head_ + 1) % MQTT_QUEUE_LEN;
+        count_--;
+    }
+    stats_.lastPublishUs = micros() - start;
+}
+
+const MqttStats& MqttUplink::stats() {
+    stats_.bytesOut = net_.written();
+    return stats_;
+}
+
+size_t MqttUplink::format(const Sample& s, char* out, size_t cap) const {
+    size_t len = snprintf(out, cap, "%u", (unsigned)s.reading.timestamp);
+    for (size_t m = 0; m < METRIC_COUNT && len < cap; m++) {
+        float v = s.reading.value[m];
+        len += isnan(v) ? snprintf(out + len, cap - len, ",")
+                        : snprintf(out + len, cap - len, ",%.*f", RECORD_SCALE[m] >= 100 ? 2 : 1, v);
+    }
+    if (len < cap) len += snprintf(out + len, cap - len, ",%u,%d,%u",
+                                   (unsigned)s.freeHeap, s.rssi, (unsigned)s.uptime);
+    return len < cap ? len : cap - 1;
+}
@@ -0,0 +1,187 @@
+#include "ota_update.h"
+
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <Update.h>
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <esp_task_wdt.h>
+#include "mbedtls/sha256.h"
+#include "gzip_stream.h"
+
+// NVS: "trial" = boots of a new image that has not been marked healthy yet,
+// "pending" = its version, "rejected" = the last version rolled back
+#define OTA_NVS_NAMESPACE "ota"
+#define OTA_NVS_TRIAL     "trial"
+#define OTA_NVS_PENDING   "pending"
+#define OTA_NVS_REJECTED  "rejected"
+
+void OtaUpdater::begin(const char* manifestUrl, uint32_t currentVersion) {
+    manifestUrl_ = manifestUrl;
+    version_ = currentVersion;
+    Preferences prefs;
+    prefs.begin(OTA_NVS_NAMESPACE, true);
+    rejected_ = prefs.getUInt(OTA_NVS_REJECTED, 0);
+    prefs.end();
+}
+
+void OtaUpdater::poll() {
+    if (!manifestUrl_ || WiFi.status() != WL_CONNECTED || (int32_t)(millis() - nextCheck_) < 0) return;
+    nextCheck_ = millis() + OTA_CHECK_INTERVAL;
+    stats_.checks++;
+    check();
+}
+
+bool OtaUpdater::check() {
+    HTTPClient http;
+    http.setConnectTimeout(OTA_TIMEOUT_MS);
+    http.setTimeout(OTA_TIMEOUT_MS);
+    if (!http.begin(manifestUrl_)) return false;
+    int code = http.GET();
+    String manifest = code == 200 ? http.getString() : String();
+    http.end();
+    if (code != 200) {
+        stats_.failures++;
+        return false;
+    }
+
+    unsigned version = 0;
+    char sha[65];
+    char url[160];
+    if (sscanf(manifest.c_str(), "%u %64s %159s", &version, sha, url) != 3 || strlen(sha) != 64) {
+        Serial.println("[OTA] Malformed manifest");
+        stats_.failures++;
+        return false;
+    }
+    if (version <= version_) return false;
+    if (version <= rejected_) {
+        Serial.printf("[OTA] Firmware %u skipped: %u was rolled back\n", version, (unsigned)rejected_);
+        return false;
+    }
+
+    Serial.printf("[OTA] Firmware %u available (running %u)\n", version, (unsigned)version_);
+    if (!install(version, url, sha)) {
+        stats_.failures++;
+        return false;
+    }
+    return true;
+}
+
+// ==========================================
+// DOWNLOAD -> INFLATE -> FLASH
+// ==========================================
+bool OtaUpdater::install(uint32_t version, const char* url, const char* sha256Hex) {
+    uint32_t start = millis();
+    HTTPClient http;
+    http.setConnectTimeout(OTA_TIMEOUT_MS);
+    http.setTimeout(OTA_TIMEOUT_MS);
+    http.useHTTP10(true);   // plain body, no chunked encoding to strip
+    if (!http.begin(url) || http.GET() != 200) {
+        Serial.println("[OTA] Download failed");
+        http.end();
+        return false;
+    }
+
+    GzipStream gz(http.getStream());
+    if (!gz.begin() || !Update.begin(UPDATE_SIZE_UNKNOWN)) {
+        Serial.printf("[OTA] Cannot start: %s\n", gz.failed() ? "not a gzip image" : Update.errorString());
+        http.end();
+        return false;
+    }
+
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+
+    uint8_t chunk[OTA_CHUNK];
+    bool ok = true;
+    size_t n;
+    while ((n = gz.readBytes((char*)chunk, sizeof(chunk))) > 0) {
+        mbedtls_sha256_update(&sha, chunk, n);
+        if (Update.write(chunk, n) != n) {
+            ok = false;
+            break;
+        }
+        esp_task_wdt_reset();
+    }
+    ok = ok && gz.done();
+
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&sha, digest);
+    mbedtls_sha256_free(&sha);
+    char hex[65];
+    for (size_t i = 0; i < sizeof(digest); i++) sprintf(hex + 2 * i, "%02x", digest[i]);
+
+    stats_.lastCompressedBytes = gz.bytesIn();
+    stats_.lastImageBytes = gz.bytesOut();
+    gz.end();
+    http.end();
+
+    if (!ok || strcasecmp(hex, sha256Hex) != 0) {
+        Serial.printf("[OTA] %s, image discarded\n", ok ? "SHA-256 mismatch" : "Incomplete download");
+        Update.abort();
+        return false;
+    }
+    if (!Update.end(true)) {
+        Serial.printf("[OTA] %s\n", Update.errorString());
+        return false;
+    }
+
+    stats_.lastDurationMs = millis() - start;
+    Serial.printf("[OTA] %u B downloaded for a %u B image (%u%%) in %u ms, restarting\n",
+                  (unsigned)stats_.lastCompressedBytes, (unsigned)stats_.lastImageBytes,
+                  (unsigned)(stats_.lastImageBytes ? stats_.lastCompressedBytes * 100ULL / stats_.lastImageBytes : 0),
+                  (unsigned)stats_.lastDurationMs);
+
+    Preferences prefs;
+    prefs.begin(OTA_NVS_NAMESPACE, false);
+    prefs.putUChar(OTA_NVS_TRIAL, 1);
+    prefs.putUInt(OTA_NVS_PENDING, version);
+    prefs.end();
+    delay(100);     // let Serial drain
+    ESP.restart();
+    return true;
+}
+
+// ==========================================
+// ROLLBACK
+// ==========================================
+void OtaUpdater::checkBoot() {
+    Preferences prefs;
+    prefs.begin(OTA_NVS_NAMESPACE, false);
+    uint8_t boots = prefs.getUChar(OTA_NVS_TRIAL, 0);
+    if (boots == 0) {
+        prefs.end();
+        return;
+    }
+    if (boots <= OTA_TRIAL_BOOTS) {
+        prefs.putUChar(OTA_NVS_TRIAL, boots + 1);
+        prefs.end();
+        return;
+    }
+
+    // With two slots the "next" update partition is the one we came from.
+    // Its version is remembered so check() does not install it again.
+    prefs.putUChar(OTA_NVS_TRIAL, 0);
+    prefs.putUInt(OTA_NVS_REJECTED, prefs.getUInt(OTA_NVS_PENDING, 0));
+    prefs.remove(OTA_NVS_PENDING);
+    prefs.end();
+    const esp_partition_t* previous = esp_ota_get_next_update_partition(nullptr);
+    Serial.printf("[OTA] New firmware never became healthy, rolling back to %s\n",
+                  previous ? previous->label : "?");
+    if (previous && esp_ota_set_boot_partition(previous) == ESP_OK) ESP.restart();
+}
+
+void OtaUpdater::markHealthy() {
+    static bool marked = false;
+    if (marked) return;
+    marked = true;
+    Preferences prefs;
+    prefs.begin(OTA_NVS_NAMESPACE, false);
+    if (prefs.getUChar(OTA_NVS_TRIAL, 0) != 0) {
+        prefs.putUChar(OTA_NVS_TRIAL, 0);
+        prefs.remove(OTA_NVS_PENDING);
+        Serial.println("[OTA] Firmware confirmed");
+    }
+    prefs.end();
+}
@@ -0,0 +1,200 @@
+#include "record_codec.h"
+
+#include <math.h>
+#include <string.h>
+
+// ==========================================
+// VARINT HELPERS
+// ==========================================
+namespace {
+
+const uint8_t FLAG_KEYFRAME = 0x01;
+
+inline uint32_t zigzag(int32_t v)   { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+inline uint8_t* putVarint(uint8_t* p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+// Returns nullptr on truncated or over-long input
+inline const uint8_t* getVarint(const uint8_t* p, const uint8_t* end, uint32_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (p == end) return nullptr;
+        uint8_t b = *p++;
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return p;
+    }
+    return nullptr;
+}
+
+inline int32_t toFixed(float v, size_t metric) {
+    float f = roundf(v * RECORD_SCALE[metric]);
+    if (f > 2147483520.0f) return INT32_MAX;
+    if (f < -2147483520.0f) return INT32_MIN;
+    return (int32_t)f;
+}
+
+} // namespace
+
+// ==========================================
+// ENCODER / DECODER
+// ==========================================
+size_t RecordEncoder::encode(const Reading& r, uint8_t* out, size_t cap, bool keyframe) {
+    keyframe = keyframe || !havePrev_ || r.timestamp < prevTime_;
+
+    uint8_t buf[RECORD_MAX_SIZE];
+    uint8_t mask = 0;
+    int32_t fixed[METRIC_COUNT];
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        if (isnan(r.value[m])) continue;
+        mask |= 1 << m;
+        fixed[m] = toFixed(r.value[m], m);
+    }
+
+    uint8_t* p = buf;
+    *p++ = keyframe ? FLAG_KEYFRAME : 0;
+    *p++ = mask;
+    p = putVarint(p, keyframe ? r.timestamp : r.timestamp - prevTime_);
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        if (!(mask & (1 << m))) continue;
+        // Wrapping subtraction: the decoder's wrapping add restores it exactly
+        int32_t v = keyframe ? fixed[m] : (int32_t)((uint32_t)fixed[m] - (uint32_t)prevValue_[m]);
+        p = putVarint(p, zigzag(v));
+    }
+
+    size_t len = p - buf;
+    if (len > cap) return 0;
+    memcpy(out, buf, len);
+
+    if (keyframe) memset(prevValue_, 0, sizeof(prevValue_));
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        if (mask & (1 << m)) prevValue_[m] = fixed[m];
+    }
+    prevTime_ = r.timestamp;
+    havePrev_ = true;
+    return len;
+}
+
+size_t RecordDecoder::decode(const uint8_t* in, size_t len, Reading& r) {
+    const uint8_t* p = in;
+    const uint8_t* end = in + len;
+    if (len < 2) return 0;
+    bool keyframe = *p++ & FLAG_KEYFRAME;
+    uint8_t mask = *p++;
+    if (!keyframe && !havePrev_) return 0;
+
+    uint32_t t;
+    if (!(p = getVarint(p, end, t))) return 0;
+    int32_t values[METRIC_COUNT];
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        values[m] = keyframe ? 0 : prevValue_[m];
+        if (!(mask & (1 << m))) continue;
+        uint32_t z;
+        if (!(p = getVarint(p, end, z))) return 0;
+        values[m] = (int32_t)((uint32_t)values[m] + (uint32_t)unzigzag(z));
+    }
+
+    // Commit only once the whole record parsed
+    prevTime_ = keyframe ? t : prevTime_ + t;
+    memcpy(prevValue_, values, sizeof(prevValue_));
+    havePrev_ = true;
+
+    r.timestamp = prevTime_;
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        r.value[m] = (mask & (1 << m)) ? values[m] / RECORD_SCALE[m] : NAN;
+    }
+    return p - in;
+}
+
+// ==========================================
+// HISTORY LOG
+// ==========================================
+void ReadingLog::clear() {
+    nextSeq_ = 0;
+    blockCount_ = 0;
+    encoder_.reset();
+}
+
+void ReadingLog::append(const Reading& r) {
+    if (blockCount_) {
+        Block& cur = blocks_[(nextSeq_ - 1) % HISTORY_BLOCK_COUNT];
+        size_t n = encoder_.encode(r, cur.data + cur.used, HISTORY_BLOCK_SIZE - cur.used);
+        if (n) {
+            cur.used += n;
+            cur.records++;
+            return;
+        }
+    }
+
+    // Open a new block (recycling the oldest when all are in use)
+    Block& b = blocks_[nextSeq_ % HISTORY_BLOCK_COUNT];
+    nextSeq_++;
+    if (blockCount_ < HISTORY_BLOCK_COUNT) blockCount_++;
+    encoder_.reset();
+    b.used = encoder_.encode(r, b.data, HISTORY_BLOCK_SIZE, true);
+    b.records = 1;
+    b.firstTime = r.timestamp;
+}
+
+uint32_t ReadingLog::recordCount() const {
+    uint32_t n = 0;
+    for (uint32_t s = oldestSeq(); s < nextSeq_; s++) n += blockBySeq(s)->records;
+    return n;
+}
+
+size_t ReadingLog::bytesUsed() const {
+    size_t n = 0;
+    for (uint32_t s = oldestSeq(); s < nextSeq_; s++) n += blockBySeq(s)->used;
+    return n;
+}
+
+const ReadingLog::Block* ReadingLog::blockBySeq(uint32_t seq) const {
+    return &blocks_[seq % HISTORY_BLOCK_COUNT];
+}
+
+ReadingLog::Cursor ReadingLog::from(uint32_t since) const {
+    Cursor c;
+    c.log_ = this;
+    c.since_ = since;
+    c.blockSeq_ = oldestSeq();
+    // Start in the newest block that begins at or before 'since'
+    for (uint32_t s = nextSeq_; s-- > oldestSeq();) {
+        if (blockBySeq(s)->firstTime <= since) {
+            c.blockSeq_ = s;
+            break;
+        }
+    }
+    return c;
+}
+
+bool ReadingLog::Cursor::next(Reading& r) {
+    for (;;) {
+        if (blockSeq_ < log_->oldestSeq()) {
+            // Block recycled under us: restart at the oldest one still held
+            blockSeq_ = log_->oldestSeq();
+            offset_ = 0;
+            decoder_.reset();
+        }
+        if (blockSeq_ >= log_->nextSeq_) return false;
+
+        const Block* b = log_->blockBySeq(blockSeq_);
+        size_t n = offset_ < b->used ? decoder_.decode(b->data + offset_, b->used - offset_, r) : 0;
+        if (!n) {
+            // End of block (or corrupt data): the newest block may still grow
+            if (blockSeq_ + 1 == log_->nextSeq_) return false;
+            blockSeq_++;
+            offset_ = 0;
+            decoder_.reset();
+            continue;
+        }
+        offset_ += n;
+        if (r.timestamp >= since_) return true;
+    }
+}
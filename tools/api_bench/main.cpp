@@ -0,0 +1,202 @@
+// ==========================================
+// API BENCH
+// ==========================================
+// Host tool: decode cost of the two formats the station can request from
+// Open-Meteo, on responses recorded with curl (from the real API or from
+// tools/api_standin.py). Both sides run the firmware's code path:
+//   json         ArduinoJson with the "current" filter fetchJson() uses,
+//                then one lookup per variable as in fetchCurrent()
+//   flatbuffers  include/open_meteo_fb.h, values read in place
+//
+// Memory is what a decode needs besides the socket: the allocator peak for
+// JSON (jsonArena on the station), the whole body for FlatBuffers, which is
+// buffered before it can be read. Decode time is from memory on this
+// machine; only the ratio carries over to the ESP32.
+//
+//   api_bench [-n iterations] <response.json> <response.fb> [<json> <fb>]...
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <ArduinoJson.h>
+
+#include "open_meteo_fb.h"
+
+namespace {
+
+// malloc with a running total and its peak, like the arena's high water
+class CountingAllocator : public ArduinoJson::Allocator {
+public:
+    void* allocate(size_t size) override {
+        size_t* p = (size_t*)malloc(size + sizeof(size_t));
+        if (!p) return nullptr;
+        *p = size;
+        add(size);
+        return p + 1;
+    }
+    void deallocate(void* ptr) override {
+        if (!ptr) return;
+        size_t* p = (size_t*)ptr - 1;
+        used_ -= *p;
+        free(p);
+    }
+    void* reallocate(void* ptr, size_t newSize) override {
+        if (!ptr) return allocate(newSize);
+        size_t* p = (size_t*)ptr - 1;
+        size_t oldSize = *p;
+        p = (size_t*)realloc(p, newSize + sizeof(size_t));
+        if (!p) return nullptr;
+        *p = newSize;
+        used_ -= oldSize;
+        add(newSize);
+        return p + 1;
+    }
+
+    size_t peak() const { return peak_; }
+
+private:
+    void add(size_t size) {
+        used_ += size;
+        if (used_ > peak_) peak_ = used_;
+    }
+
+    size_t used_ = 0;
+    size_t peak_ = 0;
+};
+
+bool readFile(const char* path, std::string& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    char buf[4096];
+    size_t n;
+    out.clear();
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+    fclose(f);
+    return true;
+}
+
+// One fetchCurrent() worth of JSON: filtered parse, then a lookup per variable
+bool decodeJson(const std::string& body, const std::vector<std::string>& vars, float* out,
+                CountingAllocator& alloc) {
+    JsonDocument filter(&alloc);
+    filter["current"] = true;
+    JsonDocument doc(&alloc);
+    DeserializationError err = deserializeJson(doc, body.data(), body.size(),
+                                               DeserializationOption::Filter(filter));
+    if (err || !doc["current"].is<JsonObject>()) return false;
+    JsonObject current = doc["current"];
+    for (size_t i = 0; i < vars.size(); i++) out[i] = current[vars[i]] | NAN;
+    return true;
+}
+
+bool decodeFlatBuffer(const std::string& body, size_t n, float* out) {
+    omfb::VariablesWithTime current =
+        omfb::Response((const uint8_t*)body.data(), body.size()).current();
+    if (current.count() != n) return false;
+    for (size_t i = 0; i < n; i++) out[i] = current.variable(i).value();
+    return true;
+}
+
+template <typename F>
+double nsPerCall(unsigned iterations, F&& decode) {
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < iterations; i++) {
+        if (!decode()) return NAN;
+    }
+    std::chrono::duration<double, std::nano> took = std::chrono::steady_clock::now() - start;
+    return took.count() / iterations;
+}
+
+// The requested variables, in request order: the keys of the JSON's
+// "current" block without its time axis
+std::vector<std::string> currentVariables(const std::string& json) {
+    std::vector<std::string> vars;
+    JsonDocument doc;
+    if (deserializeJson(doc, json)) return vars;
+    for (JsonPair kv : doc["current"].as<JsonObject>()) {
+        const char* key = kv.key().c_str();
+        if (strcmp(key, "time") && strcmp(key, "interval")) vars.push_back(key);
+    }
+    return vars;
+}
+
+const char* baseName(const char* path) {
+    const char* slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+int benchPair(const char* jsonPath, const char* fbPath, unsigned iterations) {
+    std::string json, fb;
+    if (!readFile(jsonPath, json) || !readFile(fbPath, fb)) {
+        fprintf(stderr, "cannot read %s / %s\n", jsonPath, fbPath);
+        return 1;
+    }
+    std::vector<std::string> vars = currentVariables(json);
+    if (vars.empty()) {
+        fprintf(stderr, "%s: no \"current\" variables\n", jsonPath);
+        return 1;
+    }
+
+    // Both files must hold the same readings, or the comparison means nothing
+    std::vector<float> fromJson(vars.size()), fromFb(vars.size());
+    CountingAllocator jsonAlloc;
+    if (!decodeJson(json, vars, fromJson.data(), jsonAlloc)) {
+        fprintf(stderr, "%s: does not parse\n", jsonPath);
+        return 1;
+    }
+    if (!decodeFlatBuffer(fb, vars.size(), fromFb.data())) {
+        fprintf(stderr, "%s: not a response with %zu current variables\n", fbPath, vars.size());
+        return 1;
+    }
+    // A reading of 0 is not stored in the FlatBuffers (the field default) and
+    // must still come back as 0, not as missing
+    size_t zeros = 0;
+    for (size_t i = 0; i < vars.size(); i++) {
+        bool same = std::isnan(fromJson[i]) ? std::isnan(fromFb[i])
+                                            : std::fabs(fromJson[i] - fromFb[i]) <= 1e-3f * (1 + std::fabs(fromJson[i]));
+        if (!same) {
+            fprintf(stderr, "%s: %s is %g in JSON but %g in FlatBuffers\n", fbPath, vars[i].c_str(),
+                    fromJson[i], fromFb[i]);
+            return 1;
+        }
+        zeros += fromJson[i] == 0;
+    }
+
+    std::vector<float> out(vars.size());
+    double jsonNs = nsPerCall(iterations, [&] {
+        CountingAllocator alloc;
+        return decodeJson(json, vars, out.data(), alloc);
+    });
+    double fbNs = nsPerCall(iterations, [&] { return decodeFlatBuffer(fb, vars.size(), out.data()); });
+
+    printf("%-28s %-12s %7zu %11.1f %10zu\n", baseName(jsonPath), "json", json.size(), jsonNs,
+           jsonAlloc.peak());
+    printf("%-28s %-12s %7zu %11.1f %10zu\n", baseName(fbPath), "flatbuffers", fb.size(), fbNs, fb.size());
+    printf("%-28s %zu variables (%zu zero), flatbuffers %.1fx faster\n", "", vars.size(), zeros, jsonNs / fbNs);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned iterations = 100000;
+    int first = 1;
+    if (argc > 2 && !strcmp(argv[1], "-n")) {
+        iterations = (unsigned)strtoul(argv[2], nullptr, 10);
+        first = 3;
+    }
+    if (iterations == 0 || argc - first < 2 || (argc - first) % 2) {
+        fprintf(stderr, "usage: api_bench [-n iterations] <response.json> <response.fb> [<json> <fb>]...\n");
+        return 2;
+    }
+
+    printf("%-28s %-12s %7s %11s %10s\n", "file", "format", "bytes", "decode ns", "memory B");
+    int status = 0;
+    for (int i = first; i < argc; i += 2) status |= benchPair(argv[i], argv[i + 1], iterations);
+    return status;
+}
@@ -0,0 +1,352 @@
+"""Stand-in for the APIs the station calls, for measuring fetches on the LAN
+(set weatherApiHost / airApiHost / thingSpeakHost in src/main.cpp to
+"<this machine>:<port>").
+
+Answers /v1/forecast and /v1/air-quality with responses shaped like the real
+ones: the requested &current= variables in request order, plus units and
+metadata, and with &hourly= an hourly block over &past_days= and
+&forecast_days= (a few hours null, as the real data has gaps). They are gzip-compressed when the request accepts it, and each
+request logs the bytes it cost on the wire. With &format=flatbuffers the same
+values are sent in Open-Meteo's binary format (include/open_meteo_fb.h).
+ThingSpeak's /update is accepted and answered with an entry id.
+
+With --replay DIR the bodies come from recorded responses instead, named as
+the host harness expects them (tools/host/fixtures): forecast.json,
+forecast.fb, air-quality.json, air-quality.fb, update.txt.
+
+With --faults SEED every Open-Meteo request draws a network fault from the
+host soak's schedule (tools/host/sim/fault_injection.h, same generator and
+seed): a response delayed by 8 s, a body cut in half, a broken ':' or size
+prefix, a 503, or a connection reset after the headers. This is what the
+firmware's SOAK_TEST runs against; the tally is printed every 50 faults.
+
+With --tls CERT KEY it serves HTTPS (USE_TLS in src/main.cpp, with CERT as
+tlsRootCa). Sessions resume through tickets; Python keeps no server-side
+session ID cache, so with --no-tickets every handshake is a full one. Each
+connection logs its handshake time as seen from here, full or resumed, its
+protocol and cipher, and a running tally. OpenSSL honours the
+max_fragment_length the firmware offers (LEAN_TLS_MAX_FRAG), but Python
+cannot show what was negotiated: heap use and handshake times per mode come
+from the firmware's [TLS] lines. mbedTLS checks the address the firmware
+connects to against the certificate's CN (a subjectAltName holding an IP
+address does not count), so:
+
+    openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes
+        -days 365 -subj /CN=192.168.1.10 -keyout standin.key -out standin.pem
+
+    python tools/api_standin.py [port] [--plain] [--delay MS] [--replay DIR]
+                                [--faults SEED] [--tls CERT KEY [--no-tickets]]
+"""
+import calendar
+import gzip
+import json
+import os
+import random
+import socket
+import ssl
+import struct
+import sys
+import time
+from http.server import BaseHTTPRequestHandler, HTTPServer
+from urllib.parse import parse_qs, urlparse
+
+PLAIN = False       # --plain: never compress, for the baseline
+DELAY_MS = 0        # --delay MS: added before each response, to mimic the WAN
+REPLAY_DIR = None   # --replay DIR: serve recorded bodies
+FAULTS = None       # --faults SEED: FaultInjector
+TLS = None          # --tls CERT KEY: ssl.SSLContext
+
+# Fault in fault_injection.h order
+FAULT_NAMES = ("none", "slow", "truncated", "malformed", "5xx", "reset")
+FAULT_SLOW_MS = 8000
+
+# path: (default variables, interval [s], default forecast_days, {variable: (unit, low, high)})
+ENDPOINTS = {
+    "/v1/forecast": ("temperature_2m,surface_pressure", 900, 7, {
+        "temperature_2m": ("°C", -5, 25),
+        "surface_pressure": ("hPa", 990, 1030),
+    }),
+    "/v1/air-quality": ("pm10,pm2_5,carbon_monoxide,nitrogen_dioxide,sulphur_dioxide,ozone", 3600, 5, {
+        "pm10": ("μg/m³", 5, 80),
+        "pm2_5": ("μg/m³", 2, 60),
+        "carbon_monoxide": ("μg/m³", 100, 400),
+        "nitrogen_dioxide": ("μg/m³", 2, 60),
+        "sulphur_dioxide": ("μg/m³", 1, 20),
+        "ozone": ("μg/m³", 20, 120),
+    }),
+}
+
+
+def response(path, query):
+    defaults, interval, days, ranges = ENDPOINTS[path]
+    names = query.get("current", [defaults])[0].split(",")
+    lat = float(query.get("latitude", ["54.35"])[0])
+    lng = float(query.get("longitude", ["18.65"])[0])
+    now = time.strftime("%Y-%m-%dT%H:%M", time.gmtime())
+    # Same place and minute, same values: a JSON and a FlatBuffers request
+    # recorded back to back hold the same readings
+    rng = random.Random("%s %.4f %.4f %s" % (path, lat, lng, now))
+    units = {"time": "iso8601", "interval": "seconds"}
+    current = {"time": now, "interval": interval}
+    for name in names:
+        unit, low, high = ranges.get(name, ("", 0, 100))
+        units[name] = unit
+        current[name] = round(rng.uniform(low, high), 1)
+    doc = {
+        "latitude": lat, "longitude": lng,
+        "generationtime_ms": 0.031, "utc_offset_seconds": 0,
+        "timezone": "GMT", "timezone_abbreviation": "GMT", "elevation": 12.0,
+        "current_units": units, "current": current,
+    }
+    if "hourly" in query:
+        past = int(query.get("past_days", ["0"])[0])
+        days = int(query.get("forecast_days", [str(days)])[0])
+        midnight = calendar.timegm(time.gmtime()[:3] + (0, 0, 0)) - past * 86400
+        hours = [time.strftime("%Y-%m-%dT%H:%M", time.gmtime(midnight + 3600 * h))
+                 for h in range((past + days) * 24)]
+        units = {"time": "iso8601"}
+        hourly = {"time": hours}
+        for name in query["hourly"][0].split(","):
+            unit, low, high = ranges.get(name, ("", 0, 100))
+            units[name] = unit
+            hourly[name] = [None if rng.random() < 0.02 else round(rng.uniform(low, high), 1) for _ in hours]
+        doc["hourly_units"] = units
+        doc["hourly"] = hourly
+    return doc
+
+
+def flatbuffer(doc):
+    """Size-prefixed WeatherApiResponse holding doc's "current" block.
+
+    Only the fields include/open_meteo_fb.h reads: latitude (field 0),
+    longitude (1), utc_offset_seconds (6) and current (9) with its time (0),
+    interval (2) and variables (3), each variable with just a value (2).
+    Like the FlatBuffers builders, scalars equal to their default (0) are
+    left out, so a variable reading 0 is a table without fields. A null
+    reading is stored as NaN. Tables are laid out front to back, so every
+    reference points forward as FlatBuffers requires; each vtable sits
+    right before its table.
+    """
+    buf = bytearray()
+
+    def pad(align):
+        buf.extend(b"\0" * (-len(buf) % align))
+
+    def size_of(fmt):
+        return 4 if fmt in ("T", "V") else struct.calcsize(fmt)
+
+    def table(fields):
+        # fields: [(id, struct format, value)]; "T" = subtable, "V" = vector of tables
+        fields = [f for f in fields if f[1] in ("T", "V") or f[2] != 0]
+        slots = max((f[0] for f in fields), default=-1) + 1
+        pad(2)
+        vtable = len(buf)
+        buf.extend(b"\0" * (4 + 2 * slots))
+        pad(8)
+        start = len(buf)
+        buf.extend(b"\0" * 4)
+        children = []
+        for fid, fmt, value in sorted(fields, key=lambda f: -size_of(f[1])):
+            pad(size_of(fmt))
+            struct.pack_into("<H", buf, vtable + 4 + 2 * fid, len(buf) - start)
+            if fmt in ("T", "V"):
+                children.append((len(buf), fmt, value))
+                buf.extend(b"\0" * 4)
+            else:
+                buf.extend(struct.pack("<" + fmt, value))
+        struct.pack_into("<HH", buf, vtable, 4 + 2 * slots, len(buf) - start)
+        struct.pack_into("<i", buf, start, start - vtable)
+        for slot, fmt, value in children:
+            if fmt == "T":
+                struct.pack_into("<I", buf, slot, table(value) - slot)
+                continue
+            pad(4)
+            struct.pack_into("<I", buf, slot, len(buf) - slot)
+            elems = len(buf) + 4
+            buf.extend(struct.pack("<I", len(value)) + b"\0" * 4 * len(value))
+            for i, item in enumerate(value):
+                struct.pack_into("<I", buf, elems + 4 * i, table(item) - (elems + 4 * i))
+        return start
+
+    current = doc["current"]
+    t = calendar.timegm(time.strptime(current["time"], "%Y-%m-%dT%H:%M"))
+    variables = [[(2, "f", float("nan") if v is None else v)]
+                 for k, v in current.items() if k not in ("time", "interval")]
+    buf.extend(b"\0" * 8)      # root offset, padded so tables start 8-aligned
+    root = table([(0, "f", doc["latitude"]), (1, "f", doc["longitude"]),
+                  (6, "i", doc["utc_offset_seconds"]),
+                  (9, "T", [(0, "q", t), (2, "i", current["interval"]), (3, "V", variables)])])
+    struct.pack_into("<I", buf, 0, root)
+    return struct.pack("<I", len(buf)) + bytes(buf)
+
+
+class FaultInjector:
+    """fault_injection.h's FaultInjector: xorshift32, one draw per request"""
+
+    def __init__(self, seed):
+        self.state = seed & 0xFFFFFFFF or 1
+        self.injected = [0] * len(FAULT_NAMES)
+
+    def next(self):
+        s = self.state
+        s ^= (s << 13) & 0xFFFFFFFF
+        s ^= s >> 17
+        s ^= (s << 5) & 0xFFFFFFFF
+        self.state = s
+        roll = s % (2 * (len(FAULT_NAMES) - 1))
+        fault = roll if roll < len(FAULT_NAMES) else 0
+        self.injected[fault] += 1
+        return FAULT_NAMES[fault]
+
+    def tally(self):
+        return ", ".join("%s %d" % (name, n) for name, n in zip(FAULT_NAMES[1:], self.injected[1:]))
+
+
+def recorded(path, flat):
+    name = path.rsplit("/", 1)[-1] + (".fb" if flat else ".json")
+    with open(os.path.join(REPLAY_DIR, name), "rb") as f:
+        return f.read()
+
+
+class TlsServer(HTTPServer):
+    """HTTPServer whose connections are TLS, each handshake timed and logged"""
+
+    handshakes = {"full": [], "resumed": []}
+
+    def get_request(self):
+        sock, addr = self.socket.accept()
+        conn = TLS.wrap_socket(sock, server_side=True, do_handshake_on_connect=False)
+        start = time.perf_counter()
+        try:
+            conn.do_handshake()
+        except (ssl.SSLError, OSError) as e:
+            conn.close()
+            print("%s TLS handshake failed: %s" % (addr[0], e))
+            raise OSError(e)
+        ms = (time.perf_counter() - start) * 1000
+        kind = "resumed" if conn.session_reused else "full"
+        TlsServer.handshakes[kind].append(ms)
+        print("%s TLS %s handshake %.1f ms, %s %s; %s" % (addr[0], kind, ms, conn.version(), conn.cipher()[0],
+                                                      TlsServer.tally()))
+        return conn, addr
+
+    @staticmethod
+    def tally():
+        return ", ".join("%s %d (mean %.1f ms)" % (kind, len(ms), sum(ms) / len(ms) if ms else 0)
+                         for kind, ms in TlsServer.handshakes.items())
+
+
+class Handler(BaseHTTPRequestHandler):
+    entries = 0     # ThingSpeak updates so far
+
+    def do_GET(self):
+        url = urlparse(self.path)
+        if url.path == "/update":
+            self.update()
+            return
+        if url.path not in ENDPOINTS:
+            self.send_error(404)
+            return
+        query = parse_qs(url.query)
+
+        flat = query.get("format", ["json"])[0] == "flatbuffers"
+        if REPLAY_DIR:
+            body = recorded(url.path, flat)
+        else:
+            doc = response(url.path, query)
+            body = flatbuffer(doc) if flat else json.dumps(doc, separators=(",", ":")).encode()
+        fault = FAULTS.next() if FAULTS else "none"
+        if fault != "none" and sum(FAULTS.injected[1:]) % 50 == 0:
+            print("faults injected: " + FAULTS.tally())
+        if fault == "malformed":
+            at = 0 if flat else body.find(b":")
+            if at >= 0:
+                body = body[:at] + (b"\x7f" if flat else b"=") + body[at + 1:]
+        if fault == "5xx":
+            self.send_error(503)
+            print("%s %s: 503 (injected)" % (self.client_address[0], url.path))
+            return
+        raw = len(body)
+        encoding = None
+        if not PLAIN and "gzip" in self.headers.get("Accept-Encoding", ""):
+            body = gzip.compress(body)
+            encoding = "gzip"
+
+        if DELAY_MS:
+            time.sleep(DELAY_MS / 1000)
+        if fault == "slow":
+            time.sleep(FAULT_SLOW_MS / 1000)
+        self.send_response(200)
+        self.send_header("Content-Type", "application/octet-stream" if flat else "application/json")
+        if encoding:
+            self.send_header("Content-Encoding", encoding)
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        sent = {"truncated": len(body) // 2, "reset": 0}.get(fault, len(body))
+        self.wfile.write(body[:sent])
+        if sent < len(body):
+            # RST instead of FIN: the client sees the connection drop
+            self.wfile.flush()
+            self.connection.setsockopt(socket.SOL_SOCKET, socket.SO_LINGER, struct.pack("ii", 1, 0))
+            self.close_connection = True
+        print("%s %s: %d B %s, %d B sent (%s)%s" % (self.client_address[0], url.path, raw,
+                                                   "flatbuffers" if flat else "json", sent,
+                                                   encoding or "identity",
+                                                   "" if fault == "none" else ", " + fault + " (injected)"))
+
+    def update(self):
+        """ThingSpeak channel update: the new entry's id, as text"""
+        Handler.entries += 1
+        if REPLAY_DIR:
+            with open(os.path.join(REPLAY_DIR, "update.txt"), "rb") as f:
+                body = f.read()
+        else:
+            body = str(Handler.entries).encode()
+        self.send_response(200)
+        self.send_header("Content-Type", "text/plain")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+        print("%s /update: %d B sent" % (self.client_address[0], len(body)))
+
+    def log_message(self, *args):
+        pass
+
+
+def main():
+    global PLAIN, DELAY_MS, REPLAY_DIR, FAULTS, TLS
+    port = 8080
+    tickets = True
+    args = iter(sys.argv[1:])
+    for arg in args:
+        if arg == "--plain":
+            PLAIN = True
+        elif arg == "--delay":
+            DELAY_MS = int(next(args, "0"))
+        elif arg == "--replay":
+            REPLAY_DIR = next(args, ".")
+        elif arg == "--faults":
+            FAULTS = FaultInjector(int(next(args, "1")))
+        elif arg == "--tls":
+            cert, key = next(args, None), next(args, None)
+            if not key:
+                sys.exit(__doc__)
+            TLS = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+            TLS.load_cert_chain(cert, key)
+        elif arg == "--no-tickets":
+            tickets = False
+        elif arg.isdigit():
+            port = int(arg)
+        else:
+            sys.exit(__doc__)
+    if TLS and not tickets:
+        TLS.options |= ssl.OP_NO_TICKET
+    print("API stand-in on port %d (%s%s%s%s)" % (port, "plain" if PLAIN else "gzip when accepted",
+                                               ", replaying " + REPLAY_DIR if REPLAY_DIR else "",
+                                               ", injecting faults" if FAULTS else "",
+                                               ", TLS" + ("" if tickets else " without tickets") if TLS else ""))
+    (TlsServer if TLS else HTTPServer)(("", port), Handler).serve_forever()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,94 @@
+"""Fetch past readings for the station's cell from Open-Meteo, as the
+station's own /readings CSV, for tools/record_bench.
+
+The historical weather API (archive-api) gives temperature and pressure, the
+air-quality API the six pollutants, both hourly. One record is written every
+STEP seconds (60, the station's sync interval, by default), holding the last
+hourly value the way the station's log repeats a reading until the model
+updates. Air quality updates hourly on the station too; temperature and
+pressure update every 15 minutes there, so their deltas are understated.
+Hours the APIs have no value for are left empty.
+
+The archive lags a few days behind, so the default month ends a week ago.
+
+    python tools/fetch_history.py [out.csv] [--days N] [--end YYYY-MM-DD]
+                                  [--step S] [--at LAT LNG]
+    python tools/fetch_history.py gdansk-month.csv
+"""
+import calendar
+import datetime
+import json
+import sys
+import time
+from urllib.request import urlopen
+
+# src/main.cpp's cell for Gdansk; include/metrics.h order
+LATITUDE, LONGITUDE = 54.35, 18.65
+WEATHER = ("https://archive-api.open-meteo.com/v1/archive", ("temperature_2m", "surface_pressure"))
+AIR = ("https://air-quality-api.open-meteo.com/v1/air-quality",
+       ("pm2_5", "pm10", "nitrogen_dioxide", "sulphur_dioxide", "ozone", "carbon_monoxide"))
+METRICS = WEATHER[1] + AIR[1]
+
+
+def hourly(api, lat, lng, start, end):
+    """{unix hour: {variable: value}} for [start, end]"""
+    url, variables = api
+    url += "?latitude=%.4f&longitude=%.4f&start_date=%s&end_date=%s&hourly=%s&timezone=GMT" % (
+        lat, lng, start, end, ",".join(variables))
+    print("fetching " + url, file=sys.stderr)
+    with urlopen(url, timeout=60) as r:
+        doc = json.load(r)
+    block = doc["hourly"]
+    hours = {}
+    for i, t in enumerate(block["time"]):
+        ts = calendar.timegm(time.strptime(t, "%Y-%m-%dT%H:%M"))
+        hours[ts] = {v: block[v][i] for v in variables}
+    return hours
+
+
+def main():
+    out, days, end, step = None, 30, None, 60
+    lat, lng = LATITUDE, LONGITUDE
+    args = iter(sys.argv[1:])
+    try:
+        for arg in args:
+            if arg == "--days":
+                days = int(next(args))
+            elif arg == "--end":
+                end = datetime.date.fromisoformat(next(args))
+            elif arg == "--step":
+                step = int(next(args))
+            elif arg == "--at":
+                lat, lng = float(next(args)), float(next(args))
+            elif not arg.startswith("-") and out is None:
+                out = arg
+            else:
+                sys.exit(__doc__)
+    except (StopIteration, ValueError):
+        sys.exit(__doc__)
+    if days < 1 or step < 1:
+        sys.exit(__doc__)
+    end = end or datetime.date.today() - datetime.timedelta(days=7)
+    start = end - datetime.timedelta(days=days - 1)
+
+    weather = hourly(WEATHER, lat, lng, start, end)
+    air = hourly(AIR, lat, lng, start, end)
+    first = calendar.timegm(start.timetuple())
+    last = calendar.timegm(end.timetuple()) + 86400
+
+    f = open(out, "w") if out else sys.stdout
+    f.write("timestamp," + ",".join(METRICS) + "\n")
+    records = 0
+    for ts in range(first, last, step):
+        hour = ts - ts % 3600
+        values = dict(weather.get(hour, {}), **air.get(hour, {}))
+        f.write("%d,%s\n" % (ts, ",".join("" if values.get(m) is None else str(values[m]) for m in METRICS)))
+        records += 1
+    if out:
+        f.close()
+    print("%d records, %s to %s at (%.2f, %.2f), one every %d s" % (records, start, end, lat, lng, step),
+          file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
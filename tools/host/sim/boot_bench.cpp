@@ -0,0 +1,88 @@
+// ==========================================
+// BOOT BENCH
+// ==========================================
+// Cold boot of src/main.cpp on the virtual clock, with the waits that
+// dominate it on the board put on that clock:
+//
+//   --join ms       WiFi.begin() to connected (association + DHCP)
+//   --panel-init ms tft.begin(); TFT_eSPI's ILI9341 init waits 150 ms
+//                   after the reset and 120 ms after sleep-out
+//   --spi hz        pixels flushed at 16 bits each (platformio.ini's
+//                   SPI_FREQUENCY)
+//   --rtt ms        every request's round trip (replay server, in process)
+//
+// Reported, in ms since reset:
+//
+//   setup done      setup() returned
+//   first frame     a screenful of pixels had reached the panel
+//   fresh data      the first sync completed with readings
+//
+// CPU time (lv_init, building the GUI, rendering) is not on the clock, so
+// what overlaps with it on the board does not show here.
+//
+//   boot_bench [--join ms] [--panel-init ms] [--spi hz] [--rtt ms] [--fixtures dir] [-v]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+
+#include "firmware.h"
+#include "host.h"
+
+namespace {
+
+int usage() {
+    fprintf(stderr, "usage: boot_bench [--join ms] [--panel-init ms] [--spi hz] [--rtt ms] [--fixtures dir] [-v]\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t joinMs = 2000;
+    uint32_t panelInitMs = 270;
+    uint32_t spiHz = 55000000;
+    host::Link link;
+    link.rttMs = 50;
+    std::string fixtures = sim::defaultFixtures();
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!strcmp(a, "-v")) { verbose = true; continue; }
+        if (!v) return usage();
+        if (!strcmp(a, "--join")) joinMs = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "--panel-init")) panelInitMs = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "--spi")) spiHz = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "--rtt")) link.rttMs = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "--fixtures")) fixtures = v;
+        else return usage();
+        i++;
+    }
+
+    tzset();
+    ReplayServer replay;
+    if (!replay.load(fixtures)) return 1;
+    host::useVirtualClock(true);
+    host::setSerialOutput(verbose);
+    host::setLink(link);
+    host::setWifiJoinMs(joinMs);
+    host::setPanelTiming(panelInitMs, spiHz);
+    sim::serveApis(replay);
+
+    setup();
+    const uint32_t setupMs = millis();
+    bool synced = sim::runUntilCycle(1, 60000);
+    const uint32_t dataMs = millis();
+
+    printf("boot_bench: WiFi join %u ms, panel init %u ms, SPI %u Hz, RTT %u ms\n", (unsigned)joinMs,
+           (unsigned)panelInitMs, (unsigned)spiHz, (unsigned)link.rttMs);
+    printf("  %-12s %8u ms\n", "setup done", (unsigned)setupMs);
+    printf("  %-12s %8u ms\n", "first frame", (unsigned)host::displayStats().firstScreenMs);
+    printf("  %-12s %8u ms\n", "fresh data", synced ? (unsigned)dataMs : 0u);
+    return synced && syncStats.failedRequests == 0 && host::displayStats().firstScreenMs ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// ==========================================
+// FAULT INJECTION
+// ==========================================
+// Deterministic schedule of network faults applied to the Open-Meteo
+// responses by the replay server (the host soak) and by
+// tools/api_standin.py --faults (SOAK_TEST on the board), which repeats
+// this generator. Every request draws one entry; roughly half of them are
+// clean.
+
+#include <stdint.h>
+
+enum class Fault : uint8_t {
+    None,
+    Slow,           // response delayed by FAULT_SLOW_MS
+    Truncated,      // body cut in half
+    Malformed,      // a ':' (JSON) or the size prefix (FlatBuffers) broken
+    ServerError,    // 503 instead of the real response
+    Reset,          // connection dropped before the body is read
+    Count
+};
+
+constexpr uint32_t FAULT_SLOW_MS = 8000;
+
+class FaultInjector {
+public:
+    explicit FaultInjector(uint32_t seed = 1) : state_(seed ? seed : 1) {}
+
+    Fault next() {
+        // xorshift32: same sequence on every run with the same seed
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        uint8_t roll = state_ % (2 * ((uint8_t)Fault::Count - 1));
+        Fault f = roll < (uint8_t)Fault::Count ? (Fault)roll : Fault::None;
+        injected_[(uint8_t)f]++;
+        return f;
+    }
+
+    uint32_t injected(Fault f) const { return injected_[(uint8_t)f]; }
+
+private:
+    uint32_t state_;
+    uint32_t injected_[(uint8_t)Fault::Count] = {};
+};
@@ -0,0 +1,39 @@
+#include "firmware.h"
+
+#include <time.h>
+
+#ifndef HOST_FIXTURES_DIR
+#define HOST_FIXTURES_DIR "fixtures"
+#endif
+
+namespace sim {
+
+void serveApis(ReplayServer& replay) {
+    host::Handler handler = [&replay](const std::string& request) { return replay(request); };
+    host::serve(weatherApiHost, handler);
+    host::serve(airApiHost, handler);
+    host::serve(thingSpeakHost, handler);
+}
+
+void useServer(const char* hostAndPort) {
+    weatherApiHost = airApiHost = thingSpeakHost = hostAndPort;
+}
+
+bool runUntilCycle(uint32_t cycles, uint32_t timeoutMs) {
+    uint32_t start = millis();
+    while (syncStats.cycles < cycles) {
+        if (millis() - start > timeoutMs) return false;
+        loop();
+    }
+    return true;
+}
+
+uint64_t cpuMicros() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+const char* defaultFixtures() { return HOST_FIXTURES_DIR; }
+
+} // namespace sim
@@ -0,0 +1,47 @@
+#pragma once
+
+// ==========================================
+// FIRMWARE UNDER TEST
+// ==========================================
+// src/main.cpp built for the host (tools/host/standin): its entry points and
+// the globals a host program steers, plus helpers shared by the benchmark
+// and the soak.
+
+#include <Arduino.h>
+#include <lvgl.h>
+#include "metrics.h"
+#include "ui_layout.h"
+#include "replay_server.h"
+
+void setup();
+void loop();
+
+extern SyncStats syncStats;
+extern unsigned long updateInterval;
+extern bool cyclicFromCache;
+extern const char* weatherApiHost;
+extern const char* airApiHost;
+extern const char* thingSpeakHost;
+extern lv_obj_t* tabView;
+extern bool tabBuilt[TAB_COUNT];
+
+namespace sim {
+
+// Answer the firmware's three API hosts from replay, in process
+void serveApis(ReplayServer& replay);
+
+// Point the firmware's three API hosts at "host:port" (a real server,
+// e.g. tools/api_standin.py)
+void useServer(const char* hostAndPort);
+
+// Run loop() until syncStats.cycles reaches cycles; false if that takes
+// longer than timeoutMs on the firmware's clock
+bool runUntilCycle(uint32_t cycles, uint32_t timeoutMs);
+
+// Thread CPU time, for what one loop() costs on this machine
+uint64_t cpuMicros();
+
+// Directory holding the recorded responses (set by CMake)
+const char* defaultFixtures();
+
+} // namespace sim
@@ -0,0 +1,104 @@
+#include "mqtt_broker.h"
+
+namespace {
+
+// MQTT's length-prefixed string at pos; pos moves past it
+std::string readString(const std::string& body, size_t& pos) {
+    if (pos + 2 > body.size()) return std::string();
+    size_t len = (uint8_t)body[pos] << 8 | (uint8_t)body[pos + 1];
+    std::string s = body.substr(pos + 2, len);
+    pos += 2 + len;
+    return s;
+}
+
+void send(WiFiClient& client, std::initializer_list<uint8_t> bytes) {
+    std::vector<uint8_t> packet(bytes);
+    client.write(packet.data(), packet.size());
+}
+
+} // namespace
+
+void MqttBroker::operator()(uint32_t connection, WiFiClient& client) {
+    Connection& c = open_[connection];
+    c.client = client;
+    uint8_t buf[256];
+    int n;
+    while ((n = client.read(buf, sizeof(buf))) > 0) {
+        c.pending.append((const char*)buf, n);
+        bytesIn_ += n;
+    }
+
+    // Fixed header: type and flags, then the remaining length (1-4 bytes, 7 bits each)
+    while (c.pending.size() >= 2) {
+        size_t len = 0, pos = 1;
+        unsigned shift = 0;
+        uint8_t digit;
+        do {
+            if (pos >= c.pending.size()) return;
+            digit = c.pending[pos++];
+            len |= (size_t)(digit & 0x7f) << shift;
+            shift += 7;
+        } while (digit & 0x80);
+        if (c.pending.size() < pos + len) return;
+        uint8_t header = c.pending[0];
+        std::string body = c.pending.substr(pos, len);
+        c.pending.erase(0, pos + len);
+        packet(connection, c, header, body);
+        if (!c.client.connected()) {
+            open_.erase(connection);
+            return;
+        }
+    }
+}
+
+void MqttBroker::packet(uint32_t connection, Connection& c, uint8_t header, const std::string& body) {
+    switch (header >> 4) {
+    case 1: {   // CONNECT
+        size_t pos = 0;
+        readString(body, pos);                      // "MQTT"
+        uint8_t flags = pos + 1 < body.size() ? body[pos + 1] : 0;
+        pos += 4;                                   // level, flags, keep alive
+        std::string clientId = readString(body, pos);
+        connects_++;
+        if (refuse_) {
+            send(c.client, {0x20, 0x02, 0x00, 0x03});
+            c.client.stop();
+            return;
+        }
+        bool present = false;
+        if (flags & 0x02) {
+            sessions_.erase(clientId);
+        } else {
+            present = !sessions_.insert(clientId).second;
+            if (present) resumed_++;
+        }
+        send(c.client, {0x20, 0x02, (uint8_t)present, 0x00});
+        break;
+    }
+    case 3: {   // PUBLISH
+        size_t pos = 0;
+        std::string topic = readString(body, pos);
+        uint8_t qos = (header >> 1) & 3;
+        if (qos) {
+            send(c.client, {0x40, 0x02, (uint8_t)body[pos], (uint8_t)body[pos + 1]});
+            pos += 2;
+        }
+        messages_.push_back(Message{topic, body.substr(pos), connection});
+        break;
+    }
+    case 12:    // PINGREQ
+        pings_++;
+        send(c.client, {0xd0, 0x00});
+        break;
+    case 14:    // DISCONNECT
+        c.client.stop();
+        break;
+    default:
+        break;
+    }
+}
+
+void MqttBroker::drop() {
+    for (auto& c : open_) c.second.client.stop();
+    open_.clear();
+}
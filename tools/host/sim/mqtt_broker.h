@@ -0,0 +1,59 @@
+#pragma once
+
+// ==========================================
+// MQTT BROKER
+// ==========================================
+// In-process stand-in for the broker mqtt_uplink.h publishes to
+// (host::serveStream()): the MQTT 3.1.1 subset the uplink uses. CONNECT
+// is answered with CONNACK, with "session present" when the client id
+// connected before with clean session off; PUBLISH is recorded (QoS 1 is
+// acknowledged); PINGREQ gets PINGRESP; DISCONNECT closes.
+//
+// The test decides what the network does: drop() closes every open
+// connection, as a lost link would, and refuse(true) answers CONNECT with
+// "server unavailable" until refuse(false).
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <WiFi.h>
+
+class MqttBroker {
+public:
+    struct Message {
+        std::string topic;
+        std::string payload;
+        uint32_t connection;        // host::serveStream()'s connection number
+    };
+
+    void operator()(uint32_t connection, WiFiClient& client);
+
+    void drop();
+    void refuse(bool on) { refuse_ = on; }
+
+    const std::vector<Message>& messages() const { return messages_; }
+    uint32_t connects() const { return connects_; }
+    uint32_t sessionsResumed() const { return resumed_; }
+    uint32_t pings() const { return pings_; }
+    uint64_t bytesReceived() const { return bytesIn_; }    // every packet, headers included
+
+private:
+    struct Connection {
+        WiFiClient client;
+        std::string pending;        // bytes of a packet not complete yet
+    };
+
+    void packet(uint32_t connection, Connection& c, uint8_t type, const std::string& body);
+
+    std::map<uint32_t, Connection> open_;
+    std::set<std::string> sessions_;    // client ids with a kept session
+    std::vector<Message> messages_;
+    bool refuse_ = false;
+    uint32_t connects_ = 0;
+    uint32_t resumed_ = 0;
+    uint32_t pings_ = 0;
+    uint64_t bytesIn_ = 0;
+};
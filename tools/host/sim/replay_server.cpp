@@ -0,0 +1,122 @@
+#include "replay_server.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <zlib.h>
+
+namespace {
+
+bool readFile(const std::string& path, std::string& out) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    char buf[4096];
+    size_t n;
+    out.clear();
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+    fclose(f);
+    return true;
+}
+
+// Value of a request header, empty if absent
+std::string headerValue(const std::string& request, const char* name) {
+    size_t nameLen = strlen(name);
+    for (size_t line = request.find("\r\n"); line != std::string::npos; line = request.find("\r\n", line + 2)) {
+        size_t start = line + 2;
+        if (strncasecmp(request.c_str() + start, name, nameLen) != 0 || request[start + nameLen] != ':') continue;
+        size_t end = request.find("\r\n", start);
+        return request.substr(start + nameLen + 1, end - start - nameLen - 1);
+    }
+    return std::string();
+}
+
+std::string reply(const char* status, const char* type, const std::string& body, bool gzip) {
+    char head[256];
+    snprintf(head, sizeof(head), "HTTP/1.1 %s\r\nContent-Type: %s\r\n%sContent-Length: %u\r\nConnection: close\r\n\r\n",
+             status, type, gzip ? "Content-Encoding: gzip\r\n" : "", (unsigned)body.size());
+    return head + body;
+}
+
+} // namespace
+
+std::string gzipCompress(const std::string& data) {
+    z_stream z = {};
+    deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&z, data.size()), '\0');
+    z.next_in = (Bytef*)data.data();
+    z.avail_in = (uInt)data.size();
+    z.next_out = (Bytef*)&out[0];
+    z.avail_out = (uInt)out.size();
+    deflate(&z, Z_FINISH);
+    out.resize(z.total_out);
+    deflateEnd(&z);
+    return out;
+}
+
+bool ReplayServer::load(const std::string& dir) {
+    static const char* const names[] = {"forecast.json", "forecast.fb", "air-quality.json", "air-quality.fb",
+                                        "update.txt"};
+    for (const char* name : names) {
+        if (!readFile(dir + "/" + name, fixtures_[name])) {
+            fprintf(stderr, "replay: missing fixture %s/%s\n", dir.c_str(), name);
+            return false;
+        }
+    }
+    return true;
+}
+
+host::Reply ReplayServer::operator()(const std::string& request) {
+    requests_++;
+    host::Reply r;
+
+    // "GET /v1/forecast?...&format=flatbuffers HTTP/1.0"
+    size_t pathStart = request.find(' ') + 1;
+    size_t pathEnd = request.find_first_of(" ?", pathStart);
+    std::string path = request.substr(pathStart, pathEnd - pathStart);
+    std::string endpoint = path.substr(path.rfind('/') + 1);
+    size_t lineEnd = request.find("\r\n");
+    bool flat = request.substr(0, lineEnd).find("format=flatbuffers") != std::string::npos;
+    bool gzip = gzip_ && headerValue(request, "Accept-Encoding").find("gzip") != std::string::npos;
+
+    if (endpoint == "update") {
+        r.bytes = reply("200 OK", "text/plain", fixtures_["update.txt"], false);
+        return r;
+    }
+    auto it = fixtures_.find(endpoint + (flat ? ".fb" : ".json"));
+    if (it == fixtures_.end()) {
+        r.bytes = reply("404 Not Found", "text/plain", std::string(), false);
+        return r;
+    }
+
+    Fault fault = faultsOn_ ? faults_.next() : Fault::None;
+    std::string body = it->second;
+    if (fault == Fault::Malformed) {
+        // A JSON separator, or the FlatBuffers size prefix
+        size_t at = flat ? 0 : body.find(':');
+        if (at != std::string::npos) body[at] = flat ? '\x7f' : '=';
+    }
+    if (fault == Fault::ServerError) {
+        r.bytes = reply("503 Service Unavailable", "text/plain", std::string(), false);
+        return r;
+    }
+    if (gzip) body = gzipCompress(body);
+    r.bytes = reply("200 OK", flat ? "application/octet-stream" : "application/json", body, gzip);
+    size_t headers = r.bytes.size() - body.size();
+
+    switch (fault) {
+        case Fault::Slow:
+            r.delayMs = FAULT_SLOW_MS;
+            break;
+        case Fault::Truncated:
+            r.cutAt = headers + body.size() / 2;
+            r.resetAtCut = true;
+            break;
+        case Fault::Reset:
+            r.cutAt = headers;
+            r.resetAtCut = true;
+            break;
+        default:
+            break;
+    }
+    return r;
+}
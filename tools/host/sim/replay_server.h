@@ -0,0 +1,55 @@
+#pragma once
+
+// ==========================================
+// REPLAY SERVER
+// ==========================================
+// In-process stand-in for Open-Meteo and ThingSpeak (host::serve()): answers
+// every request from recorded responses in a fixture directory, named after
+// the last path segment and the format asked for:
+//
+//   forecast.json  forecast.fb  air-quality.json  air-quality.fb  update.txt
+//
+// Bodies are gzip-compressed when the request accepts it, as the real API
+// does, unless serveGzip(false) (the baseline, like api_standin.py --plain). With faults enabled every Open-Meteo request draws from the
+// FaultInjector schedule (fault_injection.h) and the reply is broken
+// accordingly: delayed, cut short, corrupted, a 503 or a reset. The same
+// schedule is in tools/api_standin.py --faults, for the board.
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+#include "host.h"
+#include "fault_injection.h"
+
+class ReplayServer {
+public:
+    // Loads every fixture in dir; false (with the reason on stderr) if one
+    // the firmware needs is missing
+    bool load(const std::string& dir);
+
+    void enableFaults(uint32_t seed) {
+        faults_ = FaultInjector(seed);
+        faultsOn_ = true;
+    }
+
+    void serveGzip(bool on) { gzip_ = on; }
+
+    // Replaces a loaded fixture's body, e.g. to make it larger
+    void setFixture(const std::string& name, const std::string& body) { fixtures_[name] = body; }
+
+    host::Reply operator()(const std::string& request);
+
+    uint32_t requests() const { return requests_; }
+    const FaultInjector& faults() const { return faults_; }
+
+private:
+    std::map<std::string, std::string> fixtures_;    // "forecast.json" -> body
+    FaultInjector faults_;
+    bool faultsOn_ = false;
+    bool gzip_ = true;
+    uint32_t requests_ = 0;
+};
+
+// gzip (RFC 1952) of data at zlib's default level
+std::string gzipCompress(const std::string& data);
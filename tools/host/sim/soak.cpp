@@ -0,0 +1,141 @@
+// ==========================================
+// SOAK
+// ==========================================
+// Host soak of the firmware's sync cycle: src/main.cpp runs unchanged on a
+// virtual clock against the replay server with faults enabled, so every
+// Open-Meteo request draws from the FaultInjector schedule (slow, truncated,
+// malformed, 503, reset). Weeks of bad connectivity take minutes. Every
+// --report cycles it prints
+//
+//   the worst cycle and the longest watchdog gap against the timeout
+//   failed requests and parse errors next to the faults injected
+//   free heap, lowest free heap and largest block of the heap model, i.e.
+//   leaks (free heap drifting down) and fragmentation (largest block
+//   shrinking at steady free heap)
+//
+// and exits nonzero if the watchdog would have reset the board, an
+// allocation failed, or a cycle never finished.
+//
+//   soak [-n cycles] [-i interval ms] [--seed n] [--report cycles]
+//        [--rtt ms] [--rate bytes/ms] [--fixtures dir] [-v]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+
+#include "firmware.h"
+#include "host.h"
+
+namespace {
+
+void report(const ReplayServer& replay, const host::HeapStats& first, uint64_t hostMs) {
+    host::HarnessScope scope;
+    const host::WdtStats& wdt = host::wdtStats();
+    const host::HeapStats heap = host::heapStats();
+    const FaultInjector& f = replay.faults();
+    printf("[SOAK] %u cycles (%.1f days simulated, %.1f s here), worst cycle %u ms, worst WDT gap %u of %u ms, "
+           "trips %u\n",
+           (unsigned)syncStats.cycles, host::nowMicros() / 86400e6, hostMs / 1000.0,
+           (unsigned)syncStats.maxDurationMs, (unsigned)wdt.maxGapMs, (unsigned)wdt.timeoutMs, (unsigned)wdt.trips);
+    printf("[SOAK] requests %u, failed %u, parse errors %u; injected: slow %u, truncated %u, malformed %u, "
+           "5xx %u, reset %u\n",
+           (unsigned)replay.requests(), (unsigned)syncStats.failedRequests, (unsigned)syncStats.parseErrors,
+           (unsigned)f.injected(Fault::Slow), (unsigned)f.injected(Fault::Truncated),
+           (unsigned)f.injected(Fault::Malformed), (unsigned)f.injected(Fault::ServerError),
+           (unsigned)f.injected(Fault::Reset));
+    if (heap.size) {
+        printf("[SOAK] heap free %zu (first %zu, min %zu), largest block %zu (first %zu), fragmentation %u%%, "
+               "failed %u\n",
+               heap.free, first.free, heap.minFree, heap.largestFree, first.largestFree,
+               (unsigned)(100 - heap.largestFree * 100 / heap.free), (unsigned)heap.failed);
+    }
+    fflush(stdout);
+}
+
+uint64_t hostMillis() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int usage() {
+    fprintf(stderr, "usage: soak [-n cycles] [-i interval ms] [--seed n] [--report cycles]\n"
+                    "            [--rtt ms] [--rate bytes/ms] [--fixtures dir] [-v]\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t cycles = 1000000;
+    long interval = 2000;
+    uint32_t seed = 1;
+    uint32_t every = 100000;
+    host::Link link;
+    link.rttMs = 50;
+    std::string fixtures = sim::defaultFixtures();
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!strcmp(a, "-v")) { verbose = true; continue; }
+        if (!v) return usage();
+        if (!strcmp(a, "-n")) cycles = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "-i")) interval = strtol(v, nullptr, 10);
+        else if (!strcmp(a, "--seed")) seed = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "--report")) every = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "--rtt")) link.rttMs = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "--rate")) link.bytesPerMs = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "--fixtures")) fixtures = v;
+        else return usage();
+        i++;
+    }
+    if (!cycles || !every || interval < 0) return usage();
+
+    // Time zone data and stdio buffers are loaded once, before the device heap
+    tzset();
+    time_t now = time(nullptr);
+    struct tm t;
+    localtime_r(&now, &t);
+
+    ReplayServer replay;
+    if (!replay.load(fixtures)) return 1;
+    replay.enableFaults(seed);
+    host::useVirtualClock(true);
+    host::setLink(link);
+    sim::serveApis(replay);
+    host::setSerialOutput(verbose);
+    updateInterval = interval;
+    cyclicFromCache = false;
+
+    host::useDeviceHeap(true);
+    uint64_t hostStart = hostMillis();
+    setup();
+    // Every request of a cycle running into its timeout, with room to spare
+    const uint32_t cycleTimeout = updateInterval + 300000;
+    if (!sim::runUntilCycle(1, cycleTimeout)) {
+        fprintf(stderr, "soak: no boot sync\n");
+        return 1;
+    }
+    const host::HeapStats first = host::heapStats();
+
+    while (syncStats.cycles < cycles) {
+        if (!sim::runUntilCycle(syncStats.cycles + 1, cycleTimeout)) {
+            fprintf(stderr, "soak: cycle %u did not finish\n", (unsigned)syncStats.cycles + 1);
+            report(replay, first, hostMillis() - hostStart);
+            return 1;
+        }
+        if (syncStats.cycles % every == 0) report(replay, first, hostMillis() - hostStart);
+    }
+    if (syncStats.cycles % every != 0) report(replay, first, hostMillis() - hostStart);
+
+    const host::WdtStats& wdt = host::wdtStats();
+    const host::HeapStats heap = host::heapStats();
+    if (wdt.trips) fprintf(stderr, "soak: %u watchdog resets\n", (unsigned)wdt.trips);
+    if (heap.failed) fprintf(stderr, "soak: %u allocations failed\n", (unsigned)heap.failed);
+    return wdt.trips || heap.failed ? 1 : 0;
+}
@@ -0,0 +1,127 @@
+// ==========================================
+// SWIPE BENCH
+// ==========================================
+// Host run of the threaded draw path the board uses: LVGL with its OS layer
+// (pthreads here, FreeRTOS on the board) and LV_DRAW_SW_DRAW_UNIT_CNT draw
+// threads. Built as swipe_bench_draw1 and swipe_bench_draw2 for one and two
+// draw units, and as swipe_bench_tsan (two units) under ThreadSanitizer.
+//
+// src/main.cpp's loop() runs on its own thread, as the Arduino loop task
+// does: it renders, syncs against the replay server every -i ms and updates
+// the clock and the readings under LvglLock. Meanwhile the main thread
+// swipes to the next tab every -p ms (animated), holding the LVGL lock the
+// way an input callback would. Reported: render time per frame, from
+// LV_EVENT_REFR_START to LV_EVENT_REFR_READY, over the whole run.
+//
+// Times are this machine's wall clock: compare draw1 with draw2, never with
+// the ESP32, and never the tsan build's.
+//
+//   swipe_bench [-n swipes] [-p period ms] [-i sync interval ms] [--fixtures dir] [-v]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "firmware.h"
+#include "host.h"
+
+namespace {
+
+std::atomic<bool> running(true);
+
+// Written by whichever thread runs lv_timer_handler() (the loop thread),
+// read once it has been joined
+uint64_t frameStart = 0;
+std::vector<uint32_t> frameUs;
+
+void onRefresh(lv_event_t* e) {
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        frameStart = host::nowMicros();
+        return;
+    }
+    frameUs.push_back(host::nowMicros() - frameStart);
+}
+
+uint32_t pct(const std::vector<uint32_t>& sorted, unsigned p) {
+    return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, sorted.size() * p / 100)];
+}
+
+int usage() {
+    fprintf(stderr, "usage: swipe_bench [-n swipes] [-p period ms] [-i sync interval ms] [--fixtures dir] [-v]\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t swipes = 60;
+    uint32_t periodMs = 250;
+    long interval = 1000;
+    std::string fixtures = sim::defaultFixtures();
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!strcmp(a, "-v")) { verbose = true; continue; }
+        if (!v) return usage();
+        if (!strcmp(a, "-n")) swipes = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "-p")) periodMs = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "-i")) interval = strtol(v, nullptr, 10);
+        else if (!strcmp(a, "--fixtures")) fixtures = v;
+        else return usage();
+        i++;
+    }
+    if (!swipes || !periodMs) return usage();
+
+    tzset();
+    ReplayServer replay;
+    if (!replay.load(fixtures)) return 1;
+    sim::serveApis(replay);
+    host::setSerialOutput(verbose);
+    updateInterval = interval;
+    cyclicFromCache = false;        // every sync fetches and redraws the readings
+
+    setup();
+    {
+        lv_lock();
+        lv_display_t* disp = lv_display_get_default();
+        lv_display_add_event_cb(disp, onRefresh, LV_EVENT_REFR_START, nullptr);
+        lv_display_add_event_cb(disp, onRefresh, LV_EVENT_REFR_READY, nullptr);
+        lv_unlock();
+    }
+
+    std::thread loopTask([] {
+        while (running) loop();
+    });
+    for (uint32_t i = 0; i < swipes; i++) {
+        lv_lock();
+        uint32_t next = (lv_tabview_get_tab_active(tabView) + 1) % TAB_COUNT;
+        lv_tabview_set_active(tabView, next, LV_ANIM_ON);
+        lv_obj_send_event(tabView, LV_EVENT_VALUE_CHANGED, nullptr);
+        lv_unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(periodMs));
+    }
+    running = false;
+    loopTask.join();
+
+    std::vector<uint32_t> sorted(frameUs);
+    std::sort(sorted.begin(), sorted.end());
+    uint64_t total = 0;
+    for (uint32_t us : sorted) total += us;
+    printf("swipe_bench: %d draw unit(s), %u swipes every %u ms, %u syncs, %zu frames\n",
+           LV_DRAW_SW_DRAW_UNIT_CNT, (unsigned)swipes, (unsigned)periodMs, (unsigned)syncStats.cycles,
+           sorted.size());
+    printf("  %-12s %8s %8s %8s %8s\n", "frame us", "p50", "p95", "max", "mean");
+    printf("  %-12s %8u %8u %8u %8.0f\n", "", (unsigned)pct(sorted, 50), (unsigned)pct(sorted, 95),
+           sorted.empty() ? 0u : (unsigned)sorted.back(), sorted.empty() ? 0.0 : (double)total / sorted.size());
+    return syncStats.cycles > 0 && !sorted.empty() && syncStats.parseErrors == 0 ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+// ==========================================
+// SYNC BENCH
+// ==========================================
+// Host benchmark of the firmware's sync cycle: src/main.cpp runs unchanged
+// against the stand-ins, fetching from recorded responses (replay_server.h)
+// over a modelled link, on a virtual clock. Per cycle it reports
+//
+//   cpu us      host CPU time of the loop() pass that ran syncData()
+//   cycle ms    syncData()'s own duration on the virtual clock, i.e. the
+//               link model's round trips and transfer time plus timeouts
+//   allocs / B  malloc calls and bytes from the device heap model
+//   rx / tx B   bytes on the wire, headers included
+//   radio ms    API requests from GET to the last body byte parsed
+//               (transferMs), i.e. the time the radio is kept busy
+//   uplink B    bytes the uplink wrote for the sample (ThingSpeak GET)
+//   upload ms   time the upload step held loop()
+//   pixels      flushed to the panel since the previous cycle
+//
+// and the heap model's free heap and largest block after the run. The
+// first cycle (boot sync, first-time allocations) is reported on its own.
+// CPU time is this machine's: compare builds with each other, never with
+// the ESP32. Cycles within the cell cache's 15 minutes reuse the cached
+// readings and only upload; -i 900000 makes every cycle fetch. --plain
+// answers without gzip, the baseline for GZIP_RESPONSES (compare rx B,
+// radio ms and the inflater's heap). With --server the firmware talks real
+// TCP to that server (e.g. tools/api_standin.py) on the real clock instead.
+//
+//   sync_bench [-n cycles] [-i interval ms] [--rtt ms] [--rate bytes/ms]
+//              [--fixtures dir] [--plain] [--server host:port] [-v]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "firmware.h"
+#include "host.h"
+
+namespace {
+
+struct Series {
+    std::vector<uint64_t> v;
+
+    uint64_t pct(unsigned p) const {
+        if (v.empty()) return 0;
+        std::vector<uint64_t> s(v);
+        std::sort(s.begin(), s.end());
+        return s[std::min(s.size() - 1, (s.size() * p + 99) / 100 - (p ? 1 : 0))];
+    }
+    double mean() const {
+        uint64_t sum = 0;
+        for (uint64_t x : v) sum += x;
+        return v.empty() ? 0 : (double)sum / v.size();
+    }
+};
+
+void row(const char* name, const Series& s) {
+    printf("  %-12s %10llu %10llu %10llu %12.1f\n", name, (unsigned long long)s.pct(50),
+           (unsigned long long)s.pct(95), (unsigned long long)s.pct(100), s.mean());
+}
+
+int usage() {
+    fprintf(stderr, "usage: sync_bench [-n cycles] [-i interval ms] [--rtt ms] [--rate bytes/ms]\n"
+                    "                  [--fixtures dir] [--plain] [--server host:port] [-v]\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t cycles = 100;
+    long interval = -1;
+    host::Link link;
+    link.rttMs = 50;
+    std::string fixtures = sim::defaultFixtures();
+    const char* server = nullptr;
+    bool verbose = false;
+    bool plain = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!strcmp(a, "-v")) { verbose = true; continue; }
+        if (!strcmp(a, "--plain")) { plain = true; continue; }
+        if (!v) return usage();
+        if (!strcmp(a, "-n")) cycles = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "-i")) interval = strtol(v, nullptr, 10);
+        else if (!strcmp(a, "--rtt")) link.rttMs = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "--rate")) link.bytesPerMs = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "--fixtures")) fixtures = v;
+        else if (!strcmp(a, "--server")) server = v;
+        else return usage();
+        i++;
+    }
+    if (!cycles) return usage();
+
+    // Time zone data and stdio buffers are loaded once, before the device heap
+    tzset();
+    time_t now = time(nullptr);
+    struct tm t;
+    localtime_r(&now, &t);
+
+    ReplayServer replay;
+    if (server) {
+        sim::useServer(server);
+    } else {
+        if (!replay.load(fixtures)) return 1;
+        replay.serveGzip(!plain);
+        host::useVirtualClock(true);
+        host::setLink(link);
+        sim::serveApis(replay);
+    }
+    host::setSerialOutput(verbose);
+    if (interval >= 0) updateInterval = interval;
+
+    host::useDeviceHeap(true);
+    setup();
+    // Generous: covers every request running into its timeout
+    const uint32_t cycleTimeout = updateInterval + 120000;
+    if (!sim::runUntilCycle(1, cycleTimeout)) {
+        fprintf(stderr, "sync_bench: no boot sync\n");
+        return 1;
+    }
+    const SyncStats boot = syncStats;
+    const host::HeapStats heapBoot = host::heapStats();
+    const host::NetStats netBoot = host::netStats();
+
+    Series cpu, cycleMs, allocs, allocBytes, rx, tx, radioMs, uplinkB, uploadMs, pixels;
+    while (syncStats.cycles < cycles + 1) {
+        uint32_t target = syncStats.cycles + 1;
+        uint32_t start = millis();
+        uint64_t cpuStart = 0;
+        host::HeapStats h0 = {};
+        host::NetStats n0 = {};
+        uint64_t px0 = host::displayStats().pixels;     // the whole interval: LVGL draws after the sync
+        uint32_t radio0 = syncStats.transferMs;
+        uint32_t uplink0 = syncStats.uplinkBytes;
+        while (syncStats.cycles < target) {
+            if (millis() - start > cycleTimeout) {
+                fprintf(stderr, "sync_bench: cycle %u did not finish\n", (unsigned)target);
+                return 1;
+            }
+            h0 = host::heapStats();
+            n0 = host::netStats();
+            cpuStart = sim::cpuMicros();
+            loop();
+        }
+        host::HarnessScope scope;
+        cpu.v.push_back(sim::cpuMicros() - cpuStart);
+        cycleMs.v.push_back(syncStats.lastDurationMs);
+        host::HeapStats h1 = host::heapStats();
+        const host::NetStats& n1 = host::netStats();
+        allocs.v.push_back(h1.allocations - h0.allocations);
+        allocBytes.v.push_back(h1.bytesAllocated - h0.bytesAllocated);
+        rx.v.push_back(n1.bytesReceived - n0.bytesReceived);
+        tx.v.push_back(n1.bytesSent - n0.bytesSent);
+        radioMs.v.push_back(syncStats.transferMs - radio0);
+        uplinkB.v.push_back(syncStats.uplinkBytes - uplink0);
+        uploadMs.v.push_back(syncStats.lastUploadMs);
+        pixels.v.push_back(host::displayStats().pixels - px0);
+    }
+
+    host::HarnessScope scope;
+    const host::HeapStats heap = host::heapStats();
+    const host::NetStats& net = host::netStats();
+    if (server) printf("sync_bench: %u cycles against %s (real clock)\n", (unsigned)cycles, server);
+    else printf("sync_bench: %u cycles against %s, link rtt %u ms, %s\n", (unsigned)cycles, fixtures.c_str(),
+                (unsigned)link.rttMs, link.bytesPerMs ? (std::to_string(link.bytesPerMs) + " B/ms").c_str() : "unlimited rate");
+    printf("boot sync: %u ms, %u requests, rx %llu B, tx %llu B, %llu allocations\n",
+           (unsigned)boot.lastDurationMs, (unsigned)boot.requests, (unsigned long long)netBoot.bytesReceived,
+           (unsigned long long)netBoot.bytesSent, (unsigned long long)heapBoot.allocations);
+    printf("  %-12s %10s %10s %10s %12s\n", "per cycle", "p50", "p95", "max", "mean");
+    row("cpu us", cpu);
+    row("cycle ms", cycleMs);
+    row("allocs", allocs);
+    row("alloc B", allocBytes);
+    row("rx B", rx);
+    row("tx B", tx);
+    row("radio ms", radioMs);
+    row("uplink B", uplinkB);
+    row("upload ms", uploadMs);
+    row("pixels", pixels);
+    printf("requests %u, failed %u, parse errors %u, cache hits %u, connections %u\n",
+           (unsigned)(syncStats.requests - boot.requests), (unsigned)(syncStats.failedRequests - boot.failedRequests),
+           (unsigned)(syncStats.parseErrors - boot.parseErrors), (unsigned)syncStats.cacheHits,
+           (unsigned)net.connections);
+    printf("gzip responses %u, fallbacks to identity %u, inflater heap %u B, decoded %u of %u B received\n",
+           (unsigned)(syncStats.gzipResponses - boot.gzipResponses), (unsigned)(syncStats.gzipFallbacks - boot.gzipFallbacks),
+           (unsigned)syncStats.gzipHeapBytes, (unsigned)(syncStats.decodedBytes - boot.decodedBytes),
+           (unsigned)(syncStats.downloadBytes - boot.downloadBytes));
+    if (heap.size) {
+        printf("heap model: %zu B, free %zu (min %zu), largest block %zu (after boot %zu), failed %u\n",
+               heap.size, heap.free, heap.minFree, heap.largestFree, heapBoot.largestFree, (unsigned)heap.failed);
+    }
+    return syncStats.failedRequests == boot.failedRequests && syncStats.parseErrors == boot.parseErrors ? 0 : 1;
+}
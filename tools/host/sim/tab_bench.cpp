@@ -0,0 +1,142 @@
+// ==========================================
+// TAB BENCH
+// ==========================================
+// Host comparison of building every tab at boot (LAZY_TABS 0, built as
+// tab_bench_eager) with building each one when it is first shown
+// (LAZY_TABS 1, tab_bench). src/main.cpp boots and completes its first
+// sync against the replay server, then every tab is shown the way a tap
+// does it (active tab set, VALUE_CHANGED sent) and one frame is drawn.
+// Reported:
+//
+//   LVGL pool   bytes of LV_MEM_SIZE in use, and the peak so far, after the
+//               boot sync, once every tab was shown, and after 70 s on the
+//               SYSTEM tab (TAB_TEARDOWN_MS frees the hidden tabs)
+//   switch us   host CPU time from the tap to the drawn frame: the first
+//               visit (which builds the tab when lazy), then the median and
+//               worst of -r later visits
+//
+// Pool figures are LVGL's own allocator and carry over to the board; times
+// are this machine's, so only the ratio between the two builds means
+// anything. It fails if the build did not behave as its mode says: lazy
+// builds fewer than every tab at boot and grows the pool showing them,
+// eager builds all of them at boot.
+//
+//   tab_bench [-r rounds] [--fixtures dir] [-v]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "firmware.h"
+#include "host.h"
+
+#ifndef LAZY_TABS
+#define LAZY_TABS 1     // as src/main.cpp defaults it
+#endif
+
+namespace {
+
+struct Pool {
+    uint32_t used;
+    uint32_t peak;
+    uint32_t total;
+};
+
+Pool pool() {
+    lv_mem_monitor_t mem;
+    lv_mem_monitor(&mem);
+    return {mem.total_size - mem.free_size, mem.max_used, mem.total_size};
+}
+
+// Shows tab and draws the frame; host CPU microseconds it took
+uint64_t tap(size_t tab) {
+    uint64_t start = sim::cpuMicros();
+    lv_tabview_set_active(tabView, tab, LV_ANIM_OFF);
+    lv_obj_send_event(tabView, LV_EVENT_VALUE_CHANGED, nullptr);
+    host::advance(40);      // past LVGL's refresh period, so the frame is drawn
+    lv_timer_handler();
+    return sim::cpuMicros() - start;
+}
+
+void poolRow(const char* name, const Pool& p) {
+    printf("  %-18s %8u %8u\n", name, (unsigned)p.used, (unsigned)p.peak);
+}
+
+int usage() {
+    fprintf(stderr, "usage: tab_bench [-r rounds] [--fixtures dir] [-v]\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t rounds = 20;
+    std::string fixtures = sim::defaultFixtures();
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!strcmp(a, "-v")) { verbose = true; continue; }
+        if (!v) return usage();
+        if (!strcmp(a, "-r")) rounds = strtoul(v, nullptr, 10);
+        else if (!strcmp(a, "--fixtures")) fixtures = v;
+        else return usage();
+        i++;
+    }
+    if (!rounds) return usage();
+
+    tzset();
+    ReplayServer replay;
+    if (!replay.load(fixtures)) return 1;
+    host::useVirtualClock(true);
+    sim::serveApis(replay);
+    host::setSerialOutput(verbose);
+
+    setup();
+    if (!sim::runUntilCycle(1, 120000)) {
+        fprintf(stderr, "tab_bench: no boot sync\n");
+        return 1;
+    }
+    lv_timer_handler();
+    size_t builtAtBoot = std::count(tabBuilt, tabBuilt + TAB_COUNT, true);
+    const Pool boot = pool();
+
+    // SYSTEM is showing; visit the others, then come back to it
+    uint64_t first[TAB_COUNT];
+    for (size_t i = 1; i <= TAB_COUNT; i++) first[i % TAB_COUNT] = tap(i % TAB_COUNT);
+    std::vector<uint64_t> again[TAB_COUNT];
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (size_t i = 1; i <= TAB_COUNT; i++) again[i % TAB_COUNT].push_back(tap(i % TAB_COUNT));
+    }
+    const Pool shown = pool();
+
+    for (int s = 0; s < 70; s++) {
+        host::advance(1000);
+        lv_timer_handler();
+    }
+    size_t builtAfter = std::count(tabBuilt, tabBuilt + TAB_COUNT, true);
+    const Pool idle = pool();
+
+    printf("tab_bench: %zu tabs, %zu built at boot, %zu after 70 s on SYSTEM, LVGL pool %u B\n",
+           TAB_COUNT, builtAtBoot, builtAfter, (unsigned)boot.total);
+    printf("  %-18s %8s %8s\n", "LVGL pool", "used", "peak");
+    poolRow("after boot sync", boot);
+    poolRow("every tab shown", shown);
+    poolRow("70 s on SYSTEM", idle);
+    printf("  %-18s %8s %8s %8s\n", "switch to (us)", "first", "p50", "max");
+    for (size_t t = 0; t < TAB_COUNT; t++) {
+        std::sort(again[t].begin(), again[t].end());
+        printf("  %-18s %8llu %8llu %8llu\n", TAB_NAMES[t], (unsigned long long)first[t],
+               (unsigned long long)again[t][again[t].size() / 2], (unsigned long long)again[t].back());
+    }
+
+    bool asConfigured = LAZY_TABS ? builtAtBoot < TAB_COUNT && shown.used > boot.used : builtAtBoot == TAB_COUNT;
+    if (!asConfigured) fprintf(stderr, "tab_bench: LAZY_TABS %d, but %zu tabs built at boot\n", LAZY_TABS, builtAtBoot);
+    return asConfigured ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+// ==========================================
+// ARDUINO CORE STAND-IN
+// ==========================================
+// The part of the Arduino-ESP32 core that src/ uses, so the firmware builds
+// and runs on a PC (tools/host, [env:native]). Behaviour follows the ESP32
+// core where the firmware depends on it (Stream timeouts, String(float, n),
+// Print::printf); everything hardware-only is a no-op.
+//
+// Time comes from the host clock (host.h): real time by default, or a
+// virtual clock that only advances in delay() and while a read waits, so a
+// day of sync cycles runs in seconds. The hardware timer callback the
+// firmware uses for lv_tick_inc() is called as that clock advances.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+
+using std::min;
+using std::max;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define PROGMEM
+
+#define LOW    0x0
+#define HIGH   0x1
+#define INPUT  0x01
+#define OUTPUT 0x03
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define PI         3.1415926535897932384626433832795
+#define TWO_PI     6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+#define radians(deg) ((deg) * DEG_TO_RAD)
+#define degrees(rad) ((rad) * RAD_TO_DEG)
+#define sq(x) ((x) * (x))
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void yield();
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+// FreeRTOS critical sections: the host build runs on one thread
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux)  ((void)(mux))
+
+// ------------------------------------------
+// String
+// ------------------------------------------
+class String {
+public:
+    String(const char* s = "") : s_(s ? s : "") {}
+    String(const std::string& s) : s_(s) {}
+    explicit String(char c) : s_(1, c) {}
+    explicit String(unsigned char v, unsigned char base = 10) : String((unsigned long)v, base) {}
+    explicit String(int v, unsigned char base = 10) : String((long)v, base) {}
+    explicit String(unsigned int v, unsigned char base = 10) : String((unsigned long)v, base) {}
+    explicit String(long v, unsigned char base = 10);
+    explicit String(unsigned long v, unsigned char base = 10);
+    explicit String(float v, unsigned int decimals = 2) : String((double)v, decimals) {}
+    explicit String(double v, unsigned int decimals = 2);
+
+    unsigned int length() const { return (unsigned int)s_.size(); }
+    bool isEmpty() const { return s_.empty(); }
+    const char* c_str() const { return s_.c_str(); }
+    char operator[](unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+
+    String& operator+=(const String& s) { s_ += s.s_; return *this; }
+    String& operator+=(const char* s) { if (s) s_ += s; return *this; }
+    String& operator+=(char c) { s_ += c; return *this; }
+    bool concat(const char* s) { *this += s; return true; }
+
+    bool operator==(const String& o) const { return s_ == o.s_; }
+    bool operator==(const char* o) const { return s_ == (o ? o : ""); }
+    bool operator!=(const String& o) const { return s_ != o.s_; }
+    bool operator!=(const char* o) const { return !(*this == o); }
+    bool equalsIgnoreCase(const String& o) const;
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const char* s, unsigned int from = 0) const;
+    String substring(unsigned int from) const { return substring(from, length()); }
+    String substring(unsigned int from, unsigned int to) const;
+    void remove(unsigned int index) { if (index < s_.size()) s_.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < s_.size()) s_.erase(index, count); }
+    long toInt() const { return strtol(s_.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(s_.c_str(), nullptr); }
+
+    friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+    friend String operator+(const String& a, const char* b) { return String(a.s_ + (b ? b : "")); }
+    friend String operator+(const char* a, const String& b) { return String((a ? a : "") + b.s_); }
+    friend String operator+(const String& a, char c) { return String(a.s_ + c); }
+
+private:
+    std::string s_;
+};
+
+// ------------------------------------------
+// Print / Stream
+// ------------------------------------------
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+    // 0 = unknown (as for an ESP32 WiFiClient)
+    virtual int availableForWrite() { return 0; }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return printf("%d", v); }
+    size_t print(unsigned int v) { return printf("%u", v); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t print(unsigned long v) { return printf("%lu", v); }
+    size_t print(double v, int decimals = 2) { return printf("%.*f", decimals, v); }
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+
+    void setTimeout(unsigned long timeoutMs) { _timeout = timeoutMs; }
+    unsigned long getTimeout() const { return _timeout; }
+
+    // Waits up to the timeout for each byte, like the ESP32 core
+    virtual size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    String readString();
+
+protected:
+    int timedRead();
+
+    unsigned long _timeout = 1000;
+    unsigned long _startMillis = 0;
+};
+
+// ------------------------------------------
+// Serial ports
+// ------------------------------------------
+#define SERIAL_8N1 0x800001c
+
+class HardwareSerial;
+namespace host { void uartReceive(HardwareSerial& port, const std::string& bytes); }
+
+// Serial writes to stdout (host::setSerialOutput() silences it). Received
+// bytes only come from host::uartReceive(), which then runs the onReceive()
+// callback like the UART driver's event task.
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(int uart) : uart_(uart) {}
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1) {
+        (void)baud; (void)config; (void)rxPin; (void)txPin;
+    }
+    void onReceive(std::function<void(void)> callback) { onReceive_ = callback; }
+
+    int available() override { return (int)(rx_.size() - rxPos_); }
+    int read() override { return rxPos_ < rx_.size() ? (uint8_t)rx_[rxPos_++] : -1; }
+    int peek() override { return rxPos_ < rx_.size() ? (uint8_t)rx_[rxPos_] : -1; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+private:
+    friend void host::uartReceive(HardwareSerial& port, const std::string& bytes);
+
+    int uart_;
+    std::function<void(void)> onReceive_;
+    std::string rx_;
+    size_t rxPos_ = 0;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial2;
+
+// ------------------------------------------
+// Chip
+// ------------------------------------------
+// Heap figures come from the host heap model when it is linked in
+// (heap_model.cpp), else they are 0
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    [[noreturn]] void restart();
+};
+
+extern EspClass ESP;
+
+// ------------------------------------------
+// Hardware timer (Arduino-ESP32 2.x API)
+// ------------------------------------------
+struct hw_timer_t;
+hw_timer_t* timerBegin(uint8_t num, uint16_t divider, bool countUp);
+void timerAttachInterrupt(hw_timer_t* timer, void (*fn)(void), bool edge);
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarmValue, bool autoreload);
+void timerAlarmEnable(hw_timer_t* timer);
+
+// ------------------------------------------
+// Time
+// ------------------------------------------
+// The host's own clock and time zone; SNTP "syncs" at once
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
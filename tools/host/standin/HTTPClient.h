@@ -0,0 +1,59 @@
+#pragma once
+
+// ==========================================
+// HTTPCLIENT STAND-IN
+// ==========================================
+// The subset of the ESP32 HTTPClient the firmware uses: one GET per begin(),
+// status and headers read up front, the body left on the client for
+// getStream(). https:// URLs are sent as plain HTTP (the host build has no
+// TLS); only Content-Length bodies are understood, which is what the
+// firmware asks for with useHTTP10(true).
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <vector>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_NO_HTTP_SERVER      (-7)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+class HTTPClient {
+public:
+    HTTPClient() {}
+    ~HTTPClient() { end(); }
+
+    bool begin(WiFiClient& client, const String& url);
+    bool begin(const String& url);      // with a client of its own
+
+    void setConnectTimeout(int32_t ms) { connectTimeout_ = ms; }
+    void setTimeout(uint16_t ms) { timeout_ = ms; }
+    void setReuse(bool reuse) { (void)reuse; }
+    void useHTTP10(bool on) { http10_ = on; }
+    void addHeader(const String& name, const String& value);
+    void collectHeaders(const char* headerKeys[], const size_t count);
+
+    int GET();
+    int getSize() const { return size_; }
+    WiFiClient& getStream() { return *client_; }
+    String getString();
+    String header(const char* name) const;
+    void end();
+
+private:
+    bool readLine(std::string& line);
+
+    WiFiClient own_;
+    WiFiClient* client_ = nullptr;
+    String host_;
+    uint16_t port_ = 80;
+    String path_;
+    std::string extraHeaders_;
+    std::vector<std::pair<std::string, String>> collected_;
+    int32_t connectTimeout_ = 5000;
+    uint16_t timeout_ = 5000;
+    bool http10_ = false;
+    int size_ = -1;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+// ==========================================
+// PREFERENCES (NVS) STAND-IN
+// ==========================================
+// Namespaces of byte blobs in memory; they survive a "reboot" (setup()
+// called again) but not the process. host::clearNvs() erases everything.
+
+#include <Arduino.h>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end() { ns_ = nullptr; }
+
+    bool isKey(const char* key);
+    bool remove(const char* key);
+    bool clear();
+
+    size_t putUChar(const char* key, uint8_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return get(key, defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return get(key, defaultValue); }
+
+    size_t putBytes(const char* key, const void* value, size_t len);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+private:
+    template <typename T>
+    T get(const char* key, T defaultValue) {
+        T v;
+        return getBytes(key, &v, sizeof(v)) == sizeof(v) ? v : defaultValue;
+    }
+
+    void* ns_ = nullptr;
+    bool readOnly_ = false;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+// PubSubClient stand-in: enough for mqtt_uplink.h to compile; the host
+// build uses the ThingSpeak uplink
+#include <WiFi.h>
+
+class PubSubClient {
+public:
+    explicit PubSubClient(Client& client) { (void)client; }
+    bool connected() { return false; }
+};
@@ -0,0 +1,4 @@
+#pragma once
+
+// Arduino core header some libraries include directly (PubSubClient)
+#include <Arduino.h>
@@ -0,0 +1,17 @@
+#pragma once
+
+// TFT_eSPI stand-in: a headless 320x240 panel that counts what LVGL
+// flushes to it (host::displayStats()), in no time unless
+// host::setPanelTiming() says otherwise
+#include <Arduino.h>
+
+class TFT_eSPI {
+public:
+    void begin();
+    void setRotation(uint8_t r) { (void)r; }
+    void setSwapBytes(bool swap) { (void)swap; }
+    void startWrite() {}
+    void endWrite() {}
+    void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h) { (void)x; (void)y; (void)w; (void)h; }
+    void pushColors(uint16_t* data, uint32_t len, bool swap = true);
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+// TinyGPSPlus stand-in: never a fix, so the firmware uses its fallback
+// coordinates. gps_replay_test builds against the real library instead.
+#include <Arduino.h>
+
+class TinyGPSPlus {
+public:
+    struct Location {
+        bool isValid() const { return false; }
+        bool isUpdated() const { return false; }
+        double lat() const { return 0; }
+        double lng() const { return 0; }
+    };
+    struct Integer {
+        bool isValid() const { return false; }
+        uint32_t value() const { return 0; }
+    };
+
+    bool encode(char c) { (void)c; return false; }
+
+    Location location;
+    Integer satellites;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+// ==========================================
+// UPDATE (OTA WRITER) STAND-IN
+// ==========================================
+// Writes into the fake flash's inactive app slot (host::flash()); end(true)
+// makes that slot the boot slot. Like the real writer, an image that does
+// not start with the ESP32 image magic byte is refused on the first write.
+
+#include <Arduino.h>
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+class UpdateClass {
+public:
+    bool begin(size_t size = UPDATE_SIZE_UNKNOWN);
+    size_t write(uint8_t* data, size_t len);
+    bool end(bool evenIfRemaining = false);
+    void abort();
+    const char* errorString() const { return error_; }
+
+private:
+    bool active_ = false;
+    const char* error_ = "No Error";
+};
+
+extern UpdateClass Update;
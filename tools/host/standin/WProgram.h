@@ -0,0 +1,5 @@
+#pragma once
+
+// Pre-1.0 Arduino core header, still included by some libraries (TinyGPSPlus)
+// when ARDUINO is not defined
+#include <Arduino.h>
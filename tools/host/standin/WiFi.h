@@ -0,0 +1,108 @@
+#pragma once
+
+// ==========================================
+// WIFI STAND-IN
+// ==========================================
+// WiFiClient connects to an in-process handler (host::serve), an in-process
+// stream server (host::serveStream) or a real TCP socket; WiFiServer accepts connections made with host::dial().
+// Clients are cheap handles to a shared connection, copyable like the
+// ESP32 core's.
+
+#include <Arduino.h>
+#include <memory>
+
+typedef enum {
+    WL_IDLE_STATUS     = 0,
+    WL_NO_SSID_AVAIL   = 1,
+    WL_CONNECTED       = 3,
+    WL_CONNECT_FAILED  = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED    = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+typedef enum { WIFI_POWER_19_5dBm = 78, WIFI_POWER_11dBm = 44, WIFI_POWER_2dBm = 8 } wifi_power_t;
+
+class IPAddress {
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes_{a, b, c, d} {}
+    uint8_t operator[](int i) const { return bytes_[i]; }
+    uint8_t& operator[](int i) { return bytes_[i]; }
+    String toString() const;
+
+private:
+    uint8_t bytes_[4] = {0, 0, 0, 0};
+};
+
+namespace host { class Socket; }
+
+class Client : public Stream {
+public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char* host, uint16_t port) = 0;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t size) = 0;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int read(uint8_t* buf, size_t size) = 0;
+    virtual int peek() = 0;
+    virtual void flush() = 0;
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+    using Print::write;
+};
+
+class WiFiClient : public Client {
+public:
+    WiFiClient() {}
+    explicit WiFiClient(std::shared_ptr<host::Socket> socket) : socket_(socket) {}
+
+    int connect(IPAddress ip, uint16_t port) override;
+    virtual int connect(IPAddress ip, uint16_t port, int32_t timeoutMs);
+    int connect(const char* host, uint16_t port) override;
+    virtual int connect(const char* host, uint16_t port, int32_t timeoutMs);
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t size) override;
+    int availableForWrite() override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() { return connected(); }
+    using Print::write;
+
+private:
+    std::shared_ptr<host::Socket> socket_;
+};
+
+class WiFiServer {
+public:
+    explicit WiFiServer(uint16_t port = 80) : port_(port) {}
+    ~WiFiServer();
+
+    void begin();
+    void end();
+    WiFiClient available();     // next pending connection, or an unconnected client
+
+private:
+    uint16_t port_;
+    bool listening_ = false;
+};
+
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t mode) { (void)mode; return true; }
+    bool setTxPower(wifi_power_t power) { (void)power; return true; }
+    wl_status_t begin(const char* ssid, const char* password = nullptr);
+    wl_status_t status();
+    int hostByName(const char* host, IPAddress& result);
+    int8_t RSSI() { return -60; }
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,17 @@
+#pragma once
+
+// XPT2046 stand-in: a touch panel nobody touches
+#include <SPI.h>
+
+struct TS_Point {
+    int16_t x, y, z;
+};
+
+class XPT2046_Touchscreen {
+public:
+    explicit XPT2046_Touchscreen(uint8_t cs, uint8_t tirq = 255) { (void)cs; (void)tirq; }
+    bool begin(SPIClass& spi) { (void)spi; return true; }
+    void setRotation(uint8_t r) { (void)r; }
+    bool touched() { return false; }
+    TS_Point getPoint() { return TS_Point{0, 0, 0}; }
+};
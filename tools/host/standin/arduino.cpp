@@ -0,0 +1,429 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include <TFT_eSPI.h>
+#include <esp_task_wdt.h>
+#include <esp_sntp.h>
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "host.h"
+
+// ==========================================
+// CLOCK AND TIMERS
+// ==========================================
+struct hw_timer_t {
+    void (*fn)(void);
+    uint64_t periodUs;
+    uint64_t nextUs;
+    bool enabled;
+};
+
+namespace {
+
+bool virtualMode = false;
+uint64_t virtualUs = 0;
+const auto realStart = std::chrono::steady_clock::now();
+
+hw_timer_t timers[4];
+std::recursive_mutex firingTimers;     // one "interrupt" at a time, whichever thread polls
+
+uint64_t clockUs() {
+    if (virtualMode) return virtualUs;
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - realStart).count();
+}
+
+// "Interrupts": every timer period that has elapsed since the last check
+void fireTimers(uint64_t now) {
+    std::unique_lock<std::recursive_mutex> lock(firingTimers, std::try_to_lock);
+    static bool firing = false;
+    if (!lock.owns_lock() || firing) return;
+    firing = true;
+    for (hw_timer_t& t : timers) {
+        if (!t.enabled || !t.fn || !t.periodUs) continue;
+        // After a long jump run at most one period's worth of catch-up calls per 1000
+        if (now > t.nextUs + 1000 * t.periodUs) t.nextUs = now - 1000 * t.periodUs;
+        while (t.nextUs <= now) {
+            t.fn();
+            t.nextUs += t.periodUs;
+        }
+    }
+    firing = false;
+}
+
+} // namespace
+
+namespace host {
+
+void useVirtualClock(bool on) {
+    if (on && !virtualMode) virtualUs = clockUs();
+    virtualMode = on;
+}
+
+bool virtualClock() { return virtualMode; }
+
+void advance(uint32_t ms) {
+    if (virtualMode) virtualUs += (uint64_t)ms * 1000;
+    else std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    fireTimers(clockUs());
+}
+
+uint64_t nowMicros() { return clockUs(); }
+
+} // namespace host
+
+unsigned long millis() {
+    uint64_t now = clockUs();
+    fireTimers(now);
+    return (unsigned long)(uint32_t)(now / 1000);
+}
+
+unsigned long micros() {
+    uint64_t now = clockUs();
+    fireTimers(now);
+    return (unsigned long)(uint32_t)now;
+}
+
+void delay(uint32_t ms) { host::advance(ms); }
+
+// Called while a read waits: on the virtual clock waiting is what moves time
+void yield() {
+    if (virtualMode) host::advance(1);
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+void digitalWrite(uint8_t pin, uint8_t value) { (void)pin; (void)value; }
+
+hw_timer_t* timerBegin(uint8_t num, uint16_t divider, bool countUp) {
+    (void)countUp;
+    hw_timer_t& t = timers[num & 3];
+    t = hw_timer_t{nullptr, 0, 0, false};
+    t.periodUs = divider;       // ticks of 80 MHz / divider, scaled in timerAlarmWrite()
+    return &t;
+}
+
+void timerAttachInterrupt(hw_timer_t* timer, void (*fn)(void), bool edge) {
+    (void)edge;
+    timer->fn = fn;
+}
+
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarmValue, bool autoreload) {
+    (void)autoreload;
+    timer->periodUs = alarmValue * timer->periodUs / 80;
+}
+
+void timerAlarmEnable(hw_timer_t* timer) {
+    timer->nextUs = clockUs() + timer->periodUs;
+    timer->enabled = timer->periodUs != 0;
+}
+
+// ==========================================
+// TIME
+// ==========================================
+namespace {
+sntp_sync_time_cb_t sntpCallback = nullptr;
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char* server2,
+                const char* server3) {
+    (void)gmtOffsetSec; (void)daylightOffsetSec; (void)server1; (void)server2; (void)server3;
+    if (sntpCallback) {
+        struct timeval tv;
+        gettimeofday(&tv, nullptr);
+        sntpCallback(&tv);
+    }
+}
+
+bool getLocalTime(struct tm* info, uint32_t ms) {
+    (void)ms;
+    time_t now = time(nullptr);
+    return localtime_r(&now, info) != nullptr;
+}
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback) { sntpCallback = callback; }
+void sntp_restart() {}
+
+// ==========================================
+// WATCHDOG
+// ==========================================
+namespace {
+host::WdtStats wdt = {0, 0, 0};
+uint64_t lastFeedUs = 0;
+}
+
+esp_err_t esp_task_wdt_init(uint32_t timeoutSec, bool panic) {
+    (void)panic;
+    wdt.timeoutMs = timeoutSec * 1000;
+    lastFeedUs = clockUs();
+    return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_add(void* task) {
+    (void)task;
+    lastFeedUs = clockUs();
+    return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_reset() {
+    uint64_t now = clockUs();
+    uint32_t gap = (uint32_t)((now - lastFeedUs) / 1000);
+    if (gap > wdt.maxGapMs) wdt.maxGapMs = gap;
+    if (wdt.timeoutMs && gap > wdt.timeoutMs) wdt.trips++;
+    lastFeedUs = now;
+    return ESP_OK;
+}
+
+const host::WdtStats& host::wdtStats() { return wdt; }
+
+// ==========================================
+// STRING
+// ==========================================
+String::String(long v, unsigned char base) {
+    char buf[34];
+    if (base == 10) snprintf(buf, sizeof(buf), "%ld", v);
+    else if (base == 16) snprintf(buf, sizeof(buf), "%lx", v);
+    else snprintf(buf, sizeof(buf), "%lo", v);
+    s_ = buf;
+}
+
+String::String(unsigned long v, unsigned char base) {
+    char buf[34];
+    if (base == 10) snprintf(buf, sizeof(buf), "%lu", v);
+    else if (base == 16) snprintf(buf, sizeof(buf), "%lx", v);
+    else snprintf(buf, sizeof(buf), "%lo", v);
+    s_ = buf;
+}
+
+String::String(double v, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+    s_ = buf;
+}
+
+bool String::equalsIgnoreCase(const String& o) const {
+    return s_.size() == o.s_.size() && strcasecmp(s_.c_str(), o.s_.c_str()) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t at = s_.find(c, from);
+    return at == std::string::npos ? -1 : (int)at;
+}
+
+int String::indexOf(const char* s, unsigned int from) const {
+    size_t at = s_.find(s, from);
+    return at == std::string::npos ? -1 : (int)at;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s_.size()) return String();
+    return String(s_.substr(from, to - from));
+}
+
+// ==========================================
+// PRINT / STREAM
+// ==========================================
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        if (!write(*buffer++)) break;
+        n++;
+    }
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char small[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(small)) return write((const uint8_t*)small, len);
+    std::vector<char> big(len + 1);
+    va_start(args, format);
+    vsnprintf(big.data(), big.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)big.data(), len);
+}
+
+int Stream::timedRead() {
+    _startMillis = millis();
+    do {
+        int c = read();
+        if (c >= 0) return c;
+        yield();
+    } while (millis() - _startMillis < _timeout);
+    return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead();
+        if (c < 0) break;
+        *buffer++ = (char)c;
+        count++;
+    }
+    return count;
+}
+
+String Stream::readString() {
+    std::string s;
+    int c;
+    while ((c = timedRead()) >= 0) s += (char)c;
+    return String(s);
+}
+
+// ==========================================
+// SERIAL
+// ==========================================
+namespace {
+bool serialOut = true;
+}
+
+void host::setSerialOutput(bool on) { serialOut = on; }
+
+size_t HardwareSerial::write(uint8_t c) { return write(&c, 1); }
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    host::HarnessScope scope;
+    if (uart_ == 0 && serialOut) fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+void host::uartReceive(HardwareSerial& port, const std::string& bytes) {
+    {
+        host::HarnessScope scope;
+        port.rx_.erase(0, port.rxPos_);
+        port.rxPos_ = 0;
+        port.rx_ += bytes;
+    }
+    if (port.onReceive_) port.onReceive_();
+}
+
+HardwareSerial Serial(0);
+HardwareSerial Serial2(2);
+
+// ==========================================
+// CHIP
+// ==========================================
+// Weak: replaced by heap_model.cpp when it is linked in
+__attribute__((weak)) host::HeapStats host::heapStats() { return host::HeapStats{}; }
+__attribute__((weak)) void host::useDeviceHeap(bool on) { (void)on; }
+
+namespace {
+int harnessDepth = 0;
+}
+
+host::HarnessScope::HarnessScope() { harnessDepth++; }
+host::HarnessScope::~HarnessScope() { harnessDepth--; }
+bool host::inHarness() { return harnessDepth > 0; }
+
+uint32_t EspClass::getFreeHeap() { return (uint32_t)host::heapStats().free; }
+uint32_t EspClass::getMinFreeHeap() { return (uint32_t)host::heapStats().minFree; }
+uint32_t EspClass::getMaxAllocHeap() { return (uint32_t)host::heapStats().largestFree; }
+
+namespace {
+bool throwOnRestart = false;
+}
+
+void host::catchRestart(bool on) { throwOnRestart = on; }
+
+void EspClass::restart() {
+    if (throwOnRestart) throw host::Restart();
+    fflush(stdout);
+    fprintf(stderr, "ESP.restart() called\n");
+    exit(3);
+}
+
+EspClass ESP;
+
+// ==========================================
+// DISPLAY
+// ==========================================
+namespace {
+constexpr uint32_t PANEL_PIXELS = 320 * 240;
+host::DisplayStats display = {0, 0, 0};
+uint32_t panelInitMs = 0;
+uint32_t panelSpiHz = 0;
+uint64_t spiNs = 0;             // transfer time not yet on the clock
+}
+
+void TFT_eSPI::begin() { delay(panelInitMs); }
+
+void TFT_eSPI::pushColors(uint16_t* data, uint32_t len, bool swap) {
+    (void)data; (void)swap;
+    display.flushes++;
+    display.pixels += len;
+    if (panelSpiHz) {
+        spiNs += len * 16ULL * 1000000000 / panelSpiHz;
+        delay(spiNs / 1000000);
+        spiNs %= 1000000;
+    }
+    if (!display.firstScreenMs && display.pixels >= PANEL_PIXELS) display.firstScreenMs = millis();
+}
+
+const host::DisplayStats& host::displayStats() { return display; }
+
+void host::setPanelTiming(uint32_t initMs, uint32_t spiHz) {
+    panelInitMs = initMs;
+    panelSpiHz = spiHz;
+}
+
+// ==========================================
+// NVS
+// ==========================================
+namespace {
+typedef std::map<std::string, std::vector<uint8_t>> NvsNamespace;
+std::map<std::string, NvsNamespace> nvs;
+}
+
+void host::clearNvs() { nvs.clear(); }
+
+// NVS lives in flash, not in the heap
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    host::HarnessScope scope;
+    ns_ = &nvs[name];
+    readOnly_ = readOnly;
+    return true;
+}
+
+bool Preferences::isKey(const char* key) {
+    return ns_ && static_cast<NvsNamespace*>(ns_)->count(key);
+}
+
+bool Preferences::remove(const char* key) {
+    return ns_ && !readOnly_ && static_cast<NvsNamespace*>(ns_)->erase(key);
+}
+
+bool Preferences::clear() {
+    if (!ns_ || readOnly_) return false;
+    static_cast<NvsNamespace*>(ns_)->clear();
+    return true;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    host::HarnessScope scope;
+    if (!ns_ || readOnly_) return 0;
+    const uint8_t* p = static_cast<const uint8_t*>(value);
+    (*static_cast<NvsNamespace*>(ns_))[key].assign(p, p + len);
+    return len;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    if (!ns_) return 0;
+    NvsNamespace& ns = *static_cast<NvsNamespace*>(ns_);
+    auto it = ns.find(key);
+    if (it == ns.end() || it->second.size() > maxLen) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
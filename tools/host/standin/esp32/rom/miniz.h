@@ -0,0 +1,94 @@
+#pragma once
+
+// ==========================================
+// ROM MINIZ STAND-IN
+// ==========================================
+// tinfl_decompress() on top of zlib's raw inflate, for GzipStream on the
+// host. Same contract as the ROM inflater for the way GzipStream calls it:
+// output goes to [next, next + size), a full output buffer reports
+// TINFL_STATUS_HAS_MORE_OUTPUT.
+//
+// The ROM decompressor keeps its ~11 KB state inside tinfl_decompressor,
+// which GzipStream mallocs; the struct here is padded to that size so the
+// host heap sees the same cost. zlib's own state and 32 KB window live in a
+// static arena outside that heap, rewound by every tinfl_init() - the
+// firmware never runs two inflaters at once.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <zlib.h>
+
+#define TINFL_LZ_DICT_SIZE 32768
+
+enum {
+    TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+    TINFL_FLAG_HAS_MORE_INPUT = 2,
+    TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+    TINFL_FLAG_COMPUTE_ADLER32 = 8
+};
+
+typedef enum {
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+constexpr size_t TINFL_ROM_STATE_SIZE = 11000;     // sizeof(tinfl_decompressor) in ROM
+
+struct tinfl_decompressor {
+    uint32_t m_state;
+    uint8_t pad[TINFL_ROM_STATE_SIZE - sizeof(uint32_t)];
+};
+
+namespace host {
+
+struct InflateArena {
+    z_stream z;
+    size_t used;
+    alignas(16) uint8_t mem[48 * 1024];
+};
+inline InflateArena inflateArena;
+
+inline voidpf inflateAlloc(voidpf, uInt items, uInt size) {
+    size_t n = ((size_t)items * size + 15) & ~(size_t)15;
+    if (inflateArena.used + n > sizeof(inflateArena.mem)) return Z_NULL;
+    void* p = inflateArena.mem + inflateArena.used;
+    inflateArena.used += n;
+    return p;
+}
+inline void inflateFree(voidpf, voidpf) {}
+
+} // namespace host
+
+#define tinfl_init(r) do { (r)->m_state = 0; } while (0)
+
+inline tinfl_status tinfl_decompress(tinfl_decompressor* r, const uint8_t* in, size_t* inSize,
+                                     uint8_t* outStart, uint8_t* outNext, size_t* outSize,
+                                     uint32_t flags) {
+    (void)outStart;
+    (void)flags;
+    z_stream& z = host::inflateArena.z;
+    if (r->m_state == 0) {
+        memset(&z, 0, sizeof(z));
+        host::inflateArena.used = 0;
+        z.zalloc = host::inflateAlloc;
+        z.zfree = host::inflateFree;
+        if (inflateInit2(&z, -MAX_WBITS) != Z_OK) return TINFL_STATUS_FAILED;
+        r->m_state = 1;
+    }
+    z.next_in = (Bytef*)in;
+    z.avail_in = (uInt)*inSize;
+    z.next_out = outNext;
+    z.avail_out = (uInt)*outSize;
+    int ret = inflate(&z, Z_NO_FLUSH);
+    size_t room = *outSize;
+    *inSize -= z.avail_in;
+    *outSize -= z.avail_out;
+    if (ret == Z_STREAM_END) return TINFL_STATUS_DONE;
+    if (ret != Z_OK && ret != Z_BUF_ERROR) return TINFL_STATUS_FAILED;
+    return *outSize == room ? TINFL_STATUS_HAS_MORE_OUTPUT : TINFL_STATUS_NEEDS_MORE_INPUT;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// OTA partition stand-in: the two app slots of the fake flash
+// (host::flash()), "app0" and "app1"
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_ERR_INVALID_ARG 0x102
+
+typedef struct {
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+} esp_partition_t;
+
+const esp_partition_t* esp_ota_get_running_partition();
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start);
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition);
@@ -0,0 +1,10 @@
+#pragma once
+
+// SNTP stand-in: the host clock is already set, so the sync callback runs
+// from configTime()
+#include <sys/time.h>
+
+typedef void (*sntp_sync_time_cb_t)(struct timeval* tv);
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback);
+void sntp_restart();
@@ -0,0 +1,12 @@
+#pragma once
+
+// Task watchdog stand-in: feeds are timed on the host clock instead of
+// resetting anything (host::wdtStats())
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+
+esp_err_t esp_task_wdt_init(uint32_t timeoutSec, bool panic);
+esp_err_t esp_task_wdt_add(void* task);
+esp_err_t esp_task_wdt_reset();
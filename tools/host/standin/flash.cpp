@@ -0,0 +1,172 @@
+#include <Arduino.h>
+#include <Update.h>
+#include <esp_ota_ops.h>
+#include <mbedtls/sha256.h>
+#include <string.h>
+
+#include "host.h"
+
+// ==========================================
+// APP SLOTS
+// ==========================================
+namespace {
+
+const esp_partition_t slots[2] = {
+    {0x10000, 0x1E0000, "app0"},
+    {0x1F0000, 0x1E0000, "app1"},
+};
+host::FlashState state;
+
+uint8_t other(uint8_t slot) { return slot ^ 1; }
+
+} // namespace
+
+const host::FlashState& host::flash() { return state; }
+
+void host::rebootFlash() { state.running = state.boot; }
+
+void host::resetFlash() {
+    HarnessScope scope;
+    state = FlashState();
+}
+
+const esp_partition_t* esp_ota_get_running_partition() { return &slots[state.running]; }
+
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start) {
+    uint8_t from = start ? (uint8_t)(start - slots) : state.running;
+    return &slots[other(from)];
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition) {
+    if (partition != &slots[0] && partition != &slots[1]) return ESP_ERR_INVALID_ARG;
+    state.boot = (uint8_t)(partition - slots);
+    return ESP_OK;
+}
+
+// ==========================================
+// UPDATE
+// ==========================================
+UpdateClass Update;
+
+// Flash is not heap: the slot images stay out of the heap model
+
+bool UpdateClass::begin(size_t size) {
+    (void)size;
+    host::HarnessScope scope;
+    state.image[other(state.running)].clear();
+    active_ = true;
+    error_ = "No Error";
+    return true;
+}
+
+size_t UpdateClass::write(uint8_t* data, size_t len) {
+    if (!active_) return 0;
+    std::string& image = state.image[other(state.running)];
+    if (image.empty() && len && data[0] != 0xE9) {
+        error_ = "Magic byte is wrong, not 0xE9";
+        abort();
+        return 0;
+    }
+    host::HarnessScope scope;
+    image.append((const char*)data, len);
+    return len;
+}
+
+bool UpdateClass::end(bool evenIfRemaining) {
+    (void)evenIfRemaining;
+    if (!active_) {
+        error_ = "Not Started";
+        return false;
+    }
+    active_ = false;
+    if (state.image[other(state.running)].empty()) {
+        error_ = "Nothing written";
+        return false;
+    }
+    esp_ota_set_boot_partition(&slots[other(state.running)]);
+    return true;
+}
+
+void UpdateClass::abort() {
+    active_ = false;
+    host::HarnessScope scope;
+    state.image[other(state.running)].clear();
+}
+
+// ==========================================
+// SHA-256 (FIPS 180-4)
+// ==========================================
+namespace {
+
+const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+inline uint32_t ror(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+void block(uint32_t* h, const uint8_t* p) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) w[i] = (uint32_t)p[4 * i] << 24 | p[4 * i + 1] << 16 | p[4 * i + 2] << 8 | p[4 * i + 3];
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ror(w[i - 15], 7) ^ ror(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ror(w[i - 2], 17) ^ ror(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = k + (ror(e, 6) ^ ror(e, 11) ^ ror(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+        uint32_t t2 = (ror(a, 2) ^ ror(a, 13) ^ ror(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        k = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+}
+
+} // namespace
+
+void mbedtls_sha256_init(mbedtls_sha256_context* ctx) { memset(ctx, 0, sizeof(*ctx)); }
+void mbedtls_sha256_free(mbedtls_sha256_context* ctx) { memset(ctx, 0, sizeof(*ctx)); }
+
+int mbedtls_sha256_starts(mbedtls_sha256_context* ctx, int is224) {
+    static const uint32_t init[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    if (is224) return -1;       // the firmware only uses SHA-256
+    memcpy(ctx->state, init, sizeof(init));
+    ctx->total = 0;
+    return 0;
+}
+
+int mbedtls_sha256_update(mbedtls_sha256_context* ctx, const unsigned char* input, size_t len) {
+    while (len) {
+        size_t used = ctx->total % 64;
+        size_t n = 64 - used < len ? 64 - used : len;
+        memcpy(ctx->buffer + used, input, n);
+        ctx->total += n;
+        input += n;
+        len -= n;
+        if (used + n == 64) block(ctx->state, ctx->buffer);
+    }
+    return 0;
+}
+
+int mbedtls_sha256_finish(mbedtls_sha256_context* ctx, unsigned char output[32]) {
+    uint64_t bits = ctx->total * 8;
+    uint8_t pad[72] = {0x80};
+    size_t padLen = (ctx->total % 64 < 56 ? 56 : 120) - ctx->total % 64;
+    for (int i = 0; i < 8; i++) pad[padLen + i] = (uint8_t)(bits >> (56 - 8 * i));
+    mbedtls_sha256_update(ctx, pad, padLen + 8);
+    for (int i = 0; i < 8; i++) {
+        output[4 * i] = (uint8_t)(ctx->state[i] >> 24);
+        output[4 * i + 1] = (uint8_t)(ctx->state[i] >> 16);
+        output[4 * i + 2] = (uint8_t)(ctx->state[i] >> 8);
+        output[4 * i + 3] = (uint8_t)ctx->state[i];
+    }
+    return 0;
+}
@@ -0,0 +1,196 @@
+// ==========================================
+// HOST HEAP MODEL
+// ==========================================
+// Replaces malloc() and friends for the whole process. Once
+// host::useDeviceHeap(true) is called, everything the firmware allocates
+// comes from one fixed first-fit heap of HOST_HEAP_SIZE bytes - roughly what
+// the ESP32 has left once WiFi is up - so a leak or a fragmenting allocation
+// pattern shows up as it would on the board: free heap drifting down,
+// the largest free block shrinking, allocations failing. Anything allocated
+// inside a host::HarnessScope (replies, fixtures, reports, stdio) and
+// everything before the switch goes to the C library's allocator.
+//
+// Blocks carry a 16-byte header and are 16-byte aligned; the first free block
+// that fits is split. Free blocks are merged with free neighbours, so the
+// free list order is the address order, as in the ESP-IDF heap.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <dlfcn.h>
+
+#include "host.h"
+
+#ifndef HOST_HEAP_SIZE
+#define HOST_HEAP_SIZE (160 * 1024)
+#endif
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* p);
+}
+
+namespace {
+
+constexpr size_t ALIGN = 16;
+
+struct Block {
+    size_t size;        // payload bytes
+    size_t used;        // 0 = free; also keeps the header 16 bytes
+};
+
+alignas(ALIGN) uint8_t arena[HOST_HEAP_SIZE];
+bool deviceHeap = false;
+bool initialised = false;
+host::HeapStats model = {HOST_HEAP_SIZE, 0, 0, 0, 0, 0, 0, 0};
+
+Block* first() { return reinterpret_cast<Block*>(arena); }
+Block* next(Block* b) { return reinterpret_cast<Block*>(reinterpret_cast<uint8_t*>(b + 1) + b->size); }
+bool inArena(const void* p) { return p >= arena && p < arena + sizeof(arena); }
+Block* header(void* p) { return static_cast<Block*>(p) - 1; }
+
+void init() {
+    first()->size = sizeof(arena) - sizeof(Block);
+    first()->used = 0;
+    model.free = model.minFree = first()->size;
+    initialised = true;
+}
+
+bool isEnd(Block* b) { return reinterpret_cast<uint8_t*>(b) >= arena + sizeof(arena); }
+
+void* modelAlloc(size_t size) {
+    if (!initialised) init();
+    size = (size + ALIGN - 1) & ~(ALIGN - 1);
+    if (!size) size = ALIGN;
+    for (Block* b = first(); !isEnd(b); b = next(b)) {
+        if (b->used || b->size < size) continue;
+        if (b->size >= size + sizeof(Block) + ALIGN) {
+            Block* rest = reinterpret_cast<Block*>(reinterpret_cast<uint8_t*>(b + 1) + size);
+            rest->size = b->size - size - sizeof(Block);
+            rest->used = 0;
+            b->size = size;
+            model.free -= sizeof(Block);
+        }
+        b->used = 1;
+        model.free -= b->size;
+        if (model.free < model.minFree) model.minFree = model.free;
+        model.allocations++;
+        model.bytesAllocated += b->size;
+        return b + 1;
+    }
+    model.failed++;
+    return nullptr;
+}
+
+void modelFree(void* p) {
+    Block* b = header(p);
+    b->used = 0;
+    model.free += b->size;
+    model.frees++;
+    // Merge every run of free blocks (cheap at this heap size, and keeps the
+    // list free of neighbours that should be one block)
+    for (Block* a = first(); !isEnd(a); a = next(a)) {
+        if (a->used) continue;
+        for (Block* n = next(a); !isEnd(n) && !n->used; n = next(a)) {
+            a->size += sizeof(Block) + n->size;
+            model.free += sizeof(Block);
+        }
+    }
+}
+
+bool useModel() { return deviceHeap && !host::inHarness(); }
+
+size_t usableSize(void* p) {
+    if (inArena(p)) return header(p)->size;
+    static size_t (*libcUsableSize)(void*) = (size_t (*)(void*))dlsym(RTLD_NEXT, "malloc_usable_size");
+    return libcUsableSize ? libcUsableSize(p) : 0;
+}
+
+} // namespace
+
+namespace host {
+
+void useDeviceHeap(bool on) {
+    if (!initialised) init();
+    deviceHeap = on;
+}
+
+HeapStats heapStats() {
+    if (!initialised) init();
+    HeapStats s = model;
+    s.largestFree = 0;
+    for (Block* b = first(); !isEnd(b); b = next(b)) {
+        if (!b->used && b->size > s.largestFree) s.largestFree = b->size;
+    }
+    return s;
+}
+
+} // namespace host
+
+// ==========================================
+// C LIBRARY ENTRY POINTS
+// ==========================================
+extern "C" {
+
+void* malloc(size_t size) {
+    if (!useModel()) return __libc_malloc(size);
+    void* p = modelAlloc(size);
+    if (!p) errno = ENOMEM;
+    return p;
+}
+
+void free(void* p) {
+    if (!p) return;
+    if (inArena(p)) modelFree(p);
+    else __libc_free(p);
+}
+
+void* calloc(size_t n, size_t size) {
+    if (!useModel()) return __libc_calloc(n, size);
+    if (size && n > SIZE_MAX / size) return nullptr;
+    void* p = malloc(n * size);
+    if (p) memset(p, 0, n * size);
+    return p;
+}
+
+void* realloc(void* p, size_t size) {
+    if (!p) return malloc(size);
+    if (!size) {
+        free(p);
+        return nullptr;
+    }
+    // Blocks stay in the heap they came from
+    if (!inArena(p)) return __libc_realloc(p, size);
+    size_t old = usableSize(p);
+    if (old >= size) return p;
+    void* q = modelAlloc(size);
+    if (!q) return nullptr;
+    memcpy(q, p, old < size ? old : size);
+    free(p);
+    return q;
+}
+
+void* memalign(size_t alignment, size_t size) {
+    if (!useModel()) return __libc_memalign(alignment, size);
+    return alignment <= ALIGN ? malloc(size) : nullptr;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) { return memalign(alignment, size); }
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    void* p = memalign(alignment, size);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+void* valloc(size_t size) { return memalign(4096, size); }
+void* pvalloc(size_t size) { return memalign(4096, (size + 4095) & ~(size_t)4095); }
+
+size_t malloc_usable_size(void* p) { return p ? usableSize(p) : 0; }
+
+} // extern "C"
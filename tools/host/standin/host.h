@@ -0,0 +1,180 @@
+#pragma once
+
+// ==========================================
+// HOST CONTROL
+// ==========================================
+// What a host program (benchmark, soak, test) can do to the world the
+// firmware runs in: drive the clock, decide whether WiFi is up, answer
+// requests in-process instead of over a socket, and read back what the
+// firmware cost (bytes on the wire, heap, watchdog gaps, pixels drawn).
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <string>
+
+class WiFiClient;
+class HardwareSerial;
+
+namespace host {
+
+// ------------------------------------------
+// Clock
+// ------------------------------------------
+// Real: millis()/micros() follow the host's monotonic clock and delay()
+// sleeps. Virtual: time starts at 0 and only moves in delay(), in advance()
+// and by 1 ms per poll while a read waits for data; nothing sleeps.
+void useVirtualClock(bool on);
+bool virtualClock();
+void advance(uint32_t ms);
+uint64_t nowMicros();
+
+// ------------------------------------------
+// Serial
+// ------------------------------------------
+void setSerialOutput(bool on);      // default on (stdout)
+
+// Bytes arriving on a UART (e.g. NMEA on Serial2): appended to what the
+// port has not read yet, then its onReceive() callback runs, on the
+// calling thread
+void uartReceive(HardwareSerial& port, const std::string& bytes);
+
+// ------------------------------------------
+// WiFi
+// ------------------------------------------
+void setWifiConnected(bool up);     // default: up once WiFi.begin() was called
+void setWifiJoinMs(uint32_t ms);    // WiFi.begin() to connected (association, DHCP); default 0
+
+// ------------------------------------------
+// In-process servers
+// ------------------------------------------
+// A request to "host[:port]" that has a handler is answered in-process;
+// anything else goes to a real TCP socket. The handler sees the raw request
+// (request line and headers) and returns the raw response plus how it is
+// delivered.
+struct Reply {
+    std::string bytes;              // status line, headers and body
+    uint32_t delayMs = 0;           // before the first byte
+    size_t cutAt = SIZE_MAX;        // deliver only this many bytes...
+    bool resetAtCut = false;        // ...then close (true) or stall (false)
+};
+typedef std::function<Reply(const std::string& request)> Handler;
+
+void serve(const char* hostAndPort, Handler handler);
+void stopServing(const char* hostAndPort);
+
+// In-process stream servers, for protocols that are not one request and one
+// reply (MQTT). The handler gets the connection's number (from 1, per
+// connection made) and the server's end of it, and runs every time the
+// firmware has written to the connection: it reads what arrived and writes
+// its answer, or stop()s the connection. An answer costs the firmware one
+// round trip. The server may keep the WiFiClient and stop() it later.
+typedef std::function<void(uint32_t connection, WiFiClient& server)> StreamHandler;
+void serveStream(const char* hostAndPort, StreamHandler handler);
+
+// Link every in-process connection goes through: connect costs one round
+// trip, the reply starts a round trip after the request and then arrives
+// at bytesPerMs (0 = all at once)
+struct Link {
+    uint32_t rttMs = 0;
+    uint32_t bytesPerMs = 0;
+};
+void setLink(const Link& link);
+
+// Client end of a new connection to a WiFiServer listening on port in this
+// process (for testing servers); sendWindow caps the bytes the server can
+// have in flight toward it, like a TCP send buffer
+WiFiClient dial(uint16_t port, size_t sendWindow = 5744);
+
+struct NetStats {
+    uint32_t connections;
+    uint64_t bytesSent;             // by the firmware, headers included
+    uint64_t bytesReceived;
+};
+const NetStats& netStats();
+
+// ------------------------------------------
+// Heap (heap_model.cpp)
+// ------------------------------------------
+// With heap_model.cpp linked in and useDeviceHeap(true), malloc() and
+// friends are served from a fixed first-fit heap of HOST_HEAP_SIZE bytes,
+// so free heap, largest block and fragmentation behave like a small device
+// heap instead of the host's. Without it all figures are 0.
+//
+// The harness's own allocations (replies it serves, buffers standing in for
+// lwIP, Serial's stdio buffer) are made inside a HarnessScope and stay out
+// of the model.
+void useDeviceHeap(bool on);
+struct HarnessScope {
+    HarnessScope();
+    ~HarnessScope();
+    HarnessScope(const HarnessScope&) = delete;
+    HarnessScope& operator=(const HarnessScope&) = delete;
+};
+bool inHarness();
+struct HeapStats {
+    size_t size;
+    size_t free;
+    size_t minFree;
+    size_t largestFree;
+    uint64_t allocations;           // malloc/calloc/realloc calls that returned memory
+    uint64_t bytesAllocated;        // their sizes, summed
+    uint64_t frees;
+    uint32_t failed;                // requests the heap could not satisfy
+};
+HeapStats heapStats();
+
+// ------------------------------------------
+// Watchdog
+// ------------------------------------------
+// esp_task_wdt_reset() gaps on the host clock. A gap longer than the
+// timeout given to esp_task_wdt_init() is a reset on the device.
+struct WdtStats {
+    uint32_t timeoutMs;
+    uint32_t maxGapMs;
+    uint32_t trips;
+};
+const WdtStats& wdtStats();
+
+// ------------------------------------------
+// Display (TFT_eSPI stand-in)
+// ------------------------------------------
+struct DisplayStats {
+    uint32_t flushes;               // pushColors() calls
+    uint64_t pixels;
+    uint32_t firstScreenMs;         // millis() once a screenful had been flushed, 0 before
+};
+const DisplayStats& displayStats();
+
+// What the panel costs on the clock: begin() takes initMs, and pushColors()
+// sends 16 bits per pixel at spiHz. Default 0, 0: free.
+void setPanelTiming(uint32_t initMs, uint32_t spiHz);
+
+// ------------------------------------------
+// NVS (Preferences stand-in)
+// ------------------------------------------
+void clearNvs();
+
+// ------------------------------------------
+// Flash (Update and esp_ota_ops stand-ins)
+// ------------------------------------------
+// Two app slots. Update writes the one not running and end(true) makes it
+// the boot slot; rebootFlash() then starts the boot slot, as a reset would.
+struct FlashState {
+    uint8_t running = 0;
+    uint8_t boot = 0;
+    std::string image[2];           // bytes Update wrote per slot
+};
+const FlashState& flash();
+void rebootFlash();
+void resetFlash();
+
+// ------------------------------------------
+// Restart
+// ------------------------------------------
+// ESP.restart() ends the process (exit status 3). With catchRestart(true)
+// it throws Restart instead, so a test can "boot" the firmware again.
+struct Restart {};
+void catchRestart(bool on);
+
+} // namespace host
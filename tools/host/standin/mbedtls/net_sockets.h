@@ -0,0 +1,5 @@
+#pragma once
+
+typedef struct mbedtls_net_context {
+    int fd;
+} mbedtls_net_context;
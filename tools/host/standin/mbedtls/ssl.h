@@ -0,0 +1,7 @@
+#pragma once
+
+// Opaque mbedTLS types, so lean_tls.h compiles; lean_tls.cpp is not part
+// of the host build (no TLS there)
+typedef struct mbedtls_ssl_context mbedtls_ssl_context;
+typedef struct mbedtls_ssl_config mbedtls_ssl_config;
+typedef struct mbedtls_ssl_session mbedtls_ssl_session;
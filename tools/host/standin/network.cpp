@@ -0,0 +1,595 @@
+#include <WiFi.h>
+#include <HTTPClient.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "host.h"
+
+// ==========================================
+// CONNECTIONS
+// ==========================================
+namespace host {
+
+// One end of a connection as the firmware sees it
+class Socket {
+public:
+    virtual ~Socket() {}
+    virtual size_t write(const uint8_t* buf, size_t size) = 0;
+    virtual int availableForWrite() { return 0; }
+    virtual int available() = 0;
+    virtual int read(uint8_t* buf, size_t size) = 0;
+    virtual int peek() = 0;
+    virtual bool connected() = 0;
+    virtual void close() = 0;
+};
+
+} // namespace host
+
+namespace {
+
+host::NetStats stats = {0, 0, 0};
+host::Link linkModel;
+std::map<std::string, host::Handler> handlers;
+
+// ------------------------------------------
+// In-process handler
+// ------------------------------------------
+// Collects the request until the blank line, asks the handler once, then
+// releases the reply as the link model allows
+class HandlerSocket : public host::Socket {
+public:
+    explicit HandlerSocket(const host::Handler& handler) : handler_(handler) {}
+
+    size_t write(const uint8_t* buf, size_t size) override {
+        if (closed_ || answered_) return 0;
+        host::HarnessScope scope;
+        request_.append((const char*)buf, size);
+        stats.bytesSent += size;
+        if (request_.find("\r\n\r\n") != std::string::npos) answer();
+        return size;
+    }
+
+    int available() override {
+        if (!answered_ || closed_) return 0;
+        return (int)(released() - readPos_);
+    }
+
+    int read(uint8_t* buf, size_t size) override {
+        size_t n = std::min(size, (size_t)available());
+        memcpy(buf, reply_.bytes.data() + readPos_, n);
+        readPos_ += n;
+        stats.bytesReceived += n;
+        return (int)n;
+    }
+
+    int peek() override { return available() ? (uint8_t)reply_.bytes[readPos_] : -1; }
+
+    // Open until everything deliverable was read; a stalled reply never closes
+    bool connected() override {
+        if (closed_) return false;
+        if (!answered_ || available()) return true;
+        if (readPos_ < deliverable()) return true;
+        return deliverable() < reply_.bytes.size() && !reply_.resetAtCut;
+    }
+
+    void close() override { closed_ = true; }
+
+private:
+    void answer() {
+        host::HarnessScope scope;
+        reply_ = handler_(request_);
+        answered_ = true;
+        readyUs_ = host::nowMicros() + (uint64_t)(linkModel.rttMs + reply_.delayMs) * 1000;
+    }
+
+    size_t deliverable() const { return std::min(reply_.cutAt, reply_.bytes.size()); }
+
+    // Bytes that have "arrived" by now
+    size_t released() const {
+        uint64_t now = host::nowMicros();
+        if (now < readyUs_) return 0;
+        if (!linkModel.bytesPerMs) return deliverable();
+        uint64_t n = (now - readyUs_) / 1000 * linkModel.bytesPerMs + linkModel.bytesPerMs;
+        return (size_t)std::min<uint64_t>(n, deliverable());
+    }
+
+    host::Handler handler_;
+    std::string request_;
+    host::Reply reply_;
+    bool answered_ = false;
+    bool closed_ = false;
+    uint64_t readyUs_ = 0;
+    size_t readPos_ = 0;
+};
+
+// ------------------------------------------
+// Real TCP
+// ------------------------------------------
+class TcpSocket : public host::Socket {
+public:
+    explicit TcpSocket(int fd) : fd_(fd) {}
+    ~TcpSocket() override { close(); }
+
+    size_t write(const uint8_t* buf, size_t size) override {
+        size_t sent = 0;
+        while (fd_ >= 0 && sent < size) {
+            ssize_t n = send(fd_, buf + sent, size - sent, MSG_NOSIGNAL);
+            if (n > 0) {
+                sent += n;
+            } else if (n < 0 && errno == EAGAIN) {
+                pollfd p = {fd_, POLLOUT, 0};
+                if (::poll(&p, 1, 5000) <= 0) break;
+            } else {
+                break;
+            }
+        }
+        stats.bytesSent += sent;
+        return sent;
+    }
+
+    int available() override {
+        int n = 0;
+        if (fd_ < 0 || ioctl(fd_, FIONREAD, &n) < 0) return 0;
+        return n;
+    }
+
+    int read(uint8_t* buf, size_t size) override {
+        if (fd_ < 0) return -1;
+        ssize_t n = recv(fd_, buf, size, 0);
+        if (n == 0) eof_ = true;
+        if (n <= 0) return n == 0 || errno == EAGAIN ? 0 : -1;
+        stats.bytesReceived += n;
+        return (int)n;
+    }
+
+    int peek() override {
+        uint8_t c;
+        return fd_ >= 0 && recv(fd_, &c, 1, MSG_PEEK) == 1 ? c : -1;
+    }
+
+    bool connected() override {
+        if (fd_ < 0) return false;
+        if (available()) return true;
+        uint8_t c;
+        ssize_t n = recv(fd_, &c, 1, MSG_PEEK);
+        if (n == 0) eof_ = true;
+        return !eof_ && (n > 0 || errno == EAGAIN);
+    }
+
+    void close() override {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+private:
+    int fd_;
+    bool eof_ = false;
+};
+
+int tcpConnect(const char* hostName, uint16_t port, int32_t timeoutMs) {
+    host::HarnessScope scope;
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if (getaddrinfo(hostName, service, &hints, &res) != 0 || !res) return -1;
+    int fd = socket(res->ai_family, SOCK_STREAM, 0);
+    if (fd >= 0) {
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        int r = ::connect(fd, res->ai_addr, res->ai_addrlen);
+        if (r < 0 && errno == EINPROGRESS) {
+            pollfd p = {fd, POLLOUT, 0};
+            int err = 0;
+            socklen_t len = sizeof(err);
+            r = ::poll(&p, 1, timeoutMs) == 1 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && !err ? 0 : -1;
+        }
+        if (r < 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+// ------------------------------------------
+// In-process server connections (host::dial)
+// ------------------------------------------
+struct Pipe {
+    std::deque<uint8_t> toServer;
+    std::deque<uint8_t> toClient;
+    size_t window;
+    bool closed = false;
+};
+
+class PipeEnd : public host::Socket {
+public:
+    PipeEnd(std::shared_ptr<Pipe> pipe, bool server) : pipe_(pipe), server_(server) {}
+
+    // The server end takes only what fits in the window, like a
+    // non-blocking write into a full TCP send buffer
+    size_t write(const uint8_t* buf, size_t size) override {
+        if (pipe_->closed) return 0;
+        host::HarnessScope scope;
+        if (server_) size = std::min(size, (size_t)availableForWrite());
+        out().insert(out().end(), buf, buf + size);
+        return size;
+    }
+
+    int availableForWrite() override {
+        if (!server_) return (int)pipe_->window;
+        return pipe_->toClient.size() >= pipe_->window ? 0 : (int)(pipe_->window - pipe_->toClient.size());
+    }
+
+    int available() override { return (int)in().size(); }
+
+    int read(uint8_t* buf, size_t size) override {
+        host::HarnessScope scope;
+        size_t n = std::min(size, in().size());
+        std::copy(in().begin(), in().begin() + n, buf);
+        in().erase(in().begin(), in().begin() + n);
+        return (int)n;
+    }
+
+    int peek() override { return in().empty() ? -1 : in().front(); }
+    bool connected() override { return !pipe_->closed || !in().empty(); }
+    void close() override { pipe_->closed = true; }
+
+private:
+    std::deque<uint8_t>& in() { return server_ ? pipe_->toServer : pipe_->toClient; }
+    std::deque<uint8_t>& out() { return server_ ? pipe_->toClient : pipe_->toServer; }
+
+    std::shared_ptr<Pipe> pipe_;
+    bool server_;
+};
+
+// ------------------------------------------
+// In-process stream servers (host::serveStream)
+// ------------------------------------------
+// The firmware's end of a pipe whose server runs whenever the firmware has
+// written something
+class StreamSocket : public host::Socket {
+public:
+    StreamSocket(const host::StreamHandler& handler, uint32_t id) : handler_(handler), id_(id) {
+        auto pipe = std::make_shared<Pipe>();
+        pipe->window = 1 << 20;     // the firmware never waits for the server to read
+        mine_ = std::make_shared<PipeEnd>(pipe, false);
+        server_ = WiFiClient(std::make_shared<PipeEnd>(pipe, true));
+    }
+
+    size_t write(const uint8_t* buf, size_t size) override {
+        if (!mine_->connected()) return 0;
+        size_t n = mine_->write(buf, size);
+        stats.bytesSent += n;
+        size_t before = mine_->available();
+        {
+            host::HarnessScope scope;
+            handler_(id_, server_);
+        }
+        if ((size_t)mine_->available() > before) host::advance(linkModel.rttMs);
+        return n;
+    }
+
+    int availableForWrite() override { return mine_->availableForWrite(); }
+    int available() override { return mine_->available(); }
+
+    int read(uint8_t* buf, size_t size) override {
+        int n = mine_->read(buf, size);
+        stats.bytesReceived += n;
+        return n;
+    }
+
+    int peek() override { return mine_->peek(); }
+    bool connected() override { return mine_->connected(); }
+    void close() override { mine_->close(); }
+
+private:
+    host::StreamHandler handler_;
+    uint32_t id_;
+    std::shared_ptr<PipeEnd> mine_;
+    WiFiClient server_;
+};
+
+std::map<std::string, host::StreamHandler> streamHandlers;
+uint32_t streamConnections = 0;
+
+// Pending connections per listening port. Never destroyed: the firmware's
+// WiFiServers are globals whose destructors may run after this file's
+typedef std::map<uint16_t, std::deque<std::shared_ptr<host::Socket>>> ListenerMap;
+ListenerMap& listeners = *new ListenerMap;
+
+bool wifiBegun = false;
+uint32_t wifiBegunAt = 0;
+uint32_t wifiJoinMs = 0;
+bool wifiForced = false;
+bool wifiUp = true;
+
+template <class Map>
+const typename Map::mapped_type* findIn(const Map& map, const char* hostName, uint16_t port) {
+    char key[160];
+    snprintf(key, sizeof(key), "%s:%u", hostName, port);
+    auto it = map.find(key);
+    if (it == map.end()) it = map.find(hostName);
+    return it == map.end() ? nullptr : &it->second;
+}
+
+const host::Handler* findHandler(const char* hostName, uint16_t port) { return findIn(handlers, hostName, port); }
+
+} // namespace
+
+// ==========================================
+// HOST CONTROL
+// ==========================================
+void host::serve(const char* hostAndPort, Handler handler) { handlers[hostAndPort] = handler; }
+void host::stopServing(const char* hostAndPort) {
+    handlers.erase(hostAndPort);
+    streamHandlers.erase(hostAndPort);
+}
+void host::serveStream(const char* hostAndPort, StreamHandler handler) { streamHandlers[hostAndPort] = handler; }
+void host::setLink(const Link& l) { linkModel = l; }
+const host::NetStats& host::netStats() { return stats; }
+
+void host::setWifiJoinMs(uint32_t ms) { wifiJoinMs = ms; }
+
+void host::setWifiConnected(bool up) {
+    wifiForced = true;
+    wifiUp = up;
+}
+
+WiFiClient host::dial(uint16_t port, size_t sendWindow) {
+    host::HarnessScope scope;
+    auto it = listeners.find(port);
+    if (it == listeners.end()) return WiFiClient();
+    auto pipe = std::make_shared<Pipe>();
+    pipe->window = sendWindow;
+    it->second.push_back(std::make_shared<PipeEnd>(pipe, true));
+    return WiFiClient(std::make_shared<PipeEnd>(pipe, false));
+}
+
+// ==========================================
+// WIFI
+// ==========================================
+WiFiClass WiFi;
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes_[0], bytes_[1], bytes_[2], bytes_[3]);
+    return String(buf);
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* password) {
+    (void)ssid; (void)password;
+    wifiBegun = true;
+    wifiBegunAt = millis();
+    return status();
+}
+
+wl_status_t WiFiClass::status() {
+    bool up = wifiForced ? wifiUp : wifiBegun && millis() - wifiBegunAt >= wifiJoinMs;
+    return up ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+int WiFiClass::hostByName(const char* hostName, IPAddress& result) {
+    result = IPAddress(127, 0, 0, 1);
+    if (findHandler(hostName, 0) || findIn(streamHandlers, hostName, 0)) return 1;
+    host::HarnessScope scope;
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(hostName, nullptr, &hints, &res) != 0 || !res) return 0;
+    const uint8_t* a = (const uint8_t*)&((sockaddr_in*)res->ai_addr)->sin_addr;
+    result = IPAddress(a[0], a[1], a[2], a[3]);
+    freeaddrinfo(res);
+    return 1;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) { return connect(ip, port, 3000); }
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+    return connect(ip.toString().c_str(), port, timeoutMs);
+}
+
+int WiFiClient::connect(const char* hostName, uint16_t port) { return connect(hostName, port, 3000); }
+
+int WiFiClient::connect(const char* hostName, uint16_t port, int32_t timeoutMs) {
+    stop();
+    if (WiFi.status() != WL_CONNECTED) return 0;
+    if (const host::Handler* handler = findHandler(hostName, port)) {
+        host::advance(linkModel.rttMs);      // SYN / SYN-ACK
+        socket_ = std::make_shared<HandlerSocket>(*handler);
+    } else if (const host::StreamHandler* handler = findIn(streamHandlers, hostName, port)) {
+        host::advance(linkModel.rttMs);
+        socket_ = std::make_shared<StreamSocket>(*handler, ++streamConnections);
+    } else {
+        int fd = tcpConnect(hostName, port, timeoutMs);
+        if (fd < 0) return 0;
+        socket_ = std::make_shared<TcpSocket>(fd);
+    }
+    stats.connections++;
+    return 1;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) { return socket_ ? socket_->write(buf, size) : 0; }
+int WiFiClient::availableForWrite() { return socket_ ? socket_->availableForWrite() : 0; }
+int WiFiClient::available() { return socket_ ? socket_->available() : 0; }
+
+int WiFiClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+    if (!socket_) return -1;
+    int n = socket_->read(buf, size);
+    return n > 0 ? n : -1;
+}
+
+int WiFiClient::peek() { return socket_ ? socket_->peek() : -1; }
+
+void WiFiClient::stop() {
+    if (socket_) socket_->close();
+    socket_.reset();
+}
+
+uint8_t WiFiClient::connected() { return socket_ && socket_->connected(); }
+
+WiFiServer::~WiFiServer() { end(); }
+
+void WiFiServer::begin() {
+    listeners[port_];
+    listening_ = true;
+}
+
+void WiFiServer::end() {
+    if (listening_) listeners.erase(port_);
+    listening_ = false;
+}
+
+WiFiClient WiFiServer::available() {
+    auto it = listeners.find(port_);
+    if (it == listeners.end() || it->second.empty()) return WiFiClient();
+    WiFiClient client(it->second.front());
+    it->second.pop_front();
+    return client;
+}
+
+// ==========================================
+// HTTPCLIENT
+// ==========================================
+bool HTTPClient::begin(const String& url) { return begin(own_, url); }
+
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+    client_ = &client;
+    extraHeaders_.clear();
+    collected_.clear();
+    size_ = -1;
+
+    std::string u = url.c_str();
+    size_t scheme = u.find("://");
+    bool https = scheme != std::string::npos && u.compare(0, scheme, "https") == 0;
+    if (scheme != std::string::npos) u.erase(0, scheme + 3);
+    size_t slash = u.find('/');
+    std::string hostPort = u.substr(0, slash);
+    path_ = slash == std::string::npos ? String("/") : String(u.substr(slash));
+    size_t colon = hostPort.find(':');
+    port_ = colon == std::string::npos ? (https ? 443 : 80) : (uint16_t)atoi(hostPort.c_str() + colon + 1);
+    host_ = String(hostPort.substr(0, colon));
+    return !host_.isEmpty();
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+    extraHeaders_ += std::string(name.c_str()) + ": " + value.c_str() + "\r\n";
+}
+
+void HTTPClient::collectHeaders(const char* headerKeys[], const size_t count) {
+    collected_.clear();
+    for (size_t i = 0; i < count; i++) collected_.push_back({headerKeys[i], String()});
+}
+
+// One header line without "\r\n"; false on timeout or a closed connection
+bool HTTPClient::readLine(std::string& line) {
+    line.clear();
+    uint32_t start = millis();
+    while (millis() - start < timeout_) {
+        int c = client_->read();
+        if (c < 0) {
+            if (!client_->connected()) return false;
+            yield();
+            continue;
+        }
+        if (c == '\n') {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            return true;
+        }
+        line += (char)c;
+    }
+    return false;
+}
+
+int HTTPClient::GET() {
+    if (!client_) return HTTPC_ERROR_NOT_CONNECTED;
+    if (!client_->connected() && !client_->connect(host_.c_str(), port_, connectTimeout_)) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    std::string request = std::string("GET ") + path_.c_str() + (http10_ ? " HTTP/1.0" : " HTTP/1.1") + "\r\n" +
+                          "Host: " + host_.c_str() + (port_ == 80 || port_ == 443 ? "" : ":" + std::to_string(port_)) +
+                          "\r\nUser-Agent: ESP32HTTPClient\r\nConnection: close\r\n" +
+                          (http10_ ? "" : "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n") +
+                          extraHeaders_ + "\r\n";
+    if (client_->write((const uint8_t*)request.data(), request.size()) != request.size()) {
+        end();
+        return HTTPC_ERROR_SEND_HEADER_FAILED;
+    }
+
+    std::string line;
+    if (!readLine(line)) {
+        bool lost = !client_->connected();
+        end();
+        return lost ? HTTPC_ERROR_CONNECTION_LOST : HTTPC_ERROR_READ_TIMEOUT;
+    }
+    int code = 0;
+    if (sscanf(line.c_str(), "HTTP/%*d.%*d %d", &code) != 1) {
+        end();
+        return HTTPC_ERROR_NO_HTTP_SERVER;
+    }
+    while (readLine(line) && !line.empty()) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = line.substr(0, colon);
+        size_t v = line.find_first_not_of(' ', colon + 1);
+        String value(v == std::string::npos ? std::string() : line.substr(v));
+        if (strcasecmp(name.c_str(), "Content-Length") == 0) size_ = value.toInt();
+        for (auto& h : collected_) {
+            if (strcasecmp(h.first.c_str(), name.c_str()) == 0) h.second = value;
+        }
+    }
+    return code;
+}
+
+String HTTPClient::getString() {
+    std::string body;
+    uint8_t buf[512];
+    uint32_t start = millis();
+    while ((size_ < 0 || (int)body.size() < size_) && millis() - start < timeout_) {
+        int n = client_->available() ? client_->read(buf, sizeof(buf)) : -1;
+        if (n > 0) {
+            body.append((const char*)buf, n);
+            start = millis();
+        } else if (!client_->connected()) {
+            break;
+        } else {
+            yield();
+        }
+    }
+    return String(body);
+}
+
+String HTTPClient::header(const char* name) const {
+    for (const auto& h : collected_) {
+        if (strcasecmp(h.first.c_str(), name) == 0) return h.second;
+    }
+    return String();
+}
+
+void HTTPClient::end() {
+    if (client_) client_->stop();
+    size_ = -1;
+}
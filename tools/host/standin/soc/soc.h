@@ -0,0 +1,5 @@
+#pragma once
+
+// Register access is a no-op on the host
+#define WRITE_PERI_REG(addr, val) ((void)(addr), (void)(val))
+#define READ_PERI_REG(addr) (0)
@@ -0,0 +1,178 @@
+// aqi.h: band edges, the rounding gap between bands, saturation above the
+// tables, samples with pollutants missing (negative or NaN), and reference
+// values from the EPA AQI technical assistance document and the EEA bands.
+// Also times compute().
+
+#include <math.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <initializer_list>
+
+#include "aqi.h"
+#include "check.h"
+
+using namespace aqi;
+
+namespace {
+
+const Table& eu(Pollutant p) { return EU_TABLES[static_cast<size_t>(p)]; }
+const Table& us(Pollutant p) { return US_TABLES[static_cast<size_t>(p)]; }
+
+void bandEdges() {
+    // Every band's bounds map onto its index bounds
+    for (Scale s : {Scale::European, Scale::UsEpa}) {
+        for (size_t p = 0; p < POLLUTANT_COUNT; p++) {
+            const Table& t = tablesFor(s)[p];
+            for (uint8_t i = 0; i < t.count; i++) {
+                CHECK_EQ(subIndex(t, t.rows[i].cLo), t.rows[i].iLo);
+                CHECK_EQ(subIndex(t, t.rows[i].cHi), t.rows[i].iHi);
+            }
+        }
+    }
+    CHECK_EQ(subIndex(eu(Pollutant::PM25), 15), 30);
+    CHECK_EQ(subIndex(us(Pollutant::PM25), 9.0f), 50);
+
+    CHECK_EQ(levelOf(Scale::European, 19), 0);
+    CHECK_EQ(levelOf(Scale::European, 20), 1);
+    CHECK_EQ(levelOf(Scale::European, 100), 5);
+    CHECK_EQ(levelOf(Scale::UsEpa, 50), 0);
+    CHECK_EQ(levelOf(Scale::UsEpa, 51), 1);
+    CHECK_EQ(levelOf(Scale::UsEpa, 301), 5);
+}
+
+void roundingGap() {
+    // US PM2.5: 9.0 ends "Good", 9.1 starts "Moderate"; 9.05 is in neither
+    CHECK_EQ(subIndex(us(Pollutant::PM25), 9.05f), 51);
+    CHECK_EQ(subIndex(us(Pollutant::PM10), 54.5f), 51);
+    CHECK_EQ(subIndex(us(Pollutant::PM25), 35.45f), 101);
+}
+
+void saturation() {
+    CHECK_EQ(subIndex(eu(Pollutant::PM25), 5000), 1200);
+    CHECK_EQ(subIndex(us(Pollutant::PM25), 5000), 500);
+    CHECK_EQ(subIndex(us(Pollutant::CO), 1e9f), 500);
+    CHECK_EQ(subIndex(eu(Pollutant::PM25), INFINITY), 1200);
+    CHECK_EQ(levelOf(Scale::European, 1200), LEVEL_COUNT - 1);
+    // CO has no European table
+    CHECK_EQ(subIndex(eu(Pollutant::CO), 100000), 0);
+}
+
+void missingPollutants() {
+    CHECK_EQ(subIndex(eu(Pollutant::PM25), NAN), 0);
+    CHECK_EQ(subIndex(eu(Pollutant::PM25), -1), 0);
+
+    const Sample none = {NAN, NAN, NAN, NAN, NAN, NAN};
+    for (Scale s : {Scale::European, Scale::UsEpa}) {
+        Result r = compute(s, none);
+        CHECK(r.dominant == Pollutant::None);
+        CHECK_EQ(r.index, 0);
+        CHECK_EQ(r.level, 0);
+    }
+    const Sample absent = {-1, -1, -1, -1, -1, -1};
+    CHECK(compute(Scale::European, absent).dominant == Pollutant::None);
+    // Only CO, which the European index ignores
+    const Sample onlyCo = {NAN, NAN, NAN, NAN, NAN, 300};
+    CHECK(compute(Scale::European, onlyCo).dominant == Pollutant::None);
+    CHECK(compute(Scale::UsEpa, onlyCo).dominant == Pollutant::CO);
+
+    // A NaN next to valid values neither wins nor hides them
+    const Sample mixed = {NAN, 45, NAN, 10, -1, NAN};
+    Result r = compute(Scale::European, mixed);
+    CHECK(r.dominant == Pollutant::PM10);
+    CHECK_EQ(r.index, 50);
+    CHECK_EQ(r.level, 2);
+
+    // Clean air is a real "0 Good", not None
+    const Sample clean = {0, 0, 0, 0, 0, 0};
+    CHECK(compute(Scale::European, clean).dominant == Pollutant::PM25);
+}
+
+// The worked examples of EPA's Technical Assistance Document for the
+// Reporting of Daily Air Quality (PM2.5, O3 and CO), and values from its
+// equation as AirNow's calculator applies it: the interpolated index rounded
+// to the nearest integer
+void epaReference() {
+    CHECK_EQ(subIndex(us(Pollutant::PM25), 35.9f), 102);
+    CHECK_EQ(subIndex(us(Pollutant::O3), ppbToUgm3(78, MW_O3)), 126);      // 0.07853 ppm, truncated
+    CHECK_EQ(subIndex(us(Pollutant::CO), ppbToUgm3(8400, MW_CO)), 90);     // 8.4 ppm
+    CHECK_EQ(subIndex(us(Pollutant::PM10), 100), 73);
+
+    // PM2.5 2024 revision: "Good" ends at 9.0 instead of 12.0, so 12.0 is
+    // now Moderate 56 (it was 50); mid-band values of the new table
+    CHECK_EQ(subIndex(us(Pollutant::PM25), 12.0f), 56);
+    CHECK_EQ(subIndex(us(Pollutant::PM25), 20.0f), 71);
+    CHECK_EQ(subIndex(us(Pollutant::PM25), 100.0f), 182);
+    CHECK_EQ(subIndex(us(Pollutant::PM25), 150.0f), 225);
+    CHECK_EQ(levelOf(Scale::UsEpa, subIndex(us(Pollutant::PM25), 12.0f)), 1);
+
+    // O3 above the 8-hour table: 201-404 ppb snap to 301 (see aqi.h)
+    CHECK_EQ(subIndex(us(Pollutant::O3), ppbToUgm3(200, MW_O3)), 300);
+    CHECK_EQ(subIndex(us(Pollutant::O3), ppbToUgm3(201, MW_O3)), 301);
+    CHECK_EQ(subIndex(us(Pollutant::O3), ppbToUgm3(300, MW_O3)), 301);
+    CHECK_EQ(subIndex(us(Pollutant::O3), ppbToUgm3(404, MW_O3)), 301);
+    CHECK_EQ(subIndex(us(Pollutant::O3), ppbToUgm3(505, MW_O3)), 401);
+}
+
+// EEA European Air Quality Index bands (ug/m3): the level each
+// concentration falls in, and mid-band values on Open-Meteo's scale
+void eeaReference() {
+    struct Case { Pollutant p; float c; uint8_t level; };
+    const Case cases[] = {
+        {Pollutant::PM25, 5, 0},   {Pollutant::PM25, 15, 1},  {Pollutant::PM25, 22, 2},
+        {Pollutant::PM25, 30, 3},  {Pollutant::PM25, 60, 4},  {Pollutant::PM25, 100, 5},
+        {Pollutant::PM10, 30, 1},  {Pollutant::PM10, 120, 4},
+        {Pollutant::NO2, 100, 2},  {Pollutant::NO2, 300, 4},
+        {Pollutant::O3, 75, 1},    {Pollutant::O3, 200, 3},   {Pollutant::O3, 400, 5},
+        {Pollutant::SO2, 150, 1},  {Pollutant::SO2, 400, 3},
+    };
+    for (const Case& c : cases) {
+        CHECK_EQ(levelOf(Scale::European, subIndex(eu(c.p), c.c)), c.level);
+    }
+    CHECK_EQ(subIndex(eu(Pollutant::NO2), 65), 30);
+    CHECK_EQ(subIndex(eu(Pollutant::O3), 115), 50);
+    CHECK_EQ(subIndex(eu(Pollutant::PM10), 75), 70);
+
+    // The worst pollutant decides: PM10 Moderate, O3 Poor
+    const Sample s = {8, 45, 30, 200, 20, 400};
+    Result r = compute(Scale::European, s);
+    CHECK(r.dominant == Pollutant::O3);
+    CHECK_EQ(r.level, 3);
+}
+
+// Host ns per compute() over a spread of samples, both scales
+void benchmark() {
+    const int SAMPLES = 256, ROUNDS = 4000;
+    static Sample samples[SAMPLES];
+    uint32_t x = 1;
+    for (Sample& s : samples) {
+        for (float& c : s) {
+            x = x * 1664525 + 1013904223;
+            c = (x >> 8) % 4000 / 10.0f;      // 0-400 ug/m3
+        }
+    }
+    unsigned sink = 0;
+    for (Scale scale : {Scale::European, Scale::UsEpa}) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < ROUNDS; r++) {
+            for (const Sample& s : samples) sink += compute(scale, s).index;
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        printf("aqi_test: compute(%s) %.1f ns\n", scale == Scale::European ? "European" : "UsEpa",
+               ns / (ROUNDS * SAMPLES));
+    }
+    CHECK(sink > 0);
+}
+
+} // namespace
+
+int main() {
+    bandEdges();
+    roundingGap();
+    saturation();
+    missingPollutants();
+    epaReference();
+    eeaReference();
+    benchmark();
+    return checkResult("aqi_test");
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+// ==========================================
+// CHECKS
+// ==========================================
+// Minimal assertions for the host unit tests: each test is a main() that
+// runs its CHECKs, prints the failed ones with their location, and returns
+// checkResult() so ctest sees the failure.
+
+#include <stdio.h>
+
+namespace check {
+inline int& failures() {
+    static int n = 0;
+    return n;
+}
+} // namespace check
+
+#define CHECK(cond)                                                                \
+    do {                                                                           \
+        if (!(cond)) {                                                             \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            check::failures()++;                                                   \
+        }                                                                          \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                         \
+    do {                                                                                       \
+        long long va_ = (long long)(a), vb_ = (long long)(b);                                  \
+        if (va_ != vb_) {                                                                      \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, \
+                    #a, #b, va_, vb_);                                                         \
+            check::failures()++;                                                               \
+        }                                                                                      \
+    } while (0)
+
+inline int checkResult(const char* name) {
+    if (check::failures()) fprintf(stderr, "%s: %d checks failed\n", name, check::failures());
+    else printf("%s: ok\n", name);
+    return check::failures() ? 1 : 0;
+}
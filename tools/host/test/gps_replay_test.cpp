@@ -0,0 +1,93 @@
+// A drive through Gdansk from fixtures/gdansk-drive.nmea, fed into Serial2
+// one second of NMEA (RMC + GGA, as the NEO-6M sends them) at a time. The
+// real TinyGPSPlus parses it in the UART receive callback, and the position
+// moves src/main.cpp through the grid cells: cells not in the cell cache
+// are fetched, cells seen within CELL_CACHE_MAX_AGE come from the cache.
+//
+// The route, at 10 m/s after 5 s without a fix: Wrzeszcz to Gdansk Glowny,
+// then twice round a 3.5 km loop through the Main Town, which sits on the
+// corner (54.35 N, 18.65 E) where four 0.1 degree cells meet, then 30 s
+// parked.
+// One GGA sentence is corrupted, its checksum no longer matching.
+//
+//   boot     fallback position, cell 54.4/18.6            fetch
+//   425 s    54.4/18.7, 526 s 54.3/18.7, 598 s 54.3/18.6  fetch each
+//   674-952  the four cells again, 11 min or less later    cache
+//   1028 s   54.4/18.6, last fetched at boot (> 15 min)    fetch
+
+#include <Arduino.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "firmware.h"
+#include "gps_location.h"
+#include "host.h"
+
+extern GpsLocation gps;
+
+namespace {
+
+// "GET /v1/forecast?latitude=54.4000&longitude=18.6000..." -> "54.4000/18.6000"
+std::string requestedCell(const std::string& request) {
+    size_t lat = request.find("latitude=");
+    size_t lng = request.find("longitude=");
+    if (lat == std::string::npos || lng == std::string::npos) return "?";
+    lat += 9;
+    lng += 10;
+    return request.substr(lat, request.find('&', lat) - lat) + "/" +
+           request.substr(lng, request.find_first_of("& ", lng) - lng);
+}
+
+} // namespace
+
+int main() {
+    std::ifstream in(std::string(sim::defaultFixtures()) + "/gdansk-drive.nmea");
+    std::vector<std::string> seconds;       // each second's sentences, RMC first
+    std::string line;
+    uint32_t sentences = 0;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 6, "$GPRMC") == 0) seconds.emplace_back();
+        CHECK(!seconds.empty());
+        seconds.back() += line + "\n";      // getline keeps the '\r'
+        sentences++;
+    }
+    CHECK_EQ(seconds.size(), 1120);
+
+    ReplayServer replay;
+    if (!replay.load(sim::defaultFixtures())) return 1;
+    std::vector<std::string> fetched;
+    host::useVirtualClock(true);
+    host::setSerialOutput(false);
+    sim::serveApis(replay);
+    host::serve(weatherApiHost, [&](const std::string& request) {
+        fetched.push_back(requestedCell(request));
+        return replay(request);
+    });
+    updateInterval = 3600000;       // only cell changes sync
+    // As on the board, loop() does not start at millis() 0, which
+    // lastUpdateTimestamp reserves for "never synced"
+    host::advance(1000);
+
+    setup();
+    const uint32_t start = millis();
+    for (size_t s = 0; s < seconds.size(); s++) {
+        host::uartReceive(Serial2, seconds[s]);
+        while (millis() - start < (s + 1) * 1000) loop();
+    }
+
+    const std::vector<std::string> expected = {
+        "54.4000/18.6000", "54.4000/18.7000", "54.3000/18.7000", "54.3000/18.6000", "54.4000/18.6000"};
+    CHECK(fetched == expected);
+    for (const std::string& cell : fetched) printf("gps_replay_test: fetched %s\n", cell.c_str());
+    CHECK_EQ(syncStats.cycles, 5);
+    CHECK_EQ(syncStats.cacheHits, 4);
+    CHECK_EQ(syncStats.failedRequests, 0);
+    // 5 s of sentences without a fix, and the corrupted GGA
+    CHECK_EQ(gps.fixes(), sentences - 2 * 5 - 1);
+    printf("gps_replay_test: %u sentences, %u fixes, %u fetches, %u cache hits\n", (unsigned)sentences,
+           (unsigned)gps.fixes(), (unsigned)fetched.size(), (unsigned)syncStats.cacheHits);
+    return checkResult("gps_replay_test");
+}
@@ -0,0 +1,115 @@
+// A gzip response that inflates past GZIP_JSON_WINDOW: GzipStream reports
+// it as an overflow (not as a broken stream), and src/main.cpp fetches the
+// same response again uncompressed, uploads its reading and asks for
+// identity from then on.
+
+#include <Arduino.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "check.h"
+#include "firmware.h"
+#include "gzip_stream.h"
+#include "host.h"
+
+namespace {
+
+constexpr size_t GZIP_JSON_WINDOW = 4096;      // as configured in src/main.cpp
+
+// A response body, read byte by byte like ResponseStream
+class BodyStream : public Stream {
+public:
+    explicit BodyStream(const std::string& body) : body_(body) {}
+    int available() override { return body_.size() - pos_; }
+    int read() override { return pos_ < body_.size() ? (uint8_t)body_[pos_++] : -1; }
+    int peek() override { return pos_ < body_.size() ? (uint8_t)body_[pos_] : -1; }
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    const std::string& body_;
+    size_t pos_ = 0;
+};
+
+// The recorded forecast with a week of hourly data ahead of "current", as
+// a request for &hourly= would return it
+std::string withHourly(const std::string& forecast) {
+    std::string hourly = "\"hourly\":{\"temperature_2m\":[";
+    for (int h = 0; h < 168; h++) hourly += (h ? "," : "") + std::to_string(10 + h % 24 * 0.35);
+    hourly += "],\"surface_pressure\":[";
+    for (int h = 0; h < 168; h++) hourly += (h ? "," : "") + std::to_string(1008 + h % 13 * 0.7);
+    hourly += "]},";
+    std::string body = forecast;
+    body.insert(body.find("\"current\":"), hourly);
+    return body;
+}
+
+void overflowIsNotFailure(const std::string& large) {
+    const std::string gz = gzipCompress(large);
+    char buf[256];
+
+    BodyStream whole(gz);
+    GzipStream inflated(whole, GZIP_JSON_WINDOW);
+    CHECK(inflated.begin());
+    size_t out = 0, n;
+    while ((n = inflated.readBytes(buf, sizeof(buf))) > 0) out += n;
+    CHECK_EQ(out, GZIP_JSON_WINDOW);
+    CHECK(inflated.failed());
+    CHECK(inflated.overflowed());
+
+    const std::string cut = gz.substr(0, gz.size() / 4);
+    BodyStream truncated(cut);
+    GzipStream broken(truncated, GZIP_JSON_WINDOW);
+    CHECK(broken.begin());
+    while (broken.readBytes(buf, sizeof(buf)) > 0) {}
+    CHECK(broken.failed());
+    CHECK(!broken.overflowed());
+}
+
+} // namespace
+
+int main() {
+    ReplayServer replay;
+    if (!replay.load(sim::defaultFixtures())) return 1;
+    std::ifstream in(std::string(sim::defaultFixtures()) + "/forecast.json");
+    std::ostringstream forecast;
+    forecast << in.rdbuf();
+    const std::string large = withHourly(forecast.str());
+    CHECK(large.size() > GZIP_JSON_WINDOW);
+    overflowIsNotFailure(large);
+    replay.setFixture("forecast.json", large);
+
+    std::string upload;
+    size_t uploadBytes = 0;
+    host::useVirtualClock(true);
+    sim::serveApis(replay);
+    host::serve(thingSpeakHost, [&](const std::string& request) {
+        upload = request.substr(0, request.find("\r\n"));
+        uploadBytes += request.size();
+        return replay(request);
+    });
+    updateInterval = 900000;        // past the cell cache: every cycle fetches
+
+    setup();
+    CHECK(sim::runUntilCycle(1, 120000));
+    CHECK_EQ(syncStats.gzipFallbacks, 1);
+    CHECK_EQ(syncStats.parseErrors, 0);
+    CHECK_EQ(syncStats.failedRequests, 0);
+    const std::string temperature = "&field" +
+        std::to_string(THINGSPEAK_FIELD[metricIndex(Metric::Temperature)]) + "=15.10";
+    CHECK(upload.find(temperature) != std::string::npos);
+
+    // Later cycles ask for identity: no gzip response, no further fallback
+    const uint32_t gzipResponses = syncStats.gzipResponses;
+    const uint32_t requests = replay.requests();
+    CHECK(sim::runUntilCycle(3, 2 * updateInterval + 120000));
+    CHECK_EQ(syncStats.gzipFallbacks, 1);
+    CHECK_EQ(syncStats.gzipResponses, gzipResponses);
+    CHECK_EQ(syncStats.parseErrors, 0);
+    CHECK_EQ(replay.requests() - requests, 2 * 3);
+    CHECK(upload.find(temperature) != std::string::npos);
+    // The uplink counts what it sent, not an estimate
+    CHECK_EQ(syncStats.uplinkBytes, uploadBytes);
+    return checkResult("gzip_fallback_test");
+}
@@ -0,0 +1,113 @@
+// JSON_ARENA_SIZE against the recorded API responses (fixtures/): each JSON
+// body is parsed the way fetchJson() does it, from a Stream with the
+// "current" filter into a JsonDocument on a JSON_ARENA_SIZE arena, and each
+// FlatBuffers body is received into it whole, as fetchFlatBuffer() does.
+// The arena must hold the largest with ARENA_MARGIN to spare, and parsing
+// must not touch the (device) heap.
+//
+// air-quality-hourly.json is the worst case the station can be sent: the
+// same request with a week of hourly data for all six variables (9 KB, some
+// hours null) behind "current". The filter should drop the hourly block
+// without storing it, so its high water should match air-quality.json's;
+// a record of the real API under that name (see README) replaces it.
+//
+// Slots and pointers are twice as wide here as on the ESP32, so the high
+// water printed overstates the board's; the margin is kept against it.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "check.h"
+#include "firmware.h"
+#include "host.h"
+#include "json_arena.h"
+
+namespace {
+
+constexpr size_t ARENA_MARGIN = 2;      // JSON_ARENA_SIZE >= margin x high water
+
+alignas(8) uint8_t arenaBuf[JSON_ARENA_SIZE];
+JsonArena arena(arenaBuf, sizeof(arenaBuf));
+size_t largest = 0;
+
+// A response body, read byte by byte like ResponseStream
+class BodyStream : public Stream {
+public:
+    explicit BodyStream(const std::string& body) : body_(body) {}
+    int available() override { return body_.size() - pos_; }
+    int read() override { return pos_ < body_.size() ? (uint8_t)body_[pos_++] : -1; }
+    int peek() override { return pos_ < body_.size() ? (uint8_t)body_[pos_] : -1; }
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    const std::string& body_;
+    size_t pos_ = 0;
+};
+
+std::string fixture(const char* name) {
+    std::ifstream in(std::string(sim::defaultFixtures()) + "/" + name, std::ios::binary);
+    std::ostringstream body;
+    body << in.rdbuf();
+    CHECK(in.good() || in.eof());
+    return body.str();
+}
+
+void record(const char* name, size_t highWater) {
+    printf("json_arena_test: %-23s high water %5zu B\n", name, highWater);
+    if (highWater > largest) largest = highWater;
+}
+
+void parseJson(const char* name) {
+    const std::string body = fixture(name);
+    CHECK(!body.empty());
+
+    arena = JsonArena(arenaBuf, sizeof(arenaBuf));
+    host::useDeviceHeap(true);
+    uint64_t allocations = host::heapStats().allocations;
+    bool ok;
+    {
+        BodyStream stream(body);
+        JsonDocument doc(&arena);
+        JsonDocument filter(&arena);
+        filter["current"] = true;
+        DeserializationError err = deserializeJson(doc, stream, DeserializationOption::Filter(filter));
+        ok = !err && doc["current"].is<JsonObject>();
+    }
+    CHECK_EQ(host::heapStats().allocations - allocations, 0);
+    host::useDeviceHeap(false);
+
+    CHECK(ok);
+    CHECK_EQ(arena.overflows(), 0);
+    record(name, arena.highWater());
+}
+
+void receiveFlatBuffer(const char* name) {
+    const std::string body = fixture(name);
+    CHECK(!body.empty());
+
+    arena = JsonArena(arenaBuf, sizeof(arenaBuf));
+    void* buf = arena.allocate(body.size());
+    CHECK(buf != nullptr);
+    CHECK_EQ(arena.overflows(), 0);
+    record(name, arena.highWater());
+}
+
+} // namespace
+
+int main() {
+    parseJson("forecast.json");
+    parseJson("air-quality.json");
+    parseJson("air-quality-hourly.json");
+    receiveFlatBuffer("forecast.fb");
+    receiveFlatBuffer("air-quality.fb");
+
+    printf("json_arena_test: arena %zu B = %.1fx the largest (margin %zux)\n",
+           JSON_ARENA_SIZE, (double)JSON_ARENA_SIZE / largest, ARENA_MARGIN);
+    CHECK(largest > 0);
+    CHECK(largest * ARENA_MARGIN <= JSON_ARENA_SIZE);
+    return checkResult("json_arena_test");
+}
@@ -0,0 +1,142 @@
+// metrics_server.h against slow scrapers: connections whose send buffer
+// holds only a few bytes (host::dial's window) and that read rarely. No
+// poll() may write more than the socket takes, nothing may be lost, and
+// the responses must match what a fast scraper gets.
+
+#include <lvgl.h>
+#include <math.h>
+#include <string.h>
+
+#include <string>
+
+#include "check.h"
+#include "host.h"
+#include "metrics_server.h"
+
+namespace {
+
+float values[METRIC_COUNT] = {12.5f, 1013.2f, 8, 14, NAN, 2.5f, 61, 240};
+StatsTable stats;
+ReadingLog history;
+SyncStats sync = {};
+MetricsServer server(80);
+
+struct Scrape {
+    std::string response;
+    uint32_t polls;
+    bool closed;
+};
+
+// Request path on a connection with the given send window, reading
+// whatever arrived every readEvery polls
+Scrape scrape(const char* path, size_t window, uint32_t readEvery, uint32_t maxPolls = 100000) {
+    WiFiClient client = host::dial(80, window);
+    client.printf("GET %s HTTP/1.1\r\nHost: station\r\n\r\n", path);
+    Scrape s = {std::string(), 0, false};
+    for (; s.polls < maxPolls; s.polls++) {
+        server.poll();
+        // The server end never has more in flight than the window
+        CHECK(client.available() <= (int)window);
+        if (s.polls % readEvery == 0) {
+            uint8_t buf[256];
+            int n;
+            while ((n = client.read(buf, sizeof(buf))) > 0) s.response.append((const char*)buf, n);
+        }
+        if (!client.connected()) {
+            s.closed = true;
+            break;
+        }
+    }
+    client.stop();
+    return s;
+}
+
+// Payload of a chunked body, or "" if the framing is broken
+std::string dechunk(const std::string& response) {
+    size_t p = response.find("\r\n\r\n");
+    if (p == std::string::npos) return std::string();
+    p += 4;
+    std::string out;
+    for (;;) {
+        size_t eol = response.find("\r\n", p);
+        if (eol == std::string::npos) return std::string();
+        size_t n = strtoul(response.c_str() + p, nullptr, 16);
+        p = eol + 2;
+        if (n == 0) return response.compare(p, std::string::npos, "\r\n") == 0 ? out : std::string();
+        if (p + n + 2 > response.size() || response.compare(p + n, 2, "\r\n") != 0) return std::string();
+        out.append(response, p, n);
+        p += n + 2;
+    }
+}
+
+size_t countLines(const std::string& s) {
+    size_t n = 0;
+    for (char ch : s) n += ch == '\n';
+    return n;
+}
+
+void metrics() {
+    Scrape fast = scrape("/metrics", 1 << 20, 1);
+    CHECK(fast.closed);
+    CHECK(fast.response.compare(0, 15, "HTTP/1.1 200 OK") == 0);
+    CHECK(fast.response.find("station_reading{metric=\"pm2_5\",unit=\"ug/m3\"} 8.0\n") != std::string::npos);
+    CHECK(fast.response.find("station_reading{metric=\"nitrogen_dioxide\"") == std::string::npos);
+    CHECK(fast.response.find("station_reading_ewma{metric=\"temperature_2m\",unit=\"C\"} 12.50\n") != std::string::npos);
+    CHECK(fast.response.find("# TYPE station_uptime_seconds gauge\n") != std::string::npos);
+    CHECK(fast.response.find("station_history_records 300\n") != std::string::npos);
+    CHECK(fast.response.size() > 2000);
+
+    // A few bytes per poll, read every fifth poll: same bytes, many polls
+    Scrape slow = scrape("/metrics", 48, 5);
+    CHECK(slow.closed);
+    CHECK(slow.response == fast.response);
+    CHECK(slow.polls > fast.response.size() / 48);
+
+    // A scraper that never reads is dropped after the idle timeout, and
+    // the server keeps answering others meanwhile
+    WiFiClient stuck = host::dial(80, 16);
+    stuck.print("GET /metrics HTTP/1.1\r\n\r\n");
+    server.poll();
+    Scrape other = scrape("/metrics", 1 << 20, 1);
+    CHECK(other.response == fast.response);
+    host::advance(HTTP_IDLE_TIMEOUT_MS + 1);
+    server.poll();
+    CHECK(!stuck.connected() || stuck.available() <= 16);
+    uint8_t drain[64];
+    while (stuck.read(drain, sizeof(drain)) > 0) {}
+    CHECK(!stuck.connected());
+}
+
+void readings() {
+    Scrape fast = scrape("/readings?format=csv", 1 << 20, 1);
+    CHECK(fast.closed);
+    std::string csv = dechunk(fast.response);
+    CHECK_EQ(countLines(csv), history.recordCount() + 1);     // + header
+
+    Scrape slow = scrape("/readings?format=csv", 40, 3);
+    CHECK(slow.closed);
+    CHECK(dechunk(slow.response) == csv);
+
+    Scrape json = scrape("/readings?format=json&since=1700009000", 33, 2);
+    std::string body = dechunk(json.response);
+    CHECK(body.size() > 2 && body.front() == '[' && body.back() == ']');
+}
+
+} // namespace
+
+int main() {
+    host::useVirtualClock(true);
+    lv_init();
+    for (size_t m = 0; m < METRIC_COUNT; m++) stats[m].add(values[m], 0);
+    Reading r;
+    for (int i = 0; i < 300; i++) {
+        r.timestamp = 1700000000 + 60 * i;
+        for (size_t m = 0; m < METRIC_COUNT; m++) r.value[m] = values[m] + (i % 10) / 10.0f;
+        history.append(r);
+    }
+    server.begin(values, stats, history, sync);
+
+    metrics();
+    readings();
+    return checkResult("metrics_server_test");
+}
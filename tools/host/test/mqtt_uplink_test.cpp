@@ -0,0 +1,149 @@
+// MqttUplink (the real PubSubClient underneath) against the in-process
+// broker stand-in (sim/mqtt_broker.h) over a link with a 50 ms round trip,
+// on the virtual clock:
+//
+//   - connects with clean session off; a reconnect resumes the session
+//   - samples published while the broker is gone are queued, survive
+//     refused reconnects (with backoff), and drain in order afterwards
+//   - a full queue drops the oldest samples
+//   - keep-alive pings once the connection is idle
+//   - stats().bytesOut is what the broker received, byte for byte
+//
+// Bytes and time per sample are printed for comparison with the ThingSpeak
+// GET (sync_bench: "uplink B" and "upload ms").
+
+#include <Arduino.h>
+
+#include <string>
+
+#include "check.h"
+#include "host.h"
+#include "mqtt_broker.h"
+#include "mqtt_uplink.h"
+
+namespace {
+
+const char* const BROKER = "broker.test";
+const char* const TOPIC = "station/gdansk/readings";
+constexpr uint32_t RTT_MS = 50;
+
+MqttBroker broker;
+MqttUplink uplink;
+uint32_t sampleTime = 1760000000;
+
+Reading sample() {
+    Reading r;
+    r.timestamp = sampleTime++;
+    for (size_t m = 0; m < METRIC_COUNT; m++) r.value[m] = 10.5f + m;
+    return r;
+}
+
+// Time publish() holds loop() for
+uint32_t publishMs() {
+    uint32_t start = millis();
+    uplink.publish(sample());
+    return millis() - start;
+}
+
+// loop() every 100 ms until connected, at most timeoutMs
+bool reconnectWithin(uint32_t timeoutMs) {
+    uint32_t start = millis();
+    while (!uplink.connected()) {
+        if (millis() - start > timeoutMs) return false;
+        uplink.loop();
+        host::advance(100);
+    }
+    return true;
+}
+
+uint32_t timestampOf(const MqttBroker::Message& m) { return strtoul(m.payload.c_str(), nullptr, 10); }
+
+bool inOrder(size_t from) {
+    for (size_t i = from + 1; i < broker.messages().size(); i++) {
+        if (timestampOf(broker.messages()[i]) != timestampOf(broker.messages()[i - 1]) + 1) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    host::useVirtualClock(true);
+    host::setSerialOutput(false);
+    host::setWifiConnected(true);
+    host::setLink(host::Link{RTT_MS, 0});
+    host::serveStream(BROKER, [](uint32_t connection, WiFiClient& client) { broker(connection, client); });
+
+    uplink.begin(BROKER, 1883, "cyd-station-gdansk", nullptr, nullptr, TOPIC);
+    uint32_t start = millis();
+    uplink.loop();
+    uint32_t connectMs = millis() - start;
+    CHECK(uplink.connected());
+    CHECK_EQ(broker.connects(), 1);
+    CHECK_EQ(broker.sessionsResumed(), 0);
+
+    // Connected: each sample goes out at once, no round trip
+    uint32_t bytesBefore = uplink.stats().bytesOut;
+    uint32_t worstMs = 0;
+    for (int i = 0; i < 10; i++) worstMs = std::max(worstMs, publishMs());
+    CHECK_EQ(broker.messages().size(), 10);
+    CHECK(broker.messages()[0].topic == TOPIC);
+    CHECK(inOrder(0));
+    const uint32_t bytesPerSample = (uplink.stats().bytesOut - bytesBefore) / 10;
+    printf("mqtt_uplink_test: connect %u ms, %u B per sample, publish %u ms per sample (worst), payload \"%s\"\n",
+           (unsigned)connectMs, (unsigned)bytesPerSample, (unsigned)worstMs, broker.messages()[0].payload.c_str());
+
+    // Broker lost, then refusing for 10 s: samples queue up
+    broker.drop();
+    broker.refuse(true);
+    for (int i = 0; i < 5; i++) {
+        publishMs();
+        for (int t = 0; t < 20; t++) {
+            uplink.loop();
+            host::advance(100);
+        }
+    }
+    CHECK(!uplink.connected());
+    CHECK_EQ(uplink.queued(), 5);
+    CHECK_EQ(broker.messages().size(), 10);
+    const uint32_t refusedConnects = broker.connects() - 1;
+    CHECK(refusedConnects >= 2 && refusedConnects <= 4);   // 1 s, 2 s, 4 s backoff
+
+    // Back: the session resumes and the queue drains in order
+    broker.refuse(false);
+    start = millis();
+    CHECK(reconnectWithin(70000));
+    const uint32_t drainMs = millis() - start;
+    CHECK_EQ(broker.sessionsResumed(), 1);
+    CHECK_EQ(uplink.queued(), 0);
+    CHECK_EQ(broker.messages().size(), 15);
+    CHECK(inOrder(0));
+    CHECK(broker.messages()[10].connection != broker.messages()[9].connection);
+    printf("mqtt_uplink_test: %u refused reconnects, drained 5 queued samples %u ms after the broker came back\n",
+           (unsigned)refusedConnects, (unsigned)drainMs);
+
+    // A longer outage overflows the queue: the oldest samples go
+    broker.drop();
+    const uint32_t dropped = uplink.stats().dropped;
+    for (uint32_t i = 0; i < MQTT_QUEUE_LEN + 3; i++) publishMs();
+    CHECK_EQ(uplink.stats().dropped - dropped, 3);
+    CHECK(reconnectWithin(70000));
+    CHECK_EQ(broker.sessionsResumed(), 2);
+    CHECK_EQ(broker.messages().size(), 15 + MQTT_QUEUE_LEN);
+    CHECK_EQ(timestampOf(broker.messages()[15]), timestampOf(broker.messages()[14]) + 4);
+    CHECK(inOrder(15));
+
+    // Idle past the keep-alive: PubSubClient pings
+    for (uint32_t t = 0; t < (MQTT_KEEPALIVE_S + 5) * 10; t++) {
+        uplink.loop();
+        host::advance(100);
+    }
+    CHECK(uplink.connected());
+    CHECK(broker.pings() >= 1);
+
+    CHECK_EQ(uplink.stats().bytesOut, broker.bytesReceived());
+    printf("mqtt_uplink_test: %u connects (%u sessions resumed), %u pings, %u B sent in all\n",
+           (unsigned)broker.connects(), (unsigned)broker.sessionsResumed(), (unsigned)broker.pings(),
+           (unsigned)uplink.stats().bytesOut);
+    return checkResult("mqtt_uplink_test");
+}
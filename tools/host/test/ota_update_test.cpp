@@ -0,0 +1,170 @@
+// ota_update.h against a fake flash (standin/flash.cpp) and a manifest
+// server: an image is installed only when its SHA-256 matches, a release
+// that never becomes healthy is rolled back once and not installed again,
+// and a higher release after it still is.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <mbedtls/sha256.h>
+#include <string.h>
+#include <zlib.h>
+
+#include <map>
+#include <string>
+
+#include "check.h"
+#include "host.h"
+#include "ota_update.h"
+
+namespace {
+
+const char* MANIFEST_URL = "http://ota.local/manifest.txt";
+
+std::map<std::string, std::string> files;       // path -> body
+std::map<std::string, int> downloads;           // path -> requests
+
+host::Reply serveFile(const std::string& request) {
+    size_t sp = request.find(' ');
+    std::string path = request.substr(sp + 1, request.find(' ', sp + 1) - sp - 1);
+    downloads[path]++;
+    host::Reply r;
+    auto it = files.find(path);
+    if (it == files.end()) {
+        r.bytes = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+        return r;
+    }
+    r.bytes = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(it->second.size()) + "\r\n\r\n" + it->second;
+    return r;
+}
+
+std::string sha256Hex(const std::string& data) {
+    mbedtls_sha256_context ctx;
+    unsigned char digest[32];
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    mbedtls_sha256_update(&ctx, (const unsigned char*)data.data(), data.size());
+    mbedtls_sha256_finish(&ctx, digest);
+    mbedtls_sha256_free(&ctx);
+    char hex[65];
+    for (int i = 0; i < 32; i++) snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+    return hex;
+}
+
+std::string gzip(const std::string& data) {
+    z_stream zs = {};
+    deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&zs, data.size()), '\0');
+    zs.next_in = (Bytef*)data.data();
+    zs.avail_in = data.size();
+    zs.next_out = (Bytef*)&out[0];
+    zs.avail_out = out.size();
+    deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return out;
+}
+
+// A firmware image: the ESP32 magic byte, then content that compresses
+// about as well as code does
+std::string image(uint32_t version) {
+    std::string img(1, (char)0xE9);
+    uint32_t x = version * 2654435761u;
+    while (img.size() < 48 * 1024) {
+        x = x * 1664525 + 1013904223;
+        img += (char)((x >> 24) % 24 + 'a');
+        if (x % 7 == 0) img += "mov a2, a3; call8 ";
+    }
+    return img;
+}
+
+// Publishes version with the SHA-256 of shaOf (the image itself unless a
+// mismatch is wanted)
+void publish(uint32_t version, const std::string& img, const std::string& shaOf) {
+    std::string path = "/fw-" + std::to_string(version) + ".bin.gz";
+    files[path] = gzip(img);
+    files["/manifest.txt"] = std::to_string(version) + " " + sha256Hex(shaOf) + " http://ota.local" + path + "\n";
+}
+
+// One boot running firmware version: checkBoot() as early in setup(), then
+// the first manifest check. True if the board restarted. markHealthy()
+// acts once per process (once per boot on the board), so only the last
+// release confirms.
+bool boot(uint32_t version, bool healthy = false) {
+    host::rebootFlash();
+    try {
+        OtaUpdater::checkBoot();
+        if (healthy) OtaUpdater::markHealthy();
+        OtaUpdater ota;
+        ota.begin(MANIFEST_URL, version);
+        host::advance(OTA_FIRST_CHECK);
+        ota.poll();
+    } catch (const host::Restart&) {
+        return true;
+    }
+    return false;
+}
+
+void sha256KnownAnswer() {
+    CHECK(sha256Hex("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    CHECK(sha256Hex(std::string(1000, 'a')) == "41edece42d63e8d9bf515a9ba6932e1c20cbc9f5a5d134645adb5db1b9737ea3");
+}
+
+void installAndRollback() {
+    // Running 5 from app0; 6 is published
+    const std::string v6 = image(6);
+    publish(6, v6, v6);
+    CHECK(boot(5));
+    CHECK_EQ(host::flash().boot, 1);
+    CHECK(host::flash().image[1] == v6);
+
+    // 6 never reaches its first successful sync
+    for (uint8_t i = 0; i < OTA_TRIAL_BOOTS; i++) {
+        CHECK(!boot(6));
+        CHECK_EQ(host::flash().running, 1);
+    }
+    CHECK(boot(6));
+    CHECK_EQ(host::flash().boot, 0);
+
+    // Back on 5, with 6 still in the manifest: nothing is downloaded
+    for (int i = 0; i < 3; i++) {
+        CHECK(!boot(5));
+        CHECK_EQ(host::flash().running, 0);
+    }
+    CHECK_EQ(downloads["/fw-6.bin.gz"], 1);
+    CHECK_EQ(downloads["/manifest.txt"], 1 + OTA_TRIAL_BOOTS + 3);
+}
+
+void hashMismatch() {
+    // 7 published with the hash of another image: written, then discarded
+    const std::string v7 = image(7);
+    publish(7, v7, image(70));
+    CHECK(!boot(5));
+    CHECK_EQ(host::flash().boot, 0);
+    CHECK(host::flash().image[1].empty());
+    CHECK_EQ(downloads["/fw-7.bin.gz"], 1);
+
+    // Corrected, 7 installs: only rolled-back versions are skipped
+    publish(7, v7, v7);
+    CHECK(boot(5));
+    CHECK_EQ(host::flash().boot, 1);
+
+    // and, once healthy, stays
+    for (uint8_t i = 0; i < OTA_TRIAL_BOOTS + 2; i++) {
+        CHECK(!boot(7, true));
+        CHECK_EQ(host::flash().running, 1);
+    }
+}
+
+} // namespace
+
+int main() {
+    host::useVirtualClock(true);
+    host::catchRestart(true);
+    host::setWifiConnected(true);
+    host::serve("ota.local", serveFile);
+
+    sha256KnownAnswer();
+    installAndRollback();
+    hashMismatch();
+    return checkResult("ota_update_test");
+}
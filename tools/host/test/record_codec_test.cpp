@@ -0,0 +1,249 @@
+// record_codec.h: records survive encode/decode exactly (to the fixed-point
+// resolution) across keyframes, zig-zag extremes and missing metrics, and
+// truncated or malformed input is rejected without disturbing the decoder.
+// The ReadingLog part checks cursors against what was appended, through
+// block recycling.
+
+#include <math.h>
+#include <string.h>
+
+#include <vector>
+
+#include "check.h"
+#include "record_codec.h"
+
+namespace {
+
+uint32_t rng = 2463534242u;
+uint32_t random32() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+Reading reading(uint32_t t, float base) {
+    Reading r;
+    r.timestamp = t;
+    for (size_t m = 0; m < METRIC_COUNT; m++) r.value[m] = base + m;
+    return r;
+}
+
+// Same value within half a fixed-point step (plus float rounding of the
+// scaling), or both missing
+bool sameValue(float a, float b, size_t m) {
+    if (isnan(a) || isnan(b)) return isnan(a) && isnan(b);
+    return fabsf(a - b) <= 0.5f / RECORD_SCALE[m] + 1e-5f * (1 + fabsf(b));
+}
+
+bool same(const Reading& a, const Reading& b) {
+    if (a.timestamp != b.timestamp) return false;
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        if (!sameValue(a.value[m], b.value[m], m)) return false;
+    }
+    return true;
+}
+
+// Encodes rs into one stream (keyframe every keyEvery records, 0 = first only)
+std::vector<uint8_t> encodeAll(const std::vector<Reading>& rs, size_t keyEvery) {
+    RecordEncoder enc;
+    std::vector<uint8_t> out;
+    for (size_t i = 0; i < rs.size(); i++) {
+        uint8_t buf[RECORD_MAX_SIZE];
+        size_t n = enc.encode(rs[i], buf, sizeof(buf), keyEvery && i % keyEvery == 0);
+        CHECK(n > 0 && n <= RECORD_MAX_SIZE);
+        out.insert(out.end(), buf, buf + n);
+    }
+    return out;
+}
+
+void decodeAll(const std::vector<uint8_t>& bytes, const std::vector<Reading>& expect) {
+    RecordDecoder dec;
+    size_t pos = 0;
+    for (const Reading& e : expect) {
+        Reading r;
+        size_t n = dec.decode(bytes.data() + pos, bytes.size() - pos, r);
+        CHECK(n > 0);
+        if (!n) return;
+        CHECK(same(r, e));
+        if (!same(r, e)) return;
+        pos += n;
+    }
+    CHECK_EQ(pos, bytes.size());
+}
+
+void randomWalk() {
+    std::vector<Reading> rs;
+    Reading r = reading(1700000000, 10);
+    for (int i = 0; i < 20000; i++) {
+        r.timestamp += 60 + random32() % 3;
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            r.value[m] += ((int)(random32() % 201) - 100) / 100.0f;
+            // Now and then a metric drops out and comes back
+            if (random32() % 40 == 0) r.value[m] = isnan(r.value[m]) ? 0 : NAN;
+        }
+        rs.push_back(r);
+    }
+    for (size_t keyEvery : {0, 1, 7, 100}) decodeAll(encodeAll(rs, keyEvery), rs);
+}
+
+void keyframes() {
+    RecordEncoder enc;
+    uint8_t a[RECORD_MAX_SIZE], b[RECORD_MAX_SIZE], c[RECORD_MAX_SIZE];
+    size_t na = enc.encode(reading(1000, 1), a, sizeof(a));
+    size_t nb = enc.encode(reading(1060, 2), b, sizeof(b));
+    size_t nc = enc.encode(reading(900, 3), c, sizeof(c));     // time ran backwards
+    CHECK(a[0] & 1);
+    CHECK(!(b[0] & 1));
+    CHECK(c[0] & 1);
+
+    // A delta record cannot start a stream
+    RecordDecoder dec;
+    Reading r;
+    CHECK_EQ(dec.decode(b, nb, r), 0);
+    CHECK_EQ(dec.decode(a, na, r), na);
+    CHECK(same(r, reading(1000, 1)));
+    CHECK_EQ(dec.decode(b, nb, r), nb);
+    CHECK(same(r, reading(1060, 2)));
+    CHECK_EQ(dec.decode(c, nc, r), nc);
+    CHECK(same(r, reading(900, 3)));
+
+    // reset() forgets the previous record on both sides
+    enc.reset();
+    dec.reset();
+    nb = enc.encode(reading(2000, 4), b, sizeof(b));
+    CHECK(b[0] & 1);
+    CHECK_EQ(dec.decode(b, nb, r), nb);
+    CHECK(same(r, reading(2000, 4)));
+}
+
+void extremes() {
+    // Saturated fixed point, and deltas between the extremes that only
+    // round-trip through the wrapping arithmetic
+    std::vector<Reading> rs;
+    const float big = 2147483520.0f / 100;  // largest temperature that fits
+    float seq[] = {0, big, -big, big, 1e30f, -1e30f, INFINITY, -INFINITY, 0, -0.004f, 0.004f};
+    uint32_t t = 0;
+    for (float v : seq) {
+        Reading r;
+        r.timestamp = t;
+        t = t ? t * 3 : 1;
+        for (size_t m = 0; m < METRIC_COUNT; m++) r.value[m] = v;
+        rs.push_back(r);
+    }
+    rs.back().timestamp = UINT32_MAX;       // largest time delta
+    std::vector<uint8_t> bytes = encodeAll(rs, 0);
+
+    RecordDecoder dec;
+    size_t pos = 0;
+    for (size_t i = 0; i < rs.size(); i++) {
+        Reading r;
+        size_t n = dec.decode(bytes.data() + pos, bytes.size() - pos, r);
+        CHECK(n > 0);
+        if (!n) return;
+        pos += n;
+        CHECK_EQ(r.timestamp, rs[i].timestamp);
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            // What the encoder can hold: the value clamped to int32 fixed point
+            float lim = 2147483520.0f / RECORD_SCALE[m];
+            float want = fmaxf(-2147483648.0f / RECORD_SCALE[m], fminf(lim, rs[i].value[m]));
+            CHECK(fabsf(r.value[m] - want) <= fabsf(want) * 1e-6f + 0.5f / RECORD_SCALE[m]);
+        }
+    }
+}
+
+void missing() {
+    Reading none;
+    none.timestamp = 5;
+    for (float& v : none.value) v = NAN;
+    Reading some = none;
+    some.timestamp = 65;
+    some.value[metricIndex(Metric::PM25)] = 12.3f;
+    std::vector<Reading> rs = {none, some, none, some};
+    std::vector<uint8_t> bytes = encodeAll(rs, 0);
+    decodeAll(bytes, rs);
+    // flags, mask and a one-byte time: nothing else for an empty record
+    RecordEncoder enc;
+    uint8_t buf[RECORD_MAX_SIZE];
+    CHECK_EQ(enc.encode(none, buf, sizeof(buf)), 3);
+}
+
+void truncated() {
+    RecordEncoder enc;
+    uint8_t key[RECORD_MAX_SIZE], delta[RECORD_MAX_SIZE];
+    Reading k = reading(1700000000, 1000), d = reading(1700000060, -1000);
+    size_t nk = enc.encode(k, key, sizeof(key));
+    size_t nd = enc.encode(d, delta, sizeof(delta));
+
+    RecordDecoder dec;
+    Reading r;
+    for (size_t len = 0; len < nk; len++) CHECK_EQ(dec.decode(key, len, r), 0);
+    CHECK_EQ(dec.decode(key, nk, r), nk);
+    // A cut-off delta leaves the state alone: the whole record still decodes
+    for (size_t len = 0; len < nd; len++) CHECK_EQ(dec.decode(delta, len, r), 0);
+    CHECK_EQ(dec.decode(delta, nd, r), nd);
+    CHECK(same(r, d));
+
+    // Over-long varint (more than 5 bytes)
+    const uint8_t bad[] = {1, 0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01};
+    CHECK_EQ(dec.decode(bad, sizeof(bad), r), 0);
+
+    // Too small for the record: nothing written, encoder state unchanged
+    uint8_t small[4];
+    CHECK_EQ(enc.encode(reading(1700000120, 5), small, sizeof(small)), 0);
+    size_t n = enc.encode(reading(1700000120, 5), delta, sizeof(delta));
+    CHECK_EQ(dec.decode(delta, n, r), n);
+    CHECK(same(r, reading(1700000120, 5)));
+
+    // Random garbage never reads past the end
+    for (int i = 0; i < 100000; i++) {
+        uint8_t junk[RECORD_MAX_SIZE];
+        size_t len = random32() % sizeof(junk);
+        for (size_t j = 0; j < len; j++) junk[j] = (uint8_t)random32();
+        RecordDecoder fresh;
+        CHECK(fresh.decode(junk, len, r) <= len);
+    }
+}
+
+void log() {
+    static ReadingLog history;
+    std::vector<Reading> all;
+    Reading r = reading(1700000000, 20);
+    for (int i = 0; i < 5000; i++) {
+        r.timestamp += 60;
+        r.value[0] += ((int)(random32() % 21) - 10) / 10.0f;
+        history.append(r);
+        all.push_back(r);
+    }
+    // Recycled: the cursor starts at the oldest block still held
+    ReadingLog::Cursor c = history.from();
+    Reading got;
+    size_t first = all.size() - history.recordCount(), i = first;
+    while (c.next(got)) {
+        CHECK(i < all.size() && same(got, all[i]));
+        i++;
+    }
+    CHECK_EQ(i, all.size());
+    CHECK(history.bytesUsed() <= HISTORY_BLOCK_SIZE * HISTORY_BLOCK_COUNT);
+
+    uint32_t since = all[all.size() - 100].timestamp;
+    c = history.from(since);
+    size_t n = 0;
+    while (c.next(got)) {
+        CHECK(got.timestamp >= since);
+        n++;
+    }
+    CHECK_EQ(n, 100);
+}
+
+} // namespace
+
+int main() {
+    randomWalk();
+    keyframes();
+    extremes();
+    missing();
+    truncated();
+    log();
+    return checkResult("record_codec_test");
+}
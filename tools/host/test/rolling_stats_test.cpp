@@ -0,0 +1,175 @@
+// rolling_stats.h against a brute-force window: random samples at random
+// intervals (gaps inside a bucket, across buckets and longer than the whole
+// window), checked after every sample, and a clock that steps backwards.
+// Also prints what the statistics cost in static memory and host time per
+// update.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <deque>
+#include <utility>
+
+#include "check.h"
+#include "rolling_stats.h"
+
+namespace {
+
+// Every sample whose bucket is the current one or one of the last N closed
+template <uint16_t N, uint32_t BucketSec>
+struct BruteWindow {
+    std::deque<std::pair<uint32_t, float> > samples;
+
+    void add(float v, uint32_t nowSec) {
+        samples.emplace_back(nowSec, v);
+        uint32_t id = nowSec / BucketSec;
+        while (samples.front().first / BucketSec + N < id) samples.pop_front();
+    }
+
+    WindowSummary summary() const {
+        WindowSummary s = {INFINITY, -INFINITY, 0, (uint32_t)samples.size()};
+        double sum = 0;
+        for (const auto& e : samples) {
+            s.min = fminf(s.min, e.second);
+            s.max = fmaxf(s.max, e.second);
+            sum += e.second;
+        }
+        s.mean = samples.empty() ? NAN : (float)(sum / samples.size());
+        return s;
+    }
+};
+
+uint32_t rng = 12345;
+uint32_t random32() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+template <uint16_t N, uint32_t BucketSec>
+void compare(uint32_t samples, uint32_t maxStepSec) {
+    BucketedWindow<N, BucketSec> window;
+    BruteWindow<N, BucketSec> brute;
+    uint32_t now = 1000;
+    int failures = check::failures();
+    for (uint32_t i = 0; i < samples && check::failures() == failures; i++) {
+        // Mostly short steps, now and then one past the whole window
+        uint32_t r = random32();
+        now += r % 50 == 0 ? (N + 2) * BucketSec : r % (maxStepSec + 1);
+        float v = (float)(int32_t)(random32() % 2001 - 1000) / 10;
+        window.add(v, now);
+        brute.add(v, now);
+
+        WindowSummary a = window.summary(), b = brute.summary();
+        CHECK_EQ(a.count, b.count);
+        CHECK(a.min == b.min);
+        CHECK(a.max == b.max);
+        CHECK(fabsf(a.mean - b.mean) <= 1e-3f * (1 + fabsf(b.mean)));
+    }
+}
+
+void ewma() {
+    MetricStats s;
+    CHECK(isnan(s.ewma));
+    s.add(NAN, 0);
+    CHECK(isnan(s.ewma));
+    s.add(10, 60);
+    CHECK(s.ewma == 10);
+    float expect = 10;
+    for (int i = 0; i < 100; i++) {
+        float v = (float)(i % 7);
+        s.add(v, 120 + 60 * i);
+        expect += EWMA_ALPHA * (v - expect);
+    }
+    CHECK(fabsf(s.ewma - expect) < 1e-4f);
+    // A missing reading leaves it alone
+    s.add(NAN, 9000);
+    CHECK(fabsf(s.ewma - expect) < 1e-4f);
+}
+
+void empty() {
+    BucketedWindow<60, 60> w;
+    WindowSummary s = w.summary();
+    CHECK_EQ(s.count, 0);
+    CHECK(isnan(s.min) && isnan(s.max) && isnan(s.mean));
+}
+
+// A timestamp earlier than the current bucket (e.g. the RTC corrected by
+// NTP) counts as a gap longer than the window: both windows are emptied and
+// restart at the new time, like after a long outage
+void clockBackwards() {
+    MetricStats s;
+    for (uint32_t t = 100000; t < 100000 + 3600; t += 60) s.add(20, t);
+    CHECK_EQ(s.hour.summary().count, 60);
+    CHECK_EQ(s.day.summary().count, 60);
+    float ewma = s.ewma;
+
+    s.add(5, 100000 - 7200);
+    WindowSummary h = s.hour.summary(), d = s.day.summary();
+    CHECK_EQ(h.count, 1);
+    CHECK(h.min == 5 && h.max == 5 && h.mean == 5);
+    CHECK_EQ(d.count, 1);
+    CHECK(d.mean == 5);
+    // The EWMA has no window and just goes on
+    CHECK(fabsf(s.ewma - (ewma + EWMA_ALPHA * (5 - ewma))) < 1e-4f);
+
+    // Forward again from there, by the minute
+    for (uint32_t t = 100000 - 7200 + 60; t < 100000 - 7200 + 600; t += 60) s.add(7, t);
+    h = s.hour.summary();
+    CHECK_EQ(h.count, 10);
+    CHECK(h.min == 5 && h.max == 7);
+
+    // Within the same bucket, an earlier second is just another sample
+    BucketedWindow<60, 60> w;
+    w.add(1, 6000);
+    w.add(2, 6030);
+    w.add(3, 6010);
+    CHECK_EQ(w.summary().count, 3);
+}
+
+// Host ns per MetricStats::add(), a StatsTable fed one reading per step:
+// a minute (the firmware's case), a few seconds, and gaps that push the
+// whole window
+void timeUpdates(const char* name, uint32_t stepSec, uint32_t readings) {
+    static StatsTable stats;
+    for (MetricStats& m : stats) m = MetricStats();
+    uint32_t x = 7, now = 1000;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < readings; i++) {
+        now += stepSec;
+        for (MetricStats& m : stats) {
+            x = x * 1664525 + 1013904223;
+            m.add((float)(x >> 16) / 100, now);
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    float sink = 0;
+    for (const MetricStats& m : stats) sink += m.ewma;
+    printf("rolling_stats_test: add() %-16s %6.1f ns\n", name, ns / ((double)readings * METRIC_COUNT));
+    CHECK(!isnan(sink));
+}
+
+} // namespace
+
+int main() {
+    empty();
+    compare<60, 60>(200000, 200);       // the hour window
+    compare<48, 1800>(200000, 5000);    // the day window
+    compare<4, 10>(200000, 30);         // small: eviction on nearly every bucket
+    ewma();
+    clockBackwards();
+
+    timeUpdates("every minute", 60, 500000);
+    timeUpdates("every 5 s", 5, 500000);
+    timeUpdates("past the window", 48 * 1800 + 1800, 50000);
+
+    // float/uint16_t/double layout is the same on the ESP32
+    const size_t deques = 2 * sizeof(uint16_t) * (60 + 48);
+    printf("rolling_stats_test: MetricStats %zu B (min/max deques %zu B), StatsTable %zu B\n",
+           sizeof(MetricStats), deques, sizeof(StatsTable));
+    CHECK_EQ(sizeof(MetricStats), 2280);
+    return checkResult("rolling_stats_test");
+}
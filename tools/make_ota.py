@@ -0,0 +1,40 @@
+"""Package a PlatformIO build for OTA (see include/ota_update.h).
+
+Writes firmware.bin.gz and manifest.txt next to each other; copy both to the
+directory served at otaManifestUrl.
+
+    python tools/make_ota.py <version> <base url> [firmware.bin] [out dir]
+    python tools/make_ota.py 2 http://192.168.1.10/station
+"""
+import gzip
+import hashlib
+import os
+import sys
+
+DEFAULT_IMAGE = os.path.join(".pio", "build", "cyd_gps_project", "firmware.bin")
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    version = int(sys.argv[1])
+    base_url = sys.argv[2].rstrip("/")
+    image_path = sys.argv[3] if len(sys.argv) > 3 else DEFAULT_IMAGE
+    out_dir = sys.argv[4] if len(sys.argv) > 4 else "ota"
+
+    with open(image_path, "rb") as f:
+        image = f.read()
+    os.makedirs(out_dir, exist_ok=True)
+
+    packed = gzip.compress(image, compresslevel=9)
+    with open(os.path.join(out_dir, "firmware.bin.gz"), "wb") as f:
+        f.write(packed)
+    with open(os.path.join(out_dir, "manifest.txt"), "w") as f:
+        f.write("%d %s %s/firmware.bin.gz\n" % (version, hashlib.sha256(image).hexdigest(), base_url))
+
+    print("firmware %d: %d B image, %d B compressed (%d%%)"
+          % (version, len(image), len(packed), len(packed) * 100 // len(image)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,227 @@
+// ==========================================
+// RECORD BENCH
+// ==========================================
+// Host tool: size and speed of the history encoding (include/record_codec.h)
+// on a series of readings, either synthetic (a day cycle plus noise at
+// one-minute steps, with dropouts) or the station's own /readings CSV
+// (tools/fetch_history.py writes a month of Open-Meteo history as one).
+//
+//   size        bytes per record for keyframes and deltas, and per record
+//               as stored in ReadingLog (one keyframe per block), against
+//               the in-memory Reading and the CSV line
+//   compression ReadingLog bytes per record against Reading and CSV
+//   capacity    hours of one-minute history the ReadingLog holds
+//   speed       encode and decode time per record on this machine; only
+//               the ratio to other builds carries over to the ESP32
+//
+// Every record is decoded and compared with its input first.
+//
+//   record_bench [-n records] [readings.csv]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "record_codec.h"
+
+namespace {
+
+uint32_t rng = 88172645u;
+float noise() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (float)(rng % 2001) / 1000 - 1;     // -1 .. 1
+}
+
+// One reading a minute for n minutes: a day cycle for temperature, slow
+// drifts for the rest, and a metric missing now and then
+std::vector<Reading> synthetic(size_t n) {
+    std::vector<Reading> rs(n);
+    float drift[METRIC_COUNT] = {0, 1013, 12, 20, 15, 3, 60, 250};
+    for (size_t i = 0; i < n; i++) {
+        Reading& r = rs[i];
+        r.timestamp = 1700000000 + 60 * i;
+        for (size_t m = 1; m < METRIC_COUNT; m++) {
+            drift[m] = fmaxf(0, drift[m] + noise() * drift[m] * 0.002f);
+            r.value[m] = drift[m] + noise() * 0.2f;
+        }
+        r.value[0] = 10 + 6 * sinf(i * 2 * (float)M_PI / 1440) + noise() * 0.1f;
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            if (noise() > 0.99f) r.value[m] = NAN;
+        }
+    }
+    return rs;
+}
+
+// /readings?format=csv: "timestamp,<metric keys>" then one line per record,
+// empty fields for missing values
+bool readCsv(const char* path, std::vector<Reading>& rs) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    char line[512];
+    bool header = true;
+    while (fgets(line, sizeof(line), f)) {
+        if (header) {
+            header = false;
+            continue;
+        }
+        Reading r;
+        char* p = line;
+        r.timestamp = strtoul(p, &p, 10);
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            r.value[m] = NAN;
+            if (*p != ',') break;
+            p++;
+            if (*p == ',' || *p == '\n' || *p == '\r' || !*p) continue;
+            r.value[m] = strtof(p, &p);
+        }
+        rs.push_back(r);
+    }
+    fclose(f);
+    return !rs.empty();
+}
+
+size_t csvLine(const Reading& r) {
+    char buf[256];
+    size_t len = snprintf(buf, sizeof(buf), "%u", (unsigned)r.timestamp);
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        len += std::isnan(r.value[m]) ? snprintf(buf, sizeof(buf), ",")
+                                      : snprintf(buf, sizeof(buf), ",%.*f", RECORD_SCALE[m] >= 100 ? 2 : 1, r.value[m]);
+    }
+    return len + 1;
+}
+
+bool sameReading(const Reading& a, const Reading& b) {
+    if (a.timestamp != b.timestamp) return false;
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        if (std::isnan(a.value[m]) || std::isnan(b.value[m])) {
+            if (std::isnan(a.value[m]) != std::isnan(b.value[m])) return false;
+        } else if (fabsf(a.value[m] - b.value[m]) > 0.5f / RECORD_SCALE[m] + 1e-5f * (1 + fabsf(b.value[m]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double nsPer(std::chrono::steady_clock::duration d, size_t n) {
+    return std::chrono::duration<double, std::nano>(d).count() / n;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t n = 7 * 1440;
+    const char* csv = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) n = strtoul(argv[++i], nullptr, 10);
+        else if (argv[i][0] != '-') csv = argv[i];
+        else {
+            fprintf(stderr, "usage: record_bench [-n records] [readings.csv]\n");
+            return 2;
+        }
+    }
+
+    std::vector<Reading> rs;
+    if (csv) {
+        if (!readCsv(csv, rs)) {
+            fprintf(stderr, "record_bench: no readings in %s\n", csv);
+            return 1;
+        }
+    } else {
+        if (!n) return 2;
+        rs = synthetic(n);
+    }
+
+    // One stream, keyframe first only; sizes per record kind
+    std::vector<uint8_t> stream(rs.size() * RECORD_MAX_SIZE);
+    std::vector<size_t> offsets;
+    size_t keyBytes = 0, keyCount = 0, deltaBytes = 0, csvBytes = 0;
+    RecordEncoder enc;
+    size_t pos = 0;
+    for (const Reading& r : rs) {
+        size_t len = enc.encode(r, stream.data() + pos, RECORD_MAX_SIZE);
+        offsets.push_back(pos);
+        if (stream[pos] & 1) {
+            keyBytes += len;
+            keyCount++;
+        } else {
+            deltaBytes += len;
+        }
+        pos += len;
+        csvBytes += csvLine(r);
+    }
+    stream.resize(pos);
+
+    RecordDecoder dec;
+    Reading out;
+    for (size_t i = 0; i < rs.size(); i++) {
+        size_t len = dec.decode(stream.data() + offsets[i], stream.size() - offsets[i], out);
+        if (!len || !sameReading(out, rs[i])) {
+            fprintf(stderr, "record_bench: record %zu does not round-trip\n", i);
+            return 1;
+        }
+    }
+
+    // As stored: a keyframe at the start of every block
+    static ReadingLog history;
+    size_t logged = std::min(rs.size(), (size_t)100000);
+    size_t blockRecords = 0, blockBytes = 0;
+    for (size_t i = 0; i < logged; i++) {
+        history.append(rs[i]);
+        if (history.bytesUsed() > HISTORY_BLOCK_SIZE * (HISTORY_BLOCK_COUNT - 1)) break;
+        blockRecords = history.recordCount();
+        blockBytes = history.bytesUsed();
+    }
+    double perLogged = blockRecords ? (double)blockBytes / blockRecords : 0;
+
+    // Speed: best of several passes over the whole series
+    using clock = std::chrono::steady_clock;
+    clock::duration encBest = clock::duration::max(), decBest = clock::duration::max();
+    std::vector<uint8_t> scratch(stream.size() + RECORD_MAX_SIZE);
+    volatile uint32_t sink = 0;
+    for (int pass = 0; pass < 5; pass++) {
+        RecordEncoder e;
+        size_t p = 0;
+        clock::time_point t0 = clock::now();
+        for (const Reading& r : rs) p += e.encode(r, scratch.data() + p, RECORD_MAX_SIZE);
+        clock::time_point t1 = clock::now();
+        RecordDecoder d;
+        size_t q = 0;
+        Reading r;
+        while (q < p) {
+            size_t len = d.decode(scratch.data() + q, p - q, r);
+            if (!len) break;
+            q += len;
+            sink = sink + r.timestamp;
+        }
+        clock::time_point t2 = clock::now();
+        encBest = std::min(encBest, t1 - t0);
+        decBest = std::min(decBest, t2 - t1);
+    }
+
+    size_t deltaCount = rs.size() - keyCount;
+    printf("%zu records (%s)\n", rs.size(), csv ? csv : "synthetic, one a minute");
+    printf("bytes per record\n");
+    printf("  %-22s %8.1f\n", "Reading (floats)", (double)sizeof(Reading));
+    printf("  %-22s %8.1f\n", "CSV line", (double)csvBytes / rs.size());
+    printf("  %-22s %8.1f  (%zu)\n", "keyframe", keyCount ? (double)keyBytes / keyCount : 0.0, keyCount);
+    printf("  %-22s %8.1f  (%zu)\n", "delta", deltaCount ? (double)deltaBytes / deltaCount : 0.0, deltaCount);
+    printf("  %-22s %8.1f  (keyframe per %zu B block)\n", "in ReadingLog", perLogged, HISTORY_BLOCK_SIZE);
+    if (perLogged > 0) {
+        printf("compression: %.1fx against Reading, %.1fx against CSV (in ReadingLog)\n", sizeof(Reading) / perLogged,
+               (double)csvBytes / rs.size() / perLogged);
+        double records = HISTORY_BLOCK_SIZE * HISTORY_BLOCK_COUNT / perLogged;
+        printf("capacity: %zu x %zu B holds ~%.0f records, %.1f h at one a minute\n", HISTORY_BLOCK_COUNT,
+               HISTORY_BLOCK_SIZE, records, records / 60);
+    }
+    auto us = [](clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); };
+    printf("speed: encode %.1f ns/record (%.0f MB/s of Readings), decode %.1f ns/record (%.0f MB/s encoded)\n",
+           nsPer(encBest, rs.size()), rs.size() * sizeof(Reading) / us(encBest), nsPer(decBest, rs.size()),
+           stream.size() / us(decBest));
+    return 0;
+}
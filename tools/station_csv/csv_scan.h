@@ -0,0 +1,183 @@
+#pragma once
+
+// ==========================================
+// CSV FIELD SCANNER
+// ==========================================
+// ThingSpeak exports and the station's own /readings CSV are plain CSV: ','
+// separated, '\n' or "\r\n" rows, no quoting. The scanner finds delimiters
+// 16 bytes at a time (SSE2 compare + movemask, one bit per delimiter) and
+// hands every field to the visitor as a [begin, end) range - the bytes in
+// between are never looked at one by one. Without SSE2 the same state
+// machine runs byte by byte.
+//
+// Visitor:  void field(size_t column, const char* begin, const char* end);
+//           void row();       // after the last field of each row
+//
+// Also: number and timestamp parsers for the field formats that occur.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CSV_SCAN_SSE2 1
+#else
+#define CSV_SCAN_SSE2 0
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace csv {
+
+template <typename Visitor>
+class Scanner {
+public:
+    Scanner(const char* begin, Visitor& v) : field_(begin), v_(v) {}
+
+    void delimiter(const char* d) {
+        if (*d == ',') {
+            v_.field(column_++, field_, d);
+        } else {
+            v_.field(column_, field_, d > field_ && d[-1] == '\r' ? d - 1 : d);
+            v_.row();
+            column_ = 0;
+        }
+        field_ = d + 1;
+    }
+
+    // A last row without '\n'
+    void finish(const char* end) {
+        if (field_ == end && !column_) return;
+        v_.field(column_, field_, end > field_ && end[-1] == '\r' ? end - 1 : end);
+        v_.row();
+    }
+
+private:
+    const char* field_;
+    size_t column_ = 0;
+    Visitor& v_;
+};
+
+inline unsigned lowestBit(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, mask);
+    return (unsigned)i;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+template <typename Visitor>
+void scanScalar(const char* p, const char* end, Visitor& v) {
+    Scanner<Visitor> s(p, v);
+    for (; p < end; p++) {
+        if (*p == ',' || *p == '\n') s.delimiter(p);
+    }
+    s.finish(end);
+}
+
+template <typename Visitor>
+void scan(const char* p, const char* end, Visitor& v) {
+#if CSV_SCAN_SSE2
+    Scanner<Visitor> s(p, v);
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; p + 16 <= end; p += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)p);
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(block, comma), _mm_cmpeq_epi8(block, newline)));
+        while (mask) {
+            s.delimiter(p + lowestBit(mask));
+            mask &= mask - 1;
+        }
+    }
+    for (; p < end; p++) {
+        if (*p == ',' || *p == '\n') s.delimiter(p);
+    }
+    s.finish(end);
+#else
+    scanScalar(p, end, v);
+#endif
+}
+
+constexpr bool simdAvailable() { return CSV_SCAN_SSE2 != 0; }
+
+// ------------------------------------------
+// Field parsers
+// ------------------------------------------
+
+// "-12.34", "7", "1013.2" -> float; empty or malformed -> NAN. Exponents are
+// not accepted: neither the firmware nor ThingSpeak writes them.
+inline float parseDecimal(const char* p, const char* end) {
+    static const double SCALE[] = {1, 1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-7, 1e-8, 1e-9};
+    if (p == end) return NAN;
+    bool negative = *p == '-';
+    if (negative || *p == '+') p++;
+    uint64_t mantissa = 0;
+    int fraction = -1;          // digits after '.', -1 = no '.'
+    bool digits = false;
+    for (; p < end; p++) {
+        unsigned d = (unsigned)(*p - '0');
+        if (d < 10) {
+            if (fraction < 9) {
+                mantissa = mantissa * 10 + d;
+                if (fraction >= 0) fraction++;
+            }
+            digits = true;
+        } else if (*p == '.' && fraction < 0) {
+            fraction = 0;
+        } else {
+            return NAN;
+        }
+    }
+    if (!digits) return NAN;
+    double v = (double)mantissa * SCALE[fraction > 0 ? fraction : 0];
+    return (float)(negative ? -v : v);
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+constexpr int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+static_assert(daysFromCivil(1970, 1, 1) == 0, "epoch");
+static_assert(daysFromCivil(2024, 3, 1) == 19783, "leap year");
+
+// Unix seconds from "1709251205" (/readings) or "2024-03-01 00:00:05 UTC" /
+// "2024-03-01T00:00:05Z" (ThingSpeak); -1 if malformed. A zone suffix is
+// not applied: ThingSpeak exports UTC unless asked for another timezone.
+inline int64_t parseTimestamp(const char* p, const char* end) {
+    size_t n = (size_t)(end - p);
+    if (n >= 19 && p[4] == '-' && p[7] == '-' && (p[10] == ' ' || p[10] == 'T') && p[13] == ':' && p[16] == ':') {
+        auto num = [p](size_t at, size_t len) {
+            int v = 0;
+            for (size_t i = at; i < at + len; i++) {
+                unsigned d = (unsigned)(p[i] - '0');
+                if (d > 9) return -1;
+                v = v * 10 + (int)d;
+            }
+            return v;
+        };
+        int y = num(0, 4), mo = num(5, 2), d = num(8, 2), h = num(11, 2), mi = num(14, 2), s = num(17, 2);
+        if (y < 0 || mo < 1 || mo > 12 || d < 1 || d > 31 || h < 0 || mi < 0 || s < 0) return -1;
+        return daysFromCivil(y, (unsigned)mo, (unsigned)d) * 86400 + h * 3600 + mi * 60 + s;
+    }
+    if (n == 0 || n > 12) return -1;
+    int64_t v = 0;
+    for (; p < end; p++) {
+        unsigned d = (unsigned)(*p - '0');
+        if (d > 9) return -1;
+        v = v * 10 + d;
+    }
+    return v;
+}
+
+} // namespace csv
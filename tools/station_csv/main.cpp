@@ -0,0 +1,574 @@
+// ==========================================
+// STATION CSV
+// ==========================================
+// Host tool: per-station summaries of ThingSpeak channel exports (and of the
+// station's own /readings CSV) - row counts, time span, gaps in the
+// one-minute series, min/mean/max per metric and how many samples reached
+// each AQI level. Metric ids, the ThingSpeak field layout and the AQI tables
+// come from the firmware headers (include/metrics.h, include/aqi.h), so the
+// tool and the station always agree.
+//
+// Files are memory-mapped and cut into ~64 MB pieces at row boundaries;
+// all cores scan pieces in parallel (csv_scan.h) and the partial summaries
+// are merged in file order, gaps across piece boundaries included.
+//
+//   station_csv [options] <file.csv>...
+//   station_csv generate <dir> <stations> <days>
+//   station_csv bench <dir> [gigabytes]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "aqi.h"
+#include "metrics.h"
+#include "csv_scan.h"
+#include "mapped_file.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t CHUNK_BYTES = 64u << 20;
+constexpr size_t MAX_COLUMNS = 64;
+
+struct Options {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    int64_t gapSeconds = 5 * 60;
+    aqi::Scale scale = aqi::Scale::European;
+    uint8_t level = 3;              // EU "Poor" / US "Unhealthy"
+    bool csvOutput = false;
+    bool scalar = false;            // force the byte-by-byte scanner
+};
+
+// Pollutant behind each Metric (Temperature and Pressure have none)
+constexpr aqi::Pollutant POLLUTANT_OF[METRIC_COUNT] = {
+    aqi::Pollutant::None, aqi::Pollutant::None, aqi::Pollutant::PM25, aqi::Pollutant::PM10,
+    aqi::Pollutant::NO2,  aqi::Pollutant::SO2,  aqi::Pollutant::O3,   aqi::Pollutant::CO};
+
+// ------------------------------------------
+// Aggregates
+// ------------------------------------------
+struct MetricSummary {
+    uint64_t count = 0;
+    double sum = 0;
+    float lowest = INFINITY;
+    float highest = -INFINITY;
+
+    void add(float v) {
+        count++;
+        sum += v;
+        if (v < lowest) lowest = v;
+        if (v > highest) highest = v;
+    }
+
+    void merge(const MetricSummary& o) {
+        count += o.count;
+        sum += o.sum;
+        lowest = std::min(lowest, o.lowest);
+        highest = std::max(highest, o.highest);
+    }
+};
+
+struct Summary {
+    uint64_t rows = 0;
+    uint64_t badTimestamps = 0;
+    int64_t first = -1;             // timestamps of the first and last row
+    int64_t last = -1;
+    uint64_t gaps = 0;              // steps longer than the gap threshold
+    int64_t gapSeconds = 0;
+    int64_t longestGap = 0;
+    int64_t longestGapAt = -1;
+    uint64_t unordered = 0;         // rows older than the one before
+    MetricSummary metric[METRIC_COUNT];
+    uint64_t aqiLevel[aqi::LEVEL_COUNT] = {};
+
+    void step(int64_t from, int64_t to, int64_t gapLimit) {
+        if (to < from) {
+            unordered++;
+            return;
+        }
+        int64_t d = to - from;
+        if (d <= gapLimit) return;
+        gaps++;
+        gapSeconds += d;
+        if (d > longestGap) {
+            longestGap = d;
+            longestGapAt = from;
+        }
+    }
+
+    void addTime(int64_t t, int64_t gapLimit) {
+        if (first < 0) first = t;
+        else step(last, t, gapLimit);
+        last = t;
+    }
+
+    // next covers the rows right after this one
+    void merge(const Summary& next, int64_t gapLimit) {
+        if (next.first >= 0) {
+            if (first < 0) first = next.first;
+            else step(last, next.first, gapLimit);
+            last = next.last;
+        }
+        rows += next.rows;
+        badTimestamps += next.badTimestamps;
+        gaps += next.gaps;
+        gapSeconds += next.gapSeconds;
+        unordered += next.unordered;
+        if (next.longestGap > longestGap) {
+            longestGap = next.longestGap;
+            longestGapAt = next.longestGapAt;
+        }
+        for (size_t m = 0; m < METRIC_COUNT; m++) metric[m].merge(next.metric[m]);
+        for (size_t l = 0; l < aqi::LEVEL_COUNT; l++) aqiLevel[l] += next.aqiLevel[l];
+    }
+};
+
+// ------------------------------------------
+// Parsing
+// ------------------------------------------
+enum Role : uint8_t { IGNORED, TIME, FIRST_METRIC };     // FIRST_METRIC + metric index
+
+struct Layout {
+    uint8_t role[MAX_COLUMNS] = {};
+    bool hasTime = false;
+};
+
+// Columns by header name: created_at / timestamp, fieldN per THINGSPEAK_FIELD,
+// or the Open-Meteo keys used by /readings
+struct HeaderVisitor {
+    Layout& layout;
+
+    void field(size_t column, const char* b, const char* e) {
+        if (column >= MAX_COLUMNS) return;
+        std::string name(b, e);
+        if (name == "created_at" || name == "timestamp") {
+            layout.role[column] = TIME;
+            layout.hasTime = true;
+            return;
+        }
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            bool field = THINGSPEAK_FIELD[m] && name == "field" + std::to_string(THINGSPEAK_FIELD[m]);
+            if (field || name == METRIC_INFO[m].key) layout.role[column] = (uint8_t)(FIRST_METRIC + m);
+        }
+    }
+    void row() {}
+};
+
+class RowVisitor {
+public:
+    RowVisitor(const Layout& layout, const Options& opt, Summary& out) : layout_(layout), opt_(opt), out_(out) {
+        clear();
+    }
+
+    void field(size_t column, const char* b, const char* e) {
+        uint8_t role = column < MAX_COLUMNS ? layout_.role[column] : (uint8_t)IGNORED;
+        if (role == TIME) {
+            timeField_ = b != e;
+            time_ = csv::parseTimestamp(b, e);
+        } else if (role >= FIRST_METRIC) {
+            value_[role - FIRST_METRIC] = csv::parseDecimal(b, e);
+        }
+    }
+
+    void row() {
+        if (time_ < 0) {
+            if (timeField_) out_.badTimestamps++;       // blank lines are not counted
+            clear();
+            return;
+        }
+        out_.rows++;
+        out_.addTime(time_, opt_.gapSeconds);
+
+        aqi::Sample sample;
+        std::fill(std::begin(sample), std::end(sample), -1.0f);
+        bool pollutant = false;
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            if (std::isnan(value_[m])) continue;
+            out_.metric[m].add(value_[m]);
+            if (POLLUTANT_OF[m] != aqi::Pollutant::None) {
+                sample[(size_t)POLLUTANT_OF[m]] = value_[m];
+                pollutant = true;
+            }
+        }
+        if (pollutant) out_.aqiLevel[aqi::compute(opt_.scale, sample).level]++;
+        clear();
+    }
+
+private:
+    void clear() {
+        time_ = -1;
+        timeField_ = false;
+        std::fill(std::begin(value_), std::end(value_), NAN);
+    }
+
+    const Layout& layout_;
+    const Options& opt_;
+    Summary& out_;
+    int64_t time_;
+    bool timeField_;
+    float value_[METRIC_COUNT];
+};
+
+struct InputFile {
+    std::string path;
+    std::string station;
+    MappedFile map;
+    Layout layout;
+};
+
+struct Piece {
+    size_t file;
+    const char* begin;
+    const char* end;
+};
+
+// ThingSpeak names every export feeds.csv: then the directory names the station
+std::string stationName(const fs::path& path) {
+    std::string stem = path.stem().string();
+    if (stem == "feeds" && path.has_parent_path()) {
+        std::string dir = fs::absolute(path).parent_path().filename().string();
+        if (!dir.empty()) return dir;
+    }
+    return stem;
+}
+
+// Maps the file, reads the header and cuts the rows into pieces
+bool openInput(InputFile& f, size_t index, std::vector<Piece>& pieces) {
+    if (!f.map.open(f.path)) {
+        fprintf(stderr, "%s: cannot open\n", f.path.c_str());
+        return false;
+    }
+    const char* data = f.map.data();
+    const char* end = data + f.map.size();
+    if (!data) return true;                                 // empty file
+
+    const char* body = (const char*)memchr(data, '\n', f.map.size());
+    body = body ? body + 1 : end;
+    HeaderVisitor header{f.layout};
+    csv::scanScalar(data, body, header);
+    if (!f.layout.hasTime) {
+        fprintf(stderr, "%s: no created_at or timestamp column\n", f.path.c_str());
+        return false;
+    }
+
+    while (body < end) {
+        const char* cut = body + std::min(CHUNK_BYTES, (size_t)(end - body));
+        if (cut < end) {
+            const char* nl = (const char*)memchr(cut, '\n', (size_t)(end - cut));
+            cut = nl ? nl + 1 : end;
+        }
+        pieces.push_back({index, body, cut});
+        body = cut;
+    }
+    return true;
+}
+
+struct RunResult {
+    std::vector<std::pair<std::string, Summary>> stations;      // in first-seen order
+    uint64_t bytes = 0;
+    double seconds = 0;
+};
+
+bool analyse(const std::vector<std::string>& paths, const Options& opt, RunResult& result) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::unique_ptr<InputFile>> files;
+    std::vector<Piece> pieces;
+    for (const std::string& path : paths) {
+        files.emplace_back(new InputFile());
+        InputFile& f = *files.back();
+        f.path = path;
+        f.station = stationName(path);
+        if (!openInput(f, files.size() - 1, pieces)) return false;
+        result.bytes += f.map.size();
+    }
+
+    std::vector<Summary> partial(pieces.size());
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < pieces.size(); i = next++) {
+            const Piece& p = pieces[i];
+            RowVisitor rows(files[p.file]->layout, opt, partial[i]);
+            if (opt.scalar) csv::scanScalar(p.begin, p.end, rows);
+            else csv::scan(p.begin, p.end, rows);
+        }
+    };
+    std::vector<std::thread> threads;
+    unsigned n = std::min<size_t>(opt.threads, std::max<size_t>(1, pieces.size()));
+    for (unsigned t = 1; t < n; t++) threads.emplace_back(worker);
+    worker();
+    for (std::thread& t : threads) t.join();
+
+    // Pieces are in file order and files in argument order, so one pass
+    // merges each station chronologically (given the files are)
+    std::map<std::string, size_t> index;
+    for (size_t i = 0; i < pieces.size(); i++) {
+        const std::string& station = files[pieces[i].file]->station;
+        auto it = index.find(station);
+        if (it == index.end()) {
+            it = index.emplace(station, result.stations.size()).first;
+            result.stations.emplace_back(station, Summary());
+        }
+        result.stations[it->second].second.merge(partial[i], opt.gapSeconds);
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// ------------------------------------------
+// Output
+// ------------------------------------------
+std::string formatTime(int64_t t) {
+    if (t < 0) return "--";
+    int64_t days = t / 86400, secs = t % 86400;
+    // civil from days (inverse of csv::daysFromCivil)
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = (unsigned)(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    int64_t y = (int64_t)yoe + era * 400 + (m <= 2);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%04" PRId64 "-%02u-%02u %02u:%02u", y, m, d,
+             (unsigned)(secs / 3600), (unsigned)(secs % 3600 / 60));
+    return buf;
+}
+
+std::string formatDuration(int64_t s) {
+    char buf[32];
+    if (s >= 86400) snprintf(buf, sizeof(buf), "%" PRId64 "d%02uh", s / 86400, (unsigned)(s % 86400 / 3600));
+    else if (s >= 3600) snprintf(buf, sizeof(buf), "%uh%02um", (unsigned)(s / 3600), (unsigned)(s % 3600 / 60));
+    else snprintf(buf, sizeof(buf), "%um%02us", (unsigned)(s / 60), (unsigned)(s % 60));
+    return buf;
+}
+
+uint64_t exceedances(const Summary& s, uint8_t level) {
+    uint64_t n = 0;
+    for (size_t l = level; l < aqi::LEVEL_COUNT; l++) n += s.aqiLevel[l];
+    return n;
+}
+
+void printText(const RunResult& r, const Options& opt) {
+    const char* scale = opt.scale == aqi::Scale::European ? "European" : "US EPA";
+    for (const auto& entry : r.stations) {
+        const Summary& s = entry.second;
+        printf("%s: %" PRIu64 " rows, %s .. %s (%.1f days)\n", entry.first.c_str(), s.rows,
+               formatTime(s.first).c_str(), formatTime(s.last).c_str(),
+               s.first >= 0 ? (s.last - s.first) / 86400.0 : 0.0);
+        printf("  gaps > %s: %" PRIu64 ", %s in gaps", formatDuration(opt.gapSeconds).c_str(), s.gaps,
+               formatDuration(s.gapSeconds).c_str());
+        if (s.gaps) printf(", longest %s from %s", formatDuration(s.longestGap).c_str(), formatTime(s.longestGapAt).c_str());
+        if (s.unordered) printf(", %" PRIu64 " out of order", s.unordered);
+        if (s.badTimestamps) printf(", %" PRIu64 " bad timestamps", s.badTimestamps);
+        printf("\n");
+
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            const MetricSummary& ms = s.metric[m];
+            if (!ms.count) continue;
+            int dp = METRIC_INFO[m].decimals;
+            printf("  %-9s n %-9" PRIu64 " min %.*f  mean %.*f  max %.*f %s\n", METRIC_INFO[m].label, ms.count,
+                   dp, ms.lowest, dp + 1, ms.sum / ms.count, dp, ms.highest, METRIC_INFO[m].unit);
+        }
+
+        uint64_t rated = exceedances(s, 0);
+        if (!rated) continue;
+        printf("  AQI (%s):", scale);
+        for (uint8_t l = 0; l < aqi::LEVEL_COUNT; l++) {
+            printf(" %s %.1f%%", aqi::levelName(opt.scale, l), 100.0 * s.aqiLevel[l] / rated);
+        }
+        uint64_t over = exceedances(s, opt.level);
+        printf("\n  %s or worse: %" PRIu64 " samples (%.2f%%)\n", aqi::levelName(opt.scale, opt.level), over,
+               100.0 * over / rated);
+    }
+}
+
+void printCsv(const RunResult& r, const Options& opt) {
+    bool present[METRIC_COUNT] = {};
+    for (const auto& entry : r.stations) {
+        for (size_t m = 0; m < METRIC_COUNT; m++) present[m] |= entry.second.metric[m].count > 0;
+    }
+    printf("station,rows,first,last,gaps,gap_seconds,longest_gap_seconds,out_of_order,bad_timestamps");
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        if (present[m]) printf(",%s_n,%s_min,%s_mean,%s_max", METRIC_INFO[m].key, METRIC_INFO[m].key,
+                               METRIC_INFO[m].key, METRIC_INFO[m].key);
+    }
+    for (uint8_t l = 0; l < aqi::LEVEL_COUNT; l++) printf(",aqi_level%u", l);
+    printf(",aqi_exceedances\n");
+
+    for (const auto& entry : r.stations) {
+        const Summary& s = entry.second;
+        printf("%s,%" PRIu64 ",%" PRId64 ",%" PRId64 ",%" PRIu64 ",%" PRId64 ",%" PRId64 ",%" PRIu64 ",%" PRIu64,
+               entry.first.c_str(), s.rows, s.first, s.last, s.gaps, s.gapSeconds, s.longestGap, s.unordered,
+               s.badTimestamps);
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            if (!present[m]) continue;
+            const MetricSummary& ms = s.metric[m];
+            if (ms.count) printf(",%" PRIu64 ",%g,%g,%g", ms.count, ms.lowest, ms.sum / ms.count, ms.highest);
+            else printf(",0,,,");
+        }
+        for (uint8_t l = 0; l < aqi::LEVEL_COUNT; l++) printf(",%" PRIu64, s.aqiLevel[l]);
+        printf(",%" PRIu64 "\n", exceedances(s, opt.level));
+    }
+}
+
+void printThroughput(const RunResult& r, const Options& opt, const char* scanner) {
+    fprintf(stderr, "%.2f GB in %.2f s: %.2f GB/s (%u threads, %s scanner)\n", r.bytes / 1e9, r.seconds,
+            r.bytes / 1e9 / r.seconds, opt.threads, scanner);
+}
+
+// ------------------------------------------
+// Synthetic exports (generate / bench)
+// ------------------------------------------
+
+// One station at one-minute resolution in ThingSpeak's export layout, with
+// the occasional outage, so gaps and AQI levels have something to find
+uint64_t generateStation(const std::string& path, unsigned seed, unsigned days) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return 0;
+    std::vector<char> buf(1 << 20);
+    setvbuf(f, buf.data(), _IOFBF, buf.size());
+    fputs("created_at,entry_id,field1,field2,field3,field4,field5,field6,field7,field8,"
+          "latitude,longitude,elevation,status\n", f);
+
+    uint32_t rng = 2463534242u ^ (seed * 2654435761u);
+    auto random = [&rng]() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    };
+    const int64_t start = csv::daysFromCivil(2024, 1, 1) * 86400;
+    const double lat = 54.35 + (seed % 10) * 0.1, lng = 18.64 + (seed / 10 % 10) * 0.1;
+    double pm = 10;
+    uint64_t entry = 0, bytes = 0;
+    for (int64_t minute = 0; minute < (int64_t)days * 1440; minute++) {
+        if (random() % 20000 == 0) minute += 10 + random() % 240;           // outage
+        int64_t t = start + minute * 60 + random() % 5;
+        pm += (12 - pm) * 0.01 + ((int)(random() % 201) - 100) * 0.02;
+        if (random() % 5000 == 0) pm += 80;                                 // smog episode
+        if (pm < 1) pm = 1;
+        double day = (double)minute / 1440;
+        double temp = 8 - 10 * cos(day / 365 * 2 * M_PI) - 4 * cos(day * 2 * M_PI) + (random() % 100) * 0.01;
+
+        int64_t secs = t % 86400;
+        std::string date = formatTime(t);        // "YYYY-MM-DD HH:MM"
+        char row[160];
+        int n = snprintf(row, sizeof(row), "%s:%02u UTC,%" PRIu64 ",%.5f,%.5f,%d,%.2f,,,,,,,,\n", date.c_str(),
+                         (unsigned)(secs % 60), ++entry, lat, lng, (int)pm, temp);
+        fwrite(row, 1, (size_t)n, f);
+        bytes += (size_t)n;
+    }
+    fclose(f);
+    return bytes;
+}
+
+std::vector<std::string> generate(const std::string& dir, unsigned stations, unsigned days) {
+    fs::create_directories(dir);
+    std::vector<std::string> paths(stations);
+    std::vector<std::thread> threads;
+    std::atomic<unsigned> next(0);
+    auto worker = [&]() {
+        for (unsigned i = next++; i < stations; i = next++) {
+            char name[32];
+            snprintf(name, sizeof(name), "station-%03u.csv", i);
+            paths[i] = (fs::path(dir) / name).string();
+            generateStation(paths[i], i + 1, days);
+        }
+    };
+    unsigned n = std::max(1u, std::min(stations, std::thread::hardware_concurrency()));
+    for (unsigned t = 0; t < n; t++) threads.emplace_back(worker);
+    for (std::thread& t : threads) t.join();
+    return paths;
+}
+
+int usage() {
+    fputs("usage: station_csv [options] <file.csv>...\n"
+          "         -j N         worker threads (default: all cores)\n"
+          "         --gap MIN    report gaps longer than MIN minutes (default 5)\n"
+          "         --scale S    AQI scale: eu (default) or us\n"
+          "         --level N    count samples at AQI level N or worse (default 3)\n"
+          "         --csv        summary as CSV\n"
+          "         --scalar     byte-by-byte scanner (for comparison)\n"
+          "       station_csv generate <dir> <stations> <days>\n"
+          "       station_csv bench <dir> [gigabytes, default 2]\n",
+          stderr);
+    return 2;
+}
+
+int bench(const std::string& dir, double gigabytes, Options opt) {
+    // ~62 bytes per generated row; one file per core so generation is parallel too
+    const unsigned stations = std::max(4u, opt.threads);
+    unsigned days = (unsigned)std::ceil(gigabytes * 1e9 / 62 / 1440 / stations);
+    fprintf(stderr, "generating %u stations x %u days in %s\n", stations, days, dir.c_str());
+    std::vector<std::string> paths = generate(dir, stations, days);
+
+    RunResult simd, scalar;
+    opt.scalar = false;
+    if (!analyse(paths, opt, simd)) return 1;
+    printThroughput(simd, opt, csv::simdAvailable() ? "SSE2" : "scalar");
+    opt.scalar = true;
+    if (!analyse(paths, opt, scalar)) return 1;
+    printThroughput(scalar, opt, "scalar");
+    uint64_t rows = 0;
+    for (const auto& entry : simd.stations) rows += entry.second.rows;
+    fprintf(stderr, "%" PRIu64 " rows, speedup %.2fx\n", rows, scalar.seconds / simd.seconds);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.empty()) return usage();
+
+    if (args[0] == "generate") {
+        if (args.size() != 4) return usage();
+        generate(args[1], (unsigned)atoi(args[2].c_str()), (unsigned)atoi(args[3].c_str()));
+        return 0;
+    }
+
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& a = args[i];
+        bool hasValue = i + 1 < args.size();
+        if (a == "-j" && hasValue) opt.threads = std::max(1, atoi(args[++i].c_str()));
+        else if (a == "--gap" && hasValue) opt.gapSeconds = atoi(args[++i].c_str()) * 60;
+        else if (a == "--scale" && hasValue) opt.scale = args[++i] == "us" ? aqi::Scale::UsEpa : aqi::Scale::European;
+        else if (a == "--level" && hasValue) opt.level = (uint8_t)std::min(atoi(args[++i].c_str()), aqi::LEVEL_COUNT - 1);
+        else if (a == "--csv") opt.csvOutput = true;
+        else if (a == "--scalar") opt.scalar = true;
+        else if (a.size() > 1 && a[0] == '-') return usage();
+        else paths.push_back(a);
+    }
+
+    if (!paths.empty() && paths[0] == "bench") {
+        if (paths.size() < 2) return usage();
+        return bench(paths[1], paths.size() > 2 ? atof(paths[2].c_str()) : 2.0, opt);
+    }
+    if (paths.empty()) return usage();
+
+    RunResult result;
+    if (!analyse(paths, opt, result)) return 1;
+    if (opt.csvOutput) printCsv(result, opt);
+    else printText(result, opt);
+    printThroughput(result, opt, opt.scalar || !csv::simdAvailable() ? "scalar" : "SSE2");
+    return 0;
+}